@@ -25,9 +25,11 @@
  *
  *
  **/
+#include "EvacuationEstimator.hpp"
 #include "IO/EventFileParser.hpp"
 #include "IO/GeoFileParser.hpp"
 #include "IO/IniFileParser.hpp"
+#include "IO/OutputHandler.hpp"
 #include "IO/TrainFileParser.hpp"
 #include "ResultHandling.hpp"
 #include "Simulation.hpp"
@@ -47,6 +49,7 @@
 #include <exception>
 #include <fmt/format.h>
 #include <iostream>
+#include <limits>
 
 int main(int argc, char** argv)
 {
@@ -76,25 +79,53 @@ int main(int argc, char** argv)
         auto config = ParseIniFile(a.IniFilePath());
         auto building = std::make_unique<Building>(&config);
         auto* building_ptr = building.get();
-        auto agents = CreateAllPedestrians(&config, building.get(), config.tMax);
-        auto geometry = ParseGeometryXml(config.projectRootDir / config.geometryFile);
-        Simulation sim(&config, std::move(building), std::move(geometry));
-        EventManager manager;
+        AgentCreator creator(&config, building.get(), config.tMax, a.StreamAgents());
 
-        size_t frame = 0;
-        const auto num_agents_in_simulation = agents.size();
+        if(a.EstimateEvacuation()) {
+            const auto agents = creator.CreateUntil(std::numeric_limits<size_t>::max());
+            EvacuationEstimatorParameters parameters;
+            parameters.maxTime = config.tMax;
+            const EvacuationEstimator estimator(CreateFlowNetwork(*building), parameters);
+            const auto estimate =
+                estimator.Estimate(CreateEstimatorAgents(*building, agents, config.dT));
 
-        while(!agents.empty()) {
-            double now = sim.Clock().dT() * frame;
-            auto t = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                std::chrono::duration<double>(now));
-            auto events = CreateEventsFromAgents(extract(agents, frame), t);
-            for(auto&& evt : events) {
-                manager.AddEvent(evt);
+            fs::path estimateFile{"evacuation_estimate_"};
+            estimateFile += config.trajectoriesFile.filename().replace_extension("txt");
+            estimateFile = config.outputPath / estimateFile;
+            {
+                FileHandler output(estimateFile);
+                WriteEvacuationEstimate(estimate, output);
             }
-            ++frame;
+            LOG_INFO("Flow at the exits written to {}", estimateFile.string());
+            if(estimate.remaining > 0) {
+                LOG_WARNING("Pedestrians not evacuated [{:.0f}]", estimate.remaining);
+            }
+            LOG_INFO("Estimated Evac Time {:.2f}s", estimate.clearanceTime);
+            return EXIT_SUCCESS;
         }
 
+        auto geometry = ParseGeometryXml(config.projectRootDir / config.geometryFile);
+        Simulation sim(&config, std::move(building), std::move(geometry));
+        EventManager manager(sim.Clock().dT());
+
+        // creates the events of the agents entering before iteration 'until'
+        auto createAgentEvents = [&creator, &manager, &sim](size_t until) {
+            auto agents = creator.CreateUntil(until);
+            while(!agents.empty()) {
+                const size_t frame = agents.begin()->first;
+                double now = sim.Clock().dT() * frame;
+                auto t = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::duration<double>(now));
+                auto events = CreateEventsFromAgents(extract(agents, frame), t);
+                for(auto&& evt : events) {
+                    manager.AddEvent(evt);
+                }
+            }
+        };
+        // streamed agents are created one iteration ahead of the simulation
+        createAgentEvents(a.StreamAgents() ? 1 : std::numeric_limits<size_t>::max());
+        const auto num_agents_in_simulation = creator.MaxAgentNumber();
+
         // TODO(kkratz): Right now door state is simply copied over from the buildings
         // state because initial door state is described in the inifile.
         // I want to redesign this so that all specified doors are open and can be closed
@@ -159,14 +190,12 @@ int main(int argc, char** argv)
 
         const int writeInterval = static_cast<int>((1. / sim.Fps()) / sim.Clock().dT() + 0.5);
 
-        while((!sim.Agents().empty() || manager.HasEventsAfter(sim.Clock())) &&
+        while((!sim.Agents().empty() || manager.HasEvents() || !creator.IsCompleted()) &&
               sim.Clock().ElapsedTime() < config.tMax) {
-            auto next_events = manager.NextEvents(sim.Clock());
-            for(auto const& [_, event] : next_events) {
-                // lambda is used to bind additional function paramters to the visitor
-                auto visitor = [&sim](auto event) { ProcessEvent(event, sim); };
-                std::visit(visitor, event);
-            }
+            createAgentEvents(sim.Clock().Iteration() + 1);
+            // lambda is used to bind additional function paramters to the visitor
+            manager.ProcessNextEvents(
+                sim.Clock(), [&sim](const auto& event) { ProcessEvent(event, sim); });
             if(sim.Clock().Iteration() == 0) {
                 writer->WriteFrame(0, sim.Agents());
             }
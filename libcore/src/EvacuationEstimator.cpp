@@ -0,0 +1,487 @@
+#include "EvacuationEstimator.hpp"
+
+#include "Graph.hpp"
+#include "IO/OutputHandler.hpp"
+#include "geometry/Building.hpp"
+#include "geometry/Goal.hpp"
+#include "geometry/Room.hpp"
+#include "geometry/SubRoom.hpp"
+#include "geometry/Transition.hpp"
+#include "geometry/WaitingArea.hpp"
+
+#include <Logger.hpp>
+#include <algorithm>
+#include <fmt/format.h>
+#include <stdexcept>
+
+namespace
+{
+/**
+ * Agents waiting at a side of a door, they can cross the door after readyTime.
+ */
+struct Cohort {
+    double readyTime;
+    double amount;
+    double speed;
+    /// index of the route to the exit of the agents
+    std::size_t route;
+};
+
+bool ReadyLater(const Cohort& a, const Cohort& b)
+{
+    return a.readyTime > b.readyTime;
+}
+
+/// amounts below are treated as no agents
+constexpr double EPSILON = 1e-9;
+} // namespace
+
+FlowNetwork CreateFlowNetwork(const Building& building)
+{
+    FlowNetwork network;
+    for(const auto& [id, room] : building.GetAllRooms()) {
+        double area = 0;
+        for(const auto& [_, subroom] : room->GetAllSubRooms()) {
+            area += subroom->GetArea();
+        }
+        network.rooms.push_back({id, area});
+    }
+    for(const auto& [id, transition] : building.GetAllTransitions()) {
+        if(transition->IsClose() || transition->GetRoom1() == nullptr) {
+            continue;
+        }
+        const Room* room2 = transition->GetRoom2();
+        FlowNetwork::Door door{
+            id,
+            transition->GetRoom1()->GetID(),
+            room2 ? room2->GetID() : -1,
+            transition->GetCentre(),
+            transition->GetLength(),
+            transition->GetOutflowRate(),
+            transition->GetMaxDoorUsage()};
+        if(door.room1 == door.room2) {
+            continue;
+        }
+        network.doors.push_back(door);
+    }
+    return network;
+}
+
+std::vector<EstimatorAgent> CreateEstimatorAgents(
+    const Building& building,
+    const std::multimap<size_t, std::unique_ptr<Pedestrian>>& agents,
+    double dT)
+{
+    // exit closest to each goal outside, agents with a waiting area leave through the nearest exit
+    std::map<int, int> goalExits{{-1, -1}};
+    auto exitOfGoal = [&building, &goalExits](int goalID) {
+        if(auto known = goalExits.find(goalID); known != goalExits.end()) {
+            return known->second;
+        }
+        const Goal* goal = building.GetFinalGoal(goalID);
+        int exitID = -1;
+        if(goal != nullptr && dynamic_cast<const WaitingArea*>(goal) == nullptr) {
+            double minDistance = std::numeric_limits<double>::max();
+            for(const auto& [id, transition] : building.GetAllTransitions()) {
+                if(!transition->IsExit() || transition->IsClose()) {
+                    continue;
+                }
+                const double distance = goal->GetDistance(transition->GetCentre());
+                if(distance < minDistance) {
+                    minDistance = distance;
+                    exitID = id;
+                }
+            }
+        }
+        goalExits.emplace(goalID, exitID);
+        return exitID;
+    };
+
+    std::vector<EstimatorAgent> result;
+    result.reserve(agents.size());
+    for(const auto& [iteration, agent] : agents) {
+        const auto [room, subroom] = building.LocateSubRoom(agent->GetPos(), nullptr);
+        if(room == nullptr) {
+            LOG_WARNING(
+                "Agent {} at ({:.2f}, {:.2f}) is outside the geometry and not estimated",
+                agent->GetUID(),
+                agent->GetPos().x,
+                agent->GetPos().y);
+            continue;
+        }
+        result.push_back(
+            {room->GetID(),
+             agent->GetPos(),
+             exitOfGoal(agent->GetFinalDestination()),
+             std::max(iteration * dT, agent->GetPremovementTime()),
+             agent->GetEllipse().GetV0()});
+    }
+    return result;
+}
+
+EvacuationEstimator::EvacuationEstimator(
+    FlowNetwork network,
+    EvacuationEstimatorParameters parameters)
+    : _network(std::move(network)), _parameters(parameters)
+{
+    if(_parameters.dt <= 0 || _parameters.outputInterval <= 0) {
+        throw std::invalid_argument("Time step and output interval have to be positive");
+    }
+    for(const auto& room : _network.rooms) {
+        _roomIndex.emplace(room.id, _roomCapacity.size());
+        _roomCapacity.push_back(room.area * _parameters.maxDensity);
+    }
+    _roomDoors.resize(_network.rooms.size());
+    for(std::size_t door = 0; door < _network.doors.size(); ++door) {
+        const auto& data = _network.doors[door];
+        if(_roomIndex.count(data.room1) == 0 ||
+           (data.room2 >= 0 && _roomIndex.count(data.room2) == 0)) {
+            throw std::invalid_argument(fmt::format(
+                FMT_STRING("Door {} connects rooms which are not part of the network"), data.id));
+        }
+        const std::size_t room1 = _roomIndex.at(data.room1);
+        const std::size_t room2 = data.room2 >= 0 ? _roomIndex.at(data.room2) : NO_ROUTE;
+        _doorIndex.emplace(data.id, door);
+        _doorRooms.push_back({room1, room2});
+        _doorRate.push_back(std::min(data.width * _parameters.specificFlow, data.outflowRate));
+        _roomDoors[room1].push_back(door);
+        if(room2 != NO_ROUTE) {
+            _roomDoors[room2].push_back(door);
+        }
+    }
+}
+
+std::size_t EvacuationEstimator::Side(std::size_t door, std::size_t room) const
+{
+    return 2 * door + (_doorRooms[door][0] == room ? 0 : 1);
+}
+
+std::vector<EvacuationEstimator::Routes> EvacuationEstimator::ComputeRoutes(
+    const std::vector<bool>& closed,
+    const std::vector<std::size_t>& exits) const
+{
+    const std::size_t sides = 2 * _network.doors.size();
+    const auto outside = static_cast<Graph::VertexId>(sides);
+
+    // one vertex per side of a door, the outside is only added for the routes to the nearest
+    // exit, otherwise it would connect all exits
+    auto buildGraph = [this, &closed, sides](bool withOutside) {
+        Graph::Builder builder;
+        for(std::size_t side = 0; side < sides; ++side) {
+            const Point& center = _network.doors[side / 2].center;
+            builder.AddVertex({center.x, center.y});
+        }
+        if(withOutside) {
+            builder.AddVertex({0., 0.});
+        }
+        for(std::size_t door = 0; door < _network.doors.size(); ++door) {
+            if(closed[door]) {
+                continue;
+            }
+            if(_doorRooms[door][1] != NO_ROUTE) {
+                builder.AddEdge(2 * door, 2 * door + 1, 0.);
+            } else if(withOutside) {
+                builder.AddEdge(2 * door, sides, 0.);
+            }
+        }
+        for(std::size_t room = 0; room < _roomDoors.size(); ++room) {
+            const auto& doors = _roomDoors[room];
+            for(std::size_t a = 0; a < doors.size(); ++a) {
+                for(std::size_t b = a + 1; b < doors.size(); ++b) {
+                    if(closed[doors[a]] || closed[doors[b]]) {
+                        continue;
+                    }
+                    builder.AddEdge(
+                        Side(doors[a], room),
+                        Side(doors[b], room),
+                        Distance(
+                            _network.doors[doors[a]].center, _network.doors[doors[b]].center));
+                }
+            }
+        }
+        return builder.Build();
+    };
+
+    std::vector<Graph::VertexId> nearestTargets;
+    std::vector<Graph::VertexId> exitTargets;
+    for(std::size_t exit : exits) {
+        if(exit == NO_ROUTE || closed[exit]) {
+            nearestTargets.push_back(outside);
+        } else {
+            exitTargets.push_back(static_cast<Graph::VertexId>(2 * exit));
+        }
+    }
+    Graph nearestGraph;
+    Graph exitGraph;
+    if(!nearestTargets.empty()) {
+        nearestGraph = buildGraph(true);
+        nearestGraph.ComputeShortestPathsTo(nearestTargets, 1);
+    }
+    if(!exitTargets.empty()) {
+        exitGraph = buildGraph(false);
+        exitGraph.ComputeShortestPathsTo(exitTargets, 1);
+    }
+
+    std::vector<Routes> routes;
+    std::vector<std::size_t> treeNext(sides);
+    for(std::size_t exit : exits) {
+        const bool nearest = exit == NO_ROUTE || closed[exit];
+        Graph& graph = nearest ? nearestGraph : exitGraph;
+        const auto target = nearest ? outside : static_cast<Graph::VertexId>(2 * exit);
+
+        Routes route{std::vector<double>(sides), std::vector<std::size_t>(sides, NO_ROUTE)};
+        for(std::size_t side = 0; side < sides; ++side) {
+            route.distance[side] = graph.DistanceTo(side, target);
+            treeNext[side] = graph.NextVertexTo(side, target);
+        }
+        // agents wait at the first side on their path which crosses its door or leaves, paths
+        // along collinear doors may pass several sides in the same room before
+        auto crosses = [&treeNext, sides](std::size_t side) {
+            const std::size_t next = treeNext[side];
+            return next == side || next >= sides || next / 2 == side / 2;
+        };
+        for(std::size_t side = 0; side < sides; ++side) {
+            if(route.distance[side] == std::numeric_limits<double>::max()) {
+                continue;
+            }
+            std::size_t wait = side;
+            while(!crosses(wait)) {
+                wait = treeNext[wait];
+            }
+            route.wait[side] = wait;
+        }
+        routes.push_back(std::move(route));
+    }
+    return routes;
+}
+
+std::size_t EvacuationEstimator::FindWaitSide(
+    std::size_t room,
+    const Point& position,
+    const Routes& routes) const
+{
+    std::size_t best = NO_ROUTE;
+    double bestDistance = std::numeric_limits<double>::max();
+    for(std::size_t door : _roomDoors[room]) {
+        const std::size_t side = Side(door, room);
+        if(routes.distance[side] == std::numeric_limits<double>::max()) {
+            continue;
+        }
+        const double distance =
+            Distance(position, _network.doors[door].center) + routes.distance[side];
+        if(distance < bestDistance) {
+            best = side;
+            bestDistance = distance;
+        }
+    }
+    return best == NO_ROUTE ? NO_ROUTE : routes.wait[best];
+}
+
+EvacuationEstimate EvacuationEstimator::Estimate(const std::vector<EstimatorAgent>& agents) const
+{
+    const std::size_t doorCount = _network.doors.size();
+    const double dt = _parameters.dt;
+
+    EvacuationEstimate estimate;
+    estimate.outputInterval = _parameters.outputInterval;
+    std::vector<std::size_t> exitIndex(doorCount, NO_ROUTE);
+    for(std::size_t door = 0; door < doorCount; ++door) {
+        if(_doorRooms[door][1] == NO_ROUTE) {
+            exitIndex[door] = estimate.exits.size();
+            estimate.exits.push_back({_network.doors[door].id, {0.}});
+        }
+    }
+
+    // route 0 leads to the nearest exit, the others to the exits chosen by the agents
+    std::vector<std::size_t> exits{NO_ROUTE};
+    std::vector<std::pair<const EstimatorAgent*, std::size_t>> pending;
+    for(const auto& agent : agents) {
+        if(_roomIndex.count(agent.roomID) == 0) {
+            continue;
+        }
+        std::size_t route = 0;
+        if(auto door = _doorIndex.find(agent.exitID);
+           door != _doorIndex.end() && exitIndex[door->second] != NO_ROUTE) {
+            route = std::find(exits.begin(), exits.end(), door->second) - exits.begin();
+            if(route == exits.size()) {
+                exits.push_back(door->second);
+            }
+        }
+        pending.emplace_back(&agent, route);
+    }
+    std::sort(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+        return a.first->releaseTime < b.first->releaseTime;
+    });
+
+    std::vector<bool> closed(doorCount, false);
+    auto routes = ComputeRoutes(closed, exits);
+
+    // agents waiting at each side, ordered by the time they arrive there
+    std::vector<std::vector<Cohort>> queues(2 * doorCount);
+    std::vector<double> occupancy(_network.rooms.size(), 0.);
+    std::vector<double> usage(doorCount, 0.);
+    std::vector<double> exitFlow(estimate.exits.size(), 0.);
+    std::vector<double> budget(doorCount);
+    double waiting = 0;
+    double trapped = 0;
+    std::size_t released = 0;
+
+    auto enqueue = [&queues, &waiting](std::size_t side, Cohort cohort) {
+        queues[side].push_back(cohort);
+        std::push_heap(queues[side].begin(), queues[side].end(), ReadyLater);
+        waiting += cohort.amount;
+    };
+
+    double time = 0;
+    double nextSample = _parameters.outputInterval;
+    while(time < _parameters.maxTime) {
+        for(; released < pending.size() && pending[released].first->releaseTime <= time;
+            ++released) {
+            const auto& [agent, route] = pending[released];
+            const std::size_t room = _roomIndex.at(agent->roomID);
+            occupancy[room] += 1.;
+            const std::size_t side = FindWaitSide(room, agent->position, routes[route]);
+            if(side == NO_ROUTE) {
+                trapped += 1.;
+                continue;
+            }
+            const double walk = Distance(agent->position, _network.doors[side / 2].center);
+            enqueue(side, {agent->releaseTime + walk / agent->speed, 1., agent->speed, route});
+        }
+        if(waiting < EPSILON && released == pending.size()) {
+            break;
+        }
+
+        for(std::size_t door = 0; door < doorCount; ++door) {
+            budget[door] =
+                std::min(_doorRate[door] * dt, _network.doors[door].maxUsage - usage[door]);
+        }
+        // both sides of a door share its capacity, room1 is served first
+        for(std::size_t side = 0; side < queues.size(); ++side) {
+            auto& queue = queues[side];
+            const std::size_t door = side / 2;
+            const std::size_t from = _doorRooms[door][side % 2];
+            const std::size_t to = _doorRooms[door][1 - side % 2];
+            const bool exit = to == NO_ROUTE;
+            double space =
+                exit ? std::numeric_limits<double>::max() : _roomCapacity[to] - occupancy[to];
+            while(!queue.empty() && queue.front().readyTime <= time && budget[door] > EPSILON &&
+                  space > EPSILON) {
+                Cohort& cohort = queue.front();
+                const double amount = std::min({cohort.amount, budget[door], space});
+                budget[door] -= amount;
+                space -= amount;
+                usage[door] += amount;
+                waiting -= amount;
+                occupancy[from] -= amount;
+                if(exit) {
+                    exitFlow[exitIndex[door]] += amount;
+                    estimate.evacuated += amount;
+                    estimate.clearanceTime = time + dt;
+                } else {
+                    occupancy[to] += amount;
+                    const std::size_t next = routes[cohort.route].wait[side ^ 1U];
+                    if(next == NO_ROUTE) {
+                        trapped += amount;
+                    } else {
+                        const double walk = Distance(
+                            _network.doors[door].center, _network.doors[next / 2].center);
+                        enqueue(
+                            next,
+                            {time + dt + walk / cohort.speed, amount, cohort.speed, cohort.route});
+                    }
+                }
+                cohort.amount -= amount;
+                if(cohort.amount < EPSILON) {
+                    waiting -= cohort.amount;
+                    std::pop_heap(queue.begin(), queue.end(), ReadyLater);
+                    queue.pop_back();
+                }
+            }
+        }
+
+        // doors close at their maximum usage, the agents waiting there walk to other doors
+        std::vector<std::size_t> closing;
+        for(std::size_t door = 0; door < doorCount; ++door) {
+            if(!closed[door] && usage[door] >= _network.doors[door].maxUsage - EPSILON) {
+                closed[door] = true;
+                closing.push_back(door);
+            }
+        }
+        if(!closing.empty()) {
+            routes = ComputeRoutes(closed, exits);
+            for(std::size_t door : closing) {
+                for(std::size_t side = 2 * door; side < 2 * door + 2; ++side) {
+                    const std::vector<Cohort> rerouted = std::move(queues[side]);
+                    queues[side].clear();
+                    for(const Cohort& cohort : rerouted) {
+                        waiting -= cohort.amount;
+                        const Point& position = _network.doors[door].center;
+                        const std::size_t room = _doorRooms[door][side % 2];
+                        const std::size_t next =
+                            FindWaitSide(room, position, routes[cohort.route]);
+                        if(next == NO_ROUTE) {
+                            trapped += cohort.amount;
+                            continue;
+                        }
+                        const double walk = Distance(position, _network.doors[next / 2].center);
+                        enqueue(
+                            next,
+                            {std::max(cohort.readyTime, time) + walk / cohort.speed,
+                             cohort.amount,
+                             cohort.speed,
+                             cohort.route});
+                    }
+                }
+            }
+        }
+
+        time += dt;
+        for(; nextSample <= time + EPSILON; nextSample += _parameters.outputInterval) {
+            for(std::size_t exit = 0; exit < exitFlow.size(); ++exit) {
+                estimate.exits[exit].cumulative.push_back(exitFlow[exit]);
+            }
+        }
+    }
+    // the last sample covers the end of the estimate between two sampling times
+    if(nextSample - _parameters.outputInterval < time - EPSILON) {
+        for(std::size_t exit = 0; exit < exitFlow.size(); ++exit) {
+            estimate.exits[exit].cumulative.push_back(exitFlow[exit]);
+        }
+    }
+
+    estimate.remaining = static_cast<double>(pending.size()) - estimate.evacuated;
+    if(estimate.remaining > EPSILON) {
+        estimate.clearanceTime = time;
+        if(trapped > EPSILON) {
+            LOG_WARNING("{:.0f} agents cannot reach any exit", trapped);
+        }
+    } else {
+        estimate.remaining = 0;
+    }
+    return estimate;
+}
+
+void WriteEvacuationEstimate(const EvacuationEstimate& estimate, OutputHandler& output)
+{
+    output.Write(fmt::format(
+        FMT_STRING("#Estimated clearance time: {:.2f} s, evacuated: {:.0f}, remaining: {:.0f}"),
+        estimate.clearanceTime,
+        estimate.evacuated,
+        estimate.remaining));
+    std::string header = "#Time (s)";
+    for(const auto& exit : estimate.exits) {
+        header += fmt::format(FMT_STRING(", cumulative number of agents at exit {}"), exit.doorID);
+    }
+    output.Write(header);
+
+    const std::size_t samples =
+        estimate.exits.empty() ? 0 : estimate.exits.front().cumulative.size();
+    for(std::size_t sample = 0; sample < samples; ++sample) {
+        std::string line = fmt::format(FMT_STRING("{:.2f}"), sample * estimate.outputInterval);
+        for(const auto& exit : estimate.exits) {
+            line += fmt::format(FMT_STRING(" {:.2f}"), exit.cumulative[sample]);
+        }
+        output.Write(line);
+    }
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "geometry/Point.hpp"
+#include "pedestrian/Pedestrian.hpp"
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class Building;
+class OutputHandler;
+
+/**
+ * Rooms and doors of a building as a capacity constrained network.
+ */
+struct FlowNetwork {
+    struct Room {
+        int id;
+        /// walkable area [m^2]
+        double area;
+    };
+    struct Door {
+        int id;
+        int room1;
+        /// -1 for exits
+        int room2;
+        Point center;
+        /// width [m]
+        double width;
+        /// maximum flow [1/s]
+        double outflowRate{std::numeric_limits<double>::max()};
+        /// number of agents after which the door closes
+        int maxUsage{std::numeric_limits<int>::max()};
+    };
+    std::vector<Room> rooms;
+    std::vector<Door> doors;
+};
+
+/**
+ * Creates the network of the rooms and of the doors which are not closed.
+ * @param building building with initialized geometry
+ * @return network of the building
+ */
+FlowNetwork CreateFlowNetwork(const Building& building);
+
+/**
+ * Agent of the network flow estimate.
+ */
+struct EstimatorAgent {
+    int roomID;
+    Point position;
+    /// ID of the exit the agent leaves through, -1 for the nearest exit
+    int exitID;
+    /// time [s] after which the agent starts walking
+    double releaseTime;
+    /// free walking speed [m/s]
+    double speed;
+};
+
+/**
+ * Converts the agents created from the inifile to agents of the estimate.
+ * @param building building the agents are located in
+ * @param agents agents by the iteration they enter the simulation
+ * @param dT time step [s] of the iterations
+ * @return agents of the estimate, released after their creation and premovement time. Agents
+ * with a goal outside leave through the exit closest to the goal, as in the ff router. Agents
+ * outside of all rooms are skipped.
+ */
+std::vector<EstimatorAgent> CreateEstimatorAgents(
+    const Building& building,
+    const std::multimap<size_t, std::unique_ptr<Pedestrian>>& agents,
+    double dT);
+
+struct EvacuationEstimatorParameters {
+    /// flow per door width [1/(m s)]
+    double specificFlow{1.3};
+    /// density [1/m^2] at which rooms do not accept more agents
+    double maxDensity{4.};
+    /// time step [s]
+    double dt{0.1};
+    /// sampling interval [s] of the flow curves
+    double outputInterval{1.};
+    /// end of the estimate [s]
+    double maxTime{900.};
+};
+
+/**
+ * Agents which left through an exit over time.
+ */
+struct ExitFlow {
+    int doorID;
+    /// number of agents which left through the exit until i * outputInterval
+    std::vector<double> cumulative;
+};
+
+struct EvacuationEstimate {
+    /// time [s] until the last agent left, the end of the estimate if agents remain
+    double clearanceTime{0};
+    double evacuated{0};
+    /// agents which did not leave, no exit is reachable or the estimate reached its end
+    double remaining{0};
+    double outputInterval{1.};
+    std::vector<ExitFlow> exits;
+};
+
+/**
+ * \class EvacuationEstimator
+ *
+ * \brief Estimates evacuation times with a macroscopic network flow model.
+ *
+ * Agents are continuous amounts moving through a network of rooms and doors. An agent walks at
+ * its free speed from its position to a door, queues there and crosses the door when the door
+ * has capacity left and the next room has space. Doors pass width * specificFlow agents per
+ * second, limited by their outflow rate and maximum usage. Rooms hold at most
+ * area * maxDensity agents.
+ *
+ * Agents follow the shortest path to their exit, walking straight from door to door. When a door
+ * reaches its maximum usage, it closes and the routes are recomputed. Door and train events are
+ * not considered. An estimate takes milliseconds to seconds, so many
+ * variants of a scenario can be screened before simulating the agents.
+ */
+class EvacuationEstimator
+{
+public:
+    /**
+     * @param network rooms and doors
+     * @param parameters parameters of the model
+     */
+    explicit EvacuationEstimator(
+        FlowNetwork network,
+        EvacuationEstimatorParameters parameters = {});
+
+    /**
+     * Estimates the evacuation of \p agents.
+     * @param agents agents, agents in rooms which are not part of the network are ignored
+     * @return flow through the exits and clearance time
+     */
+    EvacuationEstimate Estimate(const std::vector<EstimatorAgent>& agents) const;
+
+private:
+    static constexpr std::size_t NO_ROUTE = std::numeric_limits<std::size_t>::max();
+
+    /**
+     * Shortest paths of all sides to one exit. Side 2 * door + k is the door seen from its room1
+     * (k = 0) or its room2 (k = 1), agents waiting at a side cross the door into the other room.
+     */
+    struct Routes {
+        /// distance from each side to the exit
+        std::vector<double> distance;
+        /// side to wait at after entering the room of a side through its door, NO_ROUTE if the
+        /// exit is not reachable
+        std::vector<std::size_t> wait;
+    };
+
+    /**
+     * Computes the routes to exits.
+     * @param closed doors which do not pass agents anymore
+     * @param exits index of the exit door of each route, NO_ROUTE for the nearest exit. Routes to
+     * closed exits lead to the nearest exit.
+     * @return routes to each exit in \p exits
+     */
+    std::vector<Routes>
+    ComputeRoutes(const std::vector<bool>& closed, const std::vector<std::size_t>& exits) const;
+
+    /**
+     * @return side of a door of \p room to wait at for agents at \p position, NO_ROUTE if no
+     * exit is reachable
+     */
+    std::size_t FindWaitSide(std::size_t room, const Point& position, const Routes& routes) const;
+
+    /**
+     * @return index of the side of \p door in the room with index \p room
+     */
+    std::size_t Side(std::size_t door, std::size_t room) const;
+
+    FlowNetwork _network;
+    EvacuationEstimatorParameters _parameters;
+    std::unordered_map<int, std::size_t> _roomIndex;
+    std::unordered_map<int, std::size_t> _doorIndex;
+    /// indices of room1 and room2 of each door, NO_ROUTE for the outside
+    std::vector<std::array<std::size_t, 2>> _doorRooms;
+    /// indices of the doors of each room
+    std::vector<std::vector<std::size_t>> _roomDoors;
+    /// maximum number of agents in each room
+    std::vector<double> _roomCapacity;
+    /// agents per second through each door
+    std::vector<double> _doorRate;
+};
+
+/**
+ * Writes the flow curves of \p estimate, one line per sample and one column per exit.
+ * @param estimate estimate to write
+ * @param output destination
+ */
+void WriteEvacuationEstimate(const EvacuationEstimate& estimate, OutputHandler& output);
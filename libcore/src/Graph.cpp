@@ -1,7 +1,11 @@
 #include "Graph.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <boost/graph/detail/adjacency_list.hpp>
 #include <fmt/format.h>
+#include <limits>
+#include <thread>
 
 Graph::Graph(Graph::Type&& graph) : _graph(std::move(graph))
 {
@@ -9,21 +13,86 @@ Graph::Graph(Graph::Type&& graph) : _graph(std::move(graph))
 
 Graph::VertexId Graph::NextVertexTo(Graph::VertexId from, Graph::VertexId to)
 {
-    auto iter = _path_cache.find(to);
-    if(iter == _path_cache.end()) {
-        auto [new_iter, success] =
-            _path_cache.insert({to, std::vector<Type::vertex_descriptor>(num_vertices(_graph))});
-        assert(success);
-        iter = new_iter;
+    return _next[Tree(to) * num_vertices(_graph) + from];
+}
+
+Graph::EdgeWeight Graph::DistanceTo(Graph::VertexId from, Graph::VertexId to)
+{
+    return _distance[Tree(to) * num_vertices(_graph) + from];
+}
+
+void Graph::ComputeShortestPathsTo(const std::vector<VertexId>& targets, unsigned int threads)
+{
+    // allocate all trees before starting the threads, they only write to their own tree
+    std::vector<std::size_t> pending;
+    for(VertexId to : targets) {
+        auto iter = _treeIndex.find(to);
+        const std::size_t tree = iter == _treeIndex.end() ? AddTree(to) : iter->second;
+        if(_treeOutdated[tree]) {
+            _treeOutdated[tree] = false;
+            pending.push_back(tree);
+        }
+    }
+    if(pending.empty()) {
+        return;
     }
 
-    boost::dijkstra_shortest_paths(
-        _graph,
-        to,
-        boost::predecessor_map(boost::make_iterator_property_map(
-            iter->second.begin(), get(boost::vertex_index, _graph))));
+    if(threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned int>(std::min<std::size_t>(threads, pending.size()));
 
-    return iter->second[from];
+    std::atomic<std::size_t> nextJob{0};
+    const auto work = [this, &pending, &nextJob]() {
+        for(std::size_t job = nextJob++; job < pending.size(); job = nextJob++) {
+            ComputeTree(pending[job]);
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for(unsigned int i = 1; i < threads; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for(auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void Graph::SetEdgeWeight(Graph::VertexId from, Graph::VertexId to, Graph::EdgeWeight weight)
+{
+    auto [edge, exists] = boost::edge(from, to, _graph);
+    if(!exists) {
+        throw std::invalid_argument(fmt::format("No edge between {} and {}", from, to));
+    }
+    auto weights = get(boost::edge_weight, _graph);
+    const EdgeWeight oldWeight = weights[edge];
+    weights[edge] = weight;
+    if(weight == oldWeight) {
+        return;
+    }
+
+    const std::size_t numVertices = num_vertices(_graph);
+    constexpr EdgeWeight unreachable = std::numeric_limits<EdgeWeight>::max();
+    for(std::size_t tree = 0; tree < _treeTargets.size(); ++tree) {
+        if(_treeOutdated[tree]) {
+            continue;
+        }
+        const std::size_t offset = tree * numVertices;
+        const EdgeWeight distFrom = _distance[offset + from];
+        const EdgeWeight distTo = _distance[offset + to];
+        bool affected;
+        if(weight > oldWeight) {
+            // a more expensive edge only matters if a shortest path uses it
+            affected = (distFrom < unreachable && _next[offset + from] == to) ||
+                       (distTo < unreachable && _next[offset + to] == from);
+        } else {
+            // a cheaper edge only matters if it shortens a path
+            affected = (distTo < unreachable && weight + distTo < distFrom) ||
+                       (distFrom < unreachable && weight + distFrom < distTo);
+        }
+        _treeOutdated[tree] = affected;
+    }
 }
 
 Graph::VertexValue Graph::Value(Graph::VertexId id) const
@@ -31,6 +100,40 @@ Graph::VertexValue Graph::Value(Graph::VertexId id) const
     return _graph[id];
 };
 
+std::size_t Graph::Tree(Graph::VertexId to)
+{
+    auto iter = _treeIndex.find(to);
+    const std::size_t tree = iter == _treeIndex.end() ? AddTree(to) : iter->second;
+    if(_treeOutdated[tree]) {
+        ComputeTree(tree);
+        _treeOutdated[tree] = false;
+    }
+    return tree;
+}
+
+std::size_t Graph::AddTree(Graph::VertexId to)
+{
+    const std::size_t tree = _treeTargets.size();
+    _treeIndex.emplace(to, tree);
+    _treeTargets.push_back(to);
+    _treeOutdated.push_back(true);
+    const std::size_t size = _treeTargets.size() * num_vertices(_graph);
+    _next.resize(size);
+    _distance.resize(size);
+    return tree;
+}
+
+void Graph::ComputeTree(std::size_t tree)
+{
+    const std::size_t offset = tree * num_vertices(_graph);
+    const auto index = get(boost::vertex_index, _graph);
+    boost::dijkstra_shortest_paths(
+        _graph,
+        _treeTargets[tree],
+        boost::predecessor_map(boost::make_iterator_property_map(_next.begin() + offset, index))
+            .distance_map(boost::make_iterator_property_map(_distance.begin() + offset, index)));
+}
+
 Graph Graph::Builder::Build()
 {
     auto g = Graph{std::move(_g)};
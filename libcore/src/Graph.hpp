@@ -2,9 +2,11 @@
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
+#include <cstddef>
 #include <map>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 /// Represents a undirected graph with edge weights and vertices with
@@ -14,8 +16,11 @@
 /// Design notes:
 /// * This class is a thin layer over boost::graph mostly to hide the
 ///   complexity of boost::graph.
-/// * Shortes path querries cache results internally so that repeated
-///   querries for the same target node are constant time lookups
+/// * Shortest path trees are stored per target in flat arrays, repeated
+///   querries for the same target node are constant time lookups.
+/// * Trees can be precomputed for a set of targets on several threads with
+///   ComputeShortestPathsTo(). Changing an edge weight only invalidates the
+///   trees the change can affect, they are recomputed on the next query.
 class Graph
 {
 public:
@@ -27,11 +32,20 @@ public:
         boost::vecS,
         boost::undirectedS,
         std::tuple<double, double>,
-        boost::property<boost::edge_weight_t, int>>;
+        boost::property<boost::edge_weight_t, EdgeWeight>>;
 
 private:
     Type _graph;
-    std::map<VertexId, std::vector<Type::vertex_descriptor>> _path_cache;
+    /// index of the shortest path tree of each target
+    std::unordered_map<VertexId, std::size_t> _treeIndex;
+    /// targets of the trees
+    std::vector<VertexId> _treeTargets;
+    /// trees which need to be recomputed after an edge weight changed
+    std::vector<bool> _treeOutdated;
+    /// next vertex towards the target of tree t is stored at [t * num_vertices + from]
+    std::vector<Type::vertex_descriptor> _next;
+    /// distances to the target of tree t are stored at [t * num_vertices + from]
+    std::vector<EdgeWeight> _distance;
 
 public:
     class Builder;
@@ -49,14 +63,44 @@ public:
     /// result in a out of bounds read.
     /// @param from, vertex id where to start the path.
     /// @param to, vertex id of the destination.
-    /// @return vertex id of the next vertex along the path.
+    /// @return vertex id of the next vertex along the path, from itself if to is not reachable.
     VertexId NextVertexTo(VertexId from, VertexId to);
+    /// Returns the length of the shortest path between two nodes.
+    /// WARNING: Be aware that NO BOUNDS checks are done. Using an unknown id will
+    /// result in a out of bounds read.
+    /// @param from, vertex id where to start the path.
+    /// @param to, vertex id of the destination.
+    /// @return length of the path, std::numeric_limits<EdgeWeight>::max() if to is not reachable.
+    EdgeWeight DistanceTo(VertexId from, VertexId to);
+    /// Computes the shortest path trees to all targets which are not computed yet or outdated.
+    /// Each tree is computed on its own, they are distributed over several threads.
+    /// Afterwards, querries for these targets do not modify the graph and can be done
+    /// concurrently until the next edge weight changes.
+    /// @param targets, vertex ids of the destinations.
+    /// @param threads, maximum number of threads, 0 uses one thread per hardware thread.
+    void ComputeShortestPathsTo(const std::vector<VertexId>& targets, unsigned int threads = 0);
+    /// Changes the weight of the edge between two vertices.
+    /// Only the shortest path trees using this edge (weight increased) or becoming shorter
+    /// by it (weight decreased) are marked as outdated.
+    /// @param from first vertex of the edge
+    /// @param to second vertex of the edge
+    /// @param weight new weight of the edge
+    /// @throw std::invalid_argument if there is no such edge
+    void SetEdgeWeight(VertexId from, VertexId to, EdgeWeight weight);
     /// Read the associated value of vertex
     /// WARNING: Be aware that NO BOUNDS checks are done. Using an unknown id will
     /// result in a out of bounds read.
     /// @param id of vertex to read.
     /// @return VertexValue of vertex with this id.
     VertexValue Value(VertexId id) const;
+
+private:
+    /// Returns the tree of a target and computes it if necessary.
+    std::size_t Tree(VertexId to);
+    /// Adds storage for the tree of a target, the tree is marked as outdated.
+    std::size_t AddTree(VertexId to);
+    /// Runs Dijkstra from the target of a tree and stores the result in the flat arrays.
+    void ComputeTree(std::size_t tree);
 };
 
 class Graph::Builder
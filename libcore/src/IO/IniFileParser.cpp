@@ -70,6 +70,7 @@ private:
     bool ParseExternalFiles(const TiXmlNode& xMain);
 
     std::optional<GlobalRouterParameters> ParseGlobalRouterParmeters(const TiXmlElement* e);
+    bool ParseFfRouterParameters(const TiXmlElement* e);
 
     Configuration* _config;
     int _model;
@@ -697,6 +698,16 @@ bool IniFileParser::ParseRoutingStrategies(TiXmlNode* routingNode, TiXmlNode* ag
         LOG_ERROR("Agent Distribution section is missing");
         return false;
     }
+
+    if(const auto* period = routingNode->ToElement()->Attribute("reevaluation_period")) {
+        _config->routeReevaluationPeriod = xmltoi(period, 1);
+        if(_config->routeReevaluationPeriod < 1) {
+            LOG_ERROR("The route reevaluation period has to be at least 1 step.");
+            return false;
+        }
+        LOG_INFO(
+            "Agents reevaluate their route every {} steps.", _config->routeReevaluationPeriod);
+    }
     // first get list of actually used router
     std::set<int> usedRouter;
     for(TiXmlElement* e = agentsDistri->FirstChildElement("group"); e;
@@ -725,10 +736,12 @@ bool IniFileParser::ParseRoutingStrategies(TiXmlNode* routingNode, TiXmlNode* ag
 
         // TODO(kkratz) this code is senitive for the order in which sections are parsed.
         // This is a hidden dependency and needs to be addressed
-        if(strategy == RoutingStrategy::ROUTING_FF_GLOBAL_SHORTEST &&
+        if((strategy == RoutingStrategy::ROUTING_FF_GLOBAL_SHORTEST ||
+            strategy == RoutingStrategy::ROUTING_FF_HIERARCHICAL) &&
            _config->directionStrategyType != DirectionStrategyType::LOCAL_FLOORFIELD) {
-            LOG_WARNING("Routing strategy used is ff_gloabl_shortest. Using exit strategy 8 "
-                        "recommended!");
+            LOG_WARNING(
+                "Routing strategy used is {}. Using exit strategy 8 recommended!",
+                strategyAsString);
         }
 
         if(strategy == RoutingStrategy::UNKNOWN) {
@@ -736,6 +749,11 @@ bool IniFileParser::ParseRoutingStrategies(TiXmlNode* routingNode, TiXmlNode* ag
             return false;
         }
 
+        if(strategy == RoutingStrategy::ROUTING_FF_GLOBAL_SHORTEST &&
+           !ParseFfRouterParameters(e)) {
+            return false;
+        }
+
         const auto params = ParseGlobalRouterParmeters(e);
         if(const auto [_, success] =
                _config->routingStrategies.try_emplace(id, std::make_tuple(strategy, params));
@@ -854,7 +872,8 @@ bool IniFileParser::ParseStrategyNodeToObject(const TiXmlNode& strategyNode)
                      usedRouter.end())) {
                     std::string router_descr = e->Attribute("description");
                     if((pExitStrategy != 9) && (pExitStrategy != 8) &&
-                       router_descr == "ff_global_shortest") {
+                       (router_descr == "ff_global_shortest" ||
+                        router_descr == "ff_hierarchical")) {
                         pExitStrategy = 8;
                         LOG_WARNING("Changing Exit Strategie to work with floorfield!");
                     }
@@ -944,6 +963,26 @@ bool IniFileParser::ParseFfOpts(const TiXmlNode& strategyNode)
         else
             LOG_INFO("UseWAD: no");
     }
+
+    query = "lazy_floorfields";
+    if(strategyNode.FirstChild(query.c_str())) {
+        std::string tmp = strategyNode.FirstChild(query.c_str())->FirstChild()->Value();
+        _config->useLazyFloorfields = (tmp == "true");
+        LOG_INFO("Lazy floor fields: {}", _config->useLazyFloorfields ? "yes" : "no");
+    }
+
+    query = "floorfield_room_memory_budget";
+    if(strategyNode.FirstChild(query.c_str())) {
+        const char* tmp = strategyNode.FirstChild(query.c_str())->FirstChild()->Value();
+        double pMemoryBudget = atof(tmp);
+        if(pMemoryBudget < 0) {
+            LOG_ERROR(
+                "floorfield_room_memory_budget has to be non-negative, got {}", pMemoryBudget);
+            return false;
+        }
+        _config->floorfieldRoomMemoryBudget = pMemoryBudget;
+        LOG_INFO("Floor field memory budget per room field: {} MB", pMemoryBudget);
+    }
     return true;
 }
 
@@ -1091,6 +1130,38 @@ IniFileParser::ParseGlobalRouterParmeters(const TiXmlElement* e)
     return result;
 }
 
+bool IniFileParser::ParseFfRouterParameters(const TiXmlElement* e)
+{
+    const auto* parameters = e->FirstChild("parameters");
+    if(!parameters) {
+        return true;
+    }
+    const auto* quickest = parameters->FirstChildElement("quickest");
+    if(!quickest) {
+        return true;
+    }
+
+    _config->ffQuickestInterval = xmltof(quickest->Attribute("interval"), 0.);
+    if(_config->ffQuickestInterval < 0) {
+        LOG_ERROR("quickest interval has to be non-negative, got {}", _config->ffQuickestInterval);
+        return false;
+    }
+    _config->ffQuickestAsync = std::string(xmltoa(quickest->Attribute("async"), "false")) == "true";
+    _config->ffQuickestApplyAfterSteps = xmltoi(quickest->Attribute("apply_after_steps"), 0);
+    if(_config->ffQuickestApplyAfterSteps < 0) {
+        LOG_ERROR(
+            "quickest apply_after_steps has to be non-negative, got {}",
+            _config->ffQuickestApplyAfterSteps);
+        return false;
+    }
+    LOG_INFO(
+        "ff router quickest paths: interval {} s, async: {}, apply after {} steps",
+        _config->ffQuickestInterval,
+        _config->ffQuickestAsync ? "yes" : "no",
+        _config->ffQuickestApplyAfterSteps);
+    return true;
+}
+
 Configuration ParseIniFile(const std::filesystem::path& path)
 {
     Configuration config{};
@@ -188,6 +188,7 @@ std::shared_ptr<AgentsSource> PedDistributionParser::parseSourceNode(TiXmlElemen
     int group_id = xmltoi(e->Attribute("group_id"), -1);
     std::string caption = xmltoa(e->Attribute("caption"), "no caption");
     std::string str_greedy = xmltoa(e->Attribute("greedy"), "false");
+    std::string str_placement = xmltoa(e->Attribute("placement"), "voronoi");
     float percent = xmltof(e->Attribute("percent"), 1);
     float rate = xmltof(e->Attribute("rate"), -1);
     double time = xmltof(e->Attribute("time"), 0);
@@ -259,6 +260,18 @@ std::shared_ptr<AgentsSource> PedDistributionParser::parseSourceNode(TiXmlElemen
         boundaries,
         lifeSpan);
 
+    auto placement = AgentsSource::Placement::VORONOI;
+    if(str_placement == "best_candidate") {
+        placement = AgentsSource::Placement::BEST_CANDIDATE;
+    } else if(str_placement != "voronoi") {
+        LOG_WARNING(
+            "Source {}. Unknown placement <{}>, the agents are placed with voronoi.",
+            id,
+            str_placement);
+    }
+    // every source draws its own positions, independent of the other sources
+    source->SetPlacement(placement, _configuration->seed + static_cast<unsigned int>(id));
+
     LOG_INFO("Source with id {} will be parsed (greedy = {}).", id, greedy);
     return source;
 }
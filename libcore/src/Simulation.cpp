@@ -68,12 +68,15 @@ Simulation::Simulation(
     , _clock(_config->dT)
     , _neighborhoodSearch(_config->linkedCellSize)
     , _building(std::move(building))
-    , _directionManager(DirectionManager::Create(*args, _building.get()))
+    , _floorfields(std::make_unique<FloorfieldRepository>())
+    , _directionManager(DirectionManager::Create(*args, _building.get(), _floorfields.get()))
     , _geometry(std::move(geometry))
     , _routingEngine(
-          std::make_unique<RoutingEngine>(args, _building.get(), _directionManager.get()))
+          std::make_unique<RoutingEngine>(
+              args, _building.get(), _directionManager.get(), _floorfields.get()))
     , _operationalModel(
           OperationalModel::CreateFromType(args->operationalModel, *args, _directionManager.get()))
+    , _goalManager(std::make_unique<GoalManager>(_building.get(), this, args->seed))
 {
     _routingEngine->SetSimulation(this);
 }
@@ -97,8 +100,8 @@ void Simulation::Iterate()
     }
 
     if(t_in_sec > Pedestrian::GetMinPremovementTime()) {
-        _routingEngine->setNeedUpdate(_eventProcessed || _routingEngine->NeedsUpdate());
         UpdateRoutes();
+        _directionManager->ComputeTargets(_agents);
         std::vector<std::optional<PedestrianUpdate>> updates(_agents.size(), std::nullopt);
         std::transform(
             _agents.begin(),
@@ -120,15 +123,14 @@ void Simulation::Iterate()
             ++agent_iter;
         });
 
-        if(_eventProcessed) {
-            _directionManager->GetDirectionStrategy().ReInit();
+        if(!_changedRooms.empty()) {
+            _directionManager->GetDirectionStrategy().ReInit(_changedRooms);
+            _changedRooms.clear();
         }
         UpdateLocations();
 
-        GoalManager gm{_building.get(), this};
-        gm.update(t_in_sec);
+        _goalManager->update(t_in_sec);
     }
-    _eventProcessed = false;
     _clock.Advance();
 }
 
@@ -136,6 +138,8 @@ void Simulation::AddAgent(std::unique_ptr<Pedestrian>&& agent)
 {
     agent->SetBuilding(_building.get());
     const Point pos = agent->GetPos();
+    auto [room, subroom] = _building->GetRoomAndSubRoom(pos);
+    agent->UpdateRoom(room, subroom);
     auto* router = _routingEngine->GetRouter(agent->GetRouterID());
     Point target = Point{0.0, 0.0};
     if(router->FindExit(agent.get()) == -1) {
@@ -159,6 +163,7 @@ void Simulation::AddAgent(std::unique_ptr<Pedestrian>&& agent)
     E.SetCosPhi(orientation.x);
     E.SetSinPhi(orientation.y);
     agent->SetEllipse(E);
+    _agentIndex.emplace(agent->GetUID(), _agents.size());
     _agents.emplace_back(std::move(agent));
 }
 
@@ -171,27 +176,34 @@ void Simulation::AddAgents(std::vector<std::unique_ptr<Pedestrian>>&& agents)
 
 void Simulation::RemoveAgents(std::vector<Pedestrian::UID> ids)
 {
+    // the agents keep their order, the agents behind the first removed one are moved forward
+    std::size_t first = _agents.size();
+    for(auto id : ids) {
+        auto iter = _agentIndex.find(id);
+        if(iter == _agentIndex.end()) {
+            continue;
+        }
+        first = std::min(first, iter->second);
+        _agents[iter->second].reset();
+        _agentIndex.erase(iter);
+    }
+    if(first == _agents.size()) {
+        return;
+    }
     _agents.erase(
-        std::remove_if(
-            _agents.begin(),
-            _agents.end(),
-            [&ids](auto& agent) {
-                const auto uid = agent->GetUID();
-                return std::find_if(ids.begin(), ids.end(), [uid](Pedestrian::UID other) {
-                           return uid == other;
-                       }) != ids.end();
-            }),
-        _agents.end());
+        std::remove(_agents.begin() + first, _agents.end(), nullptr), _agents.end());
+    for(std::size_t index = first; index < _agents.size(); ++index) {
+        _agentIndex[_agents[index]->GetUID()] = index;
+    }
 }
 
 Pedestrian& Simulation::Agent(Pedestrian::UID id) const
 {
-    const auto iter = std::find_if(
-        _agents.begin(), _agents.end(), [id](auto& ped) { return id == ped->GetUID(); });
-    if(iter == _agents.end()) {
+    const auto iter = _agentIndex.find(id);
+    if(iter == _agentIndex.end()) {
         throw std::logic_error("Trying to access unknown Agent.");
     }
-    return **iter;
+    return *_agents[iter->second];
 }
 
 const std::vector<std::unique_ptr<Pedestrian>>& Simulation::Agents() const
@@ -206,26 +218,30 @@ size_t Simulation::GetPedsNumber() const
 
 void Simulation::OpenDoor(int doorId)
 {
-    _eventProcessed = true;
-    _building->GetTransition(doorId)->Open(true);
+    auto* door = _building->GetTransition(doorId);
+    door->Open(true);
+    _routingEngine->MarkDoorChanged(door->GetUniqueID());
 }
 
 void Simulation::TempCloseDoor(int doorId)
 {
-    _eventProcessed = true;
-    _building->GetTransition(doorId)->TempClose(true);
+    auto* door = _building->GetTransition(doorId);
+    door->TempClose(true);
+    _routingEngine->MarkDoorChanged(door->GetUniqueID());
 }
 
 void Simulation::CloseDoor(int doorId)
 {
-    _eventProcessed = true;
-    _building->GetTransition(doorId)->Close(true);
+    auto* door = _building->GetTransition(doorId);
+    door->Close(true);
+    _routingEngine->MarkDoorChanged(door->GetUniqueID());
 }
 
 void Simulation::ResetDoor(int doorId)
 {
-    _eventProcessed = true;
-    _building->GetTransition(doorId)->ResetDoorUsage();
+    auto* door = _building->GetTransition(doorId);
+    door->ResetDoorUsage();
+    _routingEngine->MarkDoorChanged(door->GetUniqueID());
 }
 
 void Simulation::ActivateTrain(
@@ -237,7 +253,12 @@ void Simulation::ActivateTrain(
 {
     geometry::helper::AddTrainDoors(
         trainId, trackId, *_building, type, startOffset, reversed, *_geometry);
-    _eventProcessed = true;
+
+    const int roomID = _building->GetTrack(trackId)->_roomID;
+    _building->InitGrid();
+    _floorfields->Invalidate(roomID);
+    _routingEngine->MarkRoomChanged(roomID);
+    _changedRooms.insert(roomID);
 };
 
 void Simulation::DeactivateTrain(int trainId, int trackId)
@@ -281,21 +302,21 @@ void Simulation::DeactivateTrain(int trainId, int trackId)
     }
 
     // remove added doors
-    const auto tempDoors = _building->GetTrainDoorsAdded(trainId);
-    if(tempDoors) {
-        std::for_each(
-            std::begin(tempDoors.value()),
-            std::end(tempDoors.value()),
-            [&subroom, this](const Transition& door) {
-                subroom->RemoveTransitionByUID(door.GetUniqueID());
-                _building->RemoveTransition(&door);
-            });
+    const auto& trainDoors = _building->GetTrainDoorUsage();
+    if(const auto train = trainDoors.find(trainId); train != trainDoors.end()) {
+        for(const Transition* door : train->second._doors) {
+            subroom->RemoveTransitionByUID(door->GetUniqueID());
+            _building->RemoveTransition(door);
+        }
 
         _building->ClearTrainDoorsAdded(trainId);
     }
 
     subroom->Update();
-    _eventProcessed = true;
+    _building->InitGrid();
+    _floorfields->Invalidate(roomID);
+    _routingEngine->MarkRoomChanged(roomID);
+    _changedRooms.insert(roomID);
 };
 
 bool Simulation::InitArgs()
@@ -334,16 +355,18 @@ bool Simulation::InitArgs()
 
 void Simulation::UpdateLocations()
 {
-    SimulationHelper::UpdateFlowAtDoors(*_building, _agents, _clock.ElapsedTime());
-    auto pedsOutside = SimulationHelper::FindPedestriansOutside(*_building, _agents);
+    auto pedsOutside =
+        SimulationHelper::UpdateLocations(*_building, _agents, _clock.ElapsedTime());
     RemoveAgents(pedsOutside);
 
     // TODO discuss simulation flow -> better move to main loop, does not belong here
-    bool geometryChangedFlow = SimulationHelper::UpdateFlowRegulation(*_building, _clock);
-    bool geometryChangedTrain =
-        SimulationHelper::UpdateTrainFlowRegulation(*_building, _clock.ElapsedTime());
-
-    _routingEngine->setNeedUpdate(geometryChangedFlow || geometryChangedTrain);
+    for(int doorUID : SimulationHelper::UpdateFlowRegulation(*_building, _clock)) {
+        _routingEngine->MarkDoorChanged(doorUID);
+    }
+    for(int doorUID :
+        SimulationHelper::UpdateTrainFlowRegulation(*_building, _clock.ElapsedTime())) {
+        _routingEngine->MarkDoorChanged(doorUID);
+    }
 }
 
 void Simulation::UpdateRoutes()
@@ -353,9 +376,15 @@ void Simulation::UpdateRoutes()
         _routingEngine->UpdateRouter();
     }
     for(const auto& ped : _agents) {
-        // set ped waiting, if no target is found
+        const SubRoom* subroom = ped->GetSubRoom();
+        const int roomID = subroom->GetRoomID();
+        const int subRoomID = subroom->GetSubRoomID();
+
         auto* router = _routingEngine->GetRouter(ped->GetRouterID());
-        int target = router->FindExit(ped.get());
+        const int target = SimulationHelper::FindExit(
+            *router, *ped, _clock.Iteration(), _config->routeReevaluationPeriod);
+
+        // set ped waiting, if no target is found
 
         if(target == FINAL_DEST_OUT) {
             ped->StartWaiting();
@@ -366,8 +395,6 @@ void Simulation::UpdateRoutes()
         }
         if(target != FINAL_DEST_OUT) {
             const Hline* door = _building->GetTransOrCrossByUID(target);
-            auto [roomID, subRoomID, _] = _building->GetRoomAndSubRoomIDs(ped->GetPos());
-
             if(const auto* cross = dynamic_cast<const Crossing*>(door)) {
                 if(cross->IsInRoom(roomID) && cross->IsInSubRoom(subRoomID)) {
                     if(!ped->IsWaiting() && cross->IsTempClose()) {
@@ -386,7 +413,7 @@ void Simulation::UpdateRoutes()
 
 void Simulation::PrintStatistics(double simTime)
 {
-    LOG_INFO("Usage of Exits");
+    LOG_INFO("Usage of Exits at t={:.2f} s", simTime);
     for(const auto& itr : _building->GetAllTransitions()) {
         Transition* goal = itr.second;
         if(goal->GetDoorUsage()) {
@@ -409,15 +436,15 @@ void Simulation::PrintStatistics(double simTime)
             statsfile = _config->outputPath / statsfile;
 
             LOG_INFO("More Information in the file: {}", statsfile.string());
-            {
-                FileHandler statOutput(statsfile);
-                statOutput.Write(fmt::format(FMT_STRING("#Simulation time: :.2f"), simTime));
-                statOutput.Write(
+            auto& statOutput = _flowFiles[goal];
+            if(!statOutput) {
+                statOutput = std::make_unique<FileHandler>(statsfile);
+                statOutput->Write(
                     "#Flow at exit " + goal->GetCaption() + "( ID " +
                     std::to_string(goal->GetID()) + " )");
-                statOutput.Write("#Time (s), cummulative number of agents, pedestrian ID\n");
-                statOutput.Write(goal->GetFlowCurve());
+                statOutput->Write("#Time (s), cummulative number of agents, pedestrian ID\n");
             }
+            goal->GetFlowRecorder().Flush(*statOutput);
         }
     }
 
@@ -436,14 +463,16 @@ void Simulation::PrintStatistics(double simTime)
             fs::path statsfile = "flow_crossing_id_" + std::to_string(itr.first / 1000) + "_" +
                                  std::to_string(itr.first % 1000) + ".dat";
             LOG_INFO("More Information in the file: {}", statsfile.string());
-            FileHandler output(statsfile);
-            output.Write(fmt::format(FMT_STRING("#Simulation time: :.2f"), simTime));
-            output.Write(
-                "#Flow at crossing " + goal->GetCaption() + "( ID " +
-                std::to_string(goal->GetID()) + " ) in Room ( ID " +
-                std::to_string(itr.first / 1000) + " )");
-            output.Write("#Time (s)  cummulative number of agents \n");
-            output.Write(goal->GetFlowCurve());
+            auto& output = _flowFiles[goal];
+            if(!output) {
+                output = std::make_unique<FileHandler>(statsfile);
+                output->Write(
+                    "#Flow at crossing " + goal->GetCaption() + "( ID " +
+                    std::to_string(goal->GetID()) + " ) in Room ( ID " +
+                    std::to_string(itr.first / 1000) + " )");
+                output->Write("#Time (s)  cummulative number of agents \n");
+            }
+            goal->GetFlowRecorder().Flush(*output);
         }
     }
 }
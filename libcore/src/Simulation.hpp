@@ -44,11 +44,14 @@
 #include "pedestrian/PedDistributor.hpp"
 #include "pedestrian/Pedestrian.hpp"
 #include "routing/RoutingEngine.hpp"
+#include "routing/ff_router/FloorfieldRepository.hpp"
 #include "routing/global_shortest/GlobalRouter.hpp"
 
 #include <chrono>
 #include <cstddef>
 #include <memory>
+#include <set>
+#include <unordered_map>
 
 class Simulation
 {
@@ -60,12 +63,20 @@ private:
     unsigned int _seed{8091983};
     NeighborhoodSearch _neighborhoodSearch;
     std::unique_ptr<Building> _building;
+    /// floor fields shared by the direction strategy and the routers
+    std::unique_ptr<FloorfieldRepository> _floorfields;
     std::unique_ptr<DirectionManager> _directionManager;
     std::unique_ptr<Geometry> _geometry;
     std::unique_ptr<RoutingEngine> _routingEngine;
     std::unique_ptr<OperationalModel> _operationalModel;
+    std::unique_ptr<GoalManager> _goalManager;
     std::vector<std::unique_ptr<Pedestrian>> _agents;
-    bool _eventProcessed{false};
+    /// position of each agent in _agents
+    std::unordered_map<Pedestrian::UID, std::size_t> _agentIndex;
+    /// IDs of rooms whose geometry changed since the direction strategy was last updated
+    std::set<int> _changedRooms{};
+    /// flow files of the doors, passages are appended to them by PrintStatistics
+    std::unordered_map<const Crossing*, std::unique_ptr<FileHandler>> _flowFiles;
 
 public:
     Simulation(
@@ -124,7 +135,8 @@ public:
     bool InitArgs();
 
     /**
-     * print some statistics about the simulation
+     * print some statistics about the simulation and append the passages recorded since the
+     * last call to the flow files of the doors
      */
     void PrintStatistics(double time);
 
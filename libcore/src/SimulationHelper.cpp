@@ -29,54 +29,102 @@
 #include <algorithm>
 #include <iterator>
 #include <memory>
+#include <thread>
 
-std::vector<Pedestrian::UID> SimulationHelper::FindPedestriansOutside(
-    const Building& building,
-    const std::vector<std::unique_ptr<Pedestrian>>& peds)
+namespace
 {
-    std::vector<Pedestrian::UID> pedsOutside;
-    for(const auto& ped : peds) {
-        if(!building.IsInAnySubRoom(ped->GetPos())) {
-            pedsOutside.push_back(ped->GetUID());
-        }
-    }
-    return pedsOutside;
-}
+/// pedestrians located by each thread, fewer pedestrians are located on the calling thread only
+constexpr std::size_t MIN_PEDS_PER_THREAD = 1000;
+} // namespace
 
-void SimulationHelper::UpdateFlowAtDoors(
+std::vector<Pedestrian::UID> SimulationHelper::UpdateLocations(
     Building& building,
     const std::vector<std::unique_ptr<Pedestrian>>& peds,
-    double time)
+    double time,
+    std::size_t maxThreads)
 {
-    for(const auto& ped : peds) {
-        const auto* subroom = building.IsInAnySubRoom(ped->GetPos()) ?
-                                  building.GetSubRoom(ped->GetPos()) :
-                                  building.GetSubRoom(ped->GetLastPosition());
+    // door passed by each pedestrian in the last step
+    std::vector<Transition*> passedDoors(peds.size(), nullptr);
+    const auto locate = [&building, &peds, &passedDoors](std::size_t begin, std::size_t end) {
+        for(std::size_t index = begin; index < end; ++index) {
+            auto& ped = *peds[index];
+            SubRoom* previous = ped.GetSubRoom();
+            auto [room, subroom] = building.LocateSubRoom(ped.GetPos(), previous);
+            ped.UpdateRoom(room, subroom);
+
+            // doors are searched in the new subroom, or in the old one if the ped left the
+            // geometry
+            const SubRoom* doorsOf = subroom != nullptr ? subroom : previous;
+            if(doorsOf == nullptr) {
+                continue;
+            }
+            if(auto passedDoor = FindPassedDoor(ped, doorsOf->GetAllTransitions())) {
+                passedDoors[index] = *passedDoor;
+            }
+        }
+    };
 
-        auto passedDoor = FindPassedDoor(*ped, subroom->GetAllTransitions());
+    if(maxThreads == 0) {
+        maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const std::size_t threads =
+        std::min(maxThreads, std::max<std::size_t>(1, peds.size() / MIN_PEDS_PER_THREAD));
+    const std::size_t chunk = (peds.size() + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for(std::size_t thread = 1; thread < threads; ++thread) {
+        workers.emplace_back(
+            locate, thread * chunk, std::min(peds.size(), (thread + 1) * chunk));
+    }
+    locate(0, std::min(peds.size(), chunk));
+    for(auto& worker : workers) {
+        worker.join();
+    }
 
-        if(!passedDoor.has_value()) {
-            continue;
+    std::vector<Pedestrian::UID> pedsOutside;
+    for(std::size_t index = 0; index < peds.size(); ++index) {
+        const auto& ped = peds[index];
+        if(ped->GetSubRoom() == nullptr) {
+            pedsOutside.push_back(ped->GetUID());
         }
 
-        if(ped->GetDestination() >= 0 &&
-           (building.GetTransitionByUID(ped->GetDestination()) != nullptr) &&
-           passedDoor.value()->GetUniqueID() !=
-               building.GetTransitionByUID(ped->GetDestination())->GetUniqueID()) {
+        Transition* passedDoor = passedDoors[index];
+        if(passedDoor == nullptr) {
             continue;
         }
-        passedDoor.value()->IncreaseDoorUsage(1, time, ped->GetUID());
-        passedDoor.value()->IncreasePartialDoorUsage(1);
+        if(ped->GetDestination() >= 0) {
+            const auto* destination = building.GetTransitionByUID(ped->GetDestination());
+            if(destination != nullptr &&
+               passedDoor->GetUniqueID() != destination->GetUniqueID()) {
+                continue;
+            }
+        }
+        passedDoor->IncreaseDoorUsage(1, time, ped->GetUID());
+        passedDoor->IncreasePartialDoorUsage(1);
+        building.IncreaseTrainDoorUsage(passedDoor->GetUniqueID(), 1);
     }
+    return pedsOutside;
 }
 
 std::optional<Transition*>
 SimulationHelper::FindPassedDoor(const Pedestrian& ped, const std::vector<Transition*>& transitions)
 {
     Line step{ped.GetLastPosition(), ped.GetPos(), 0};
+    const Point& from = step.GetPoint1();
+    const Point& to = step.GetPoint2();
     // TODO check for closed doors and distance?
     auto passedTrans = std::find_if(
-        std::begin(transitions), std::end(transitions), [&step](const Transition* trans) -> bool {
+        std::begin(transitions),
+        std::end(transitions),
+        [&step, &from, &to](const Transition* trans) -> bool {
+            // only doors whose bounding box overlaps the one of the step can be passed
+            const Point& p1 = trans->GetPoint1();
+            const Point& p2 = trans->GetPoint2();
+            if(std::max(p1.x, p2.x) + J_EPS < std::min(from.x, to.x) ||
+               std::min(p1.x, p2.x) - J_EPS > std::max(from.x, to.x) ||
+               std::max(p1.y, p2.y) + J_EPS < std::min(from.y, to.y) ||
+               std::min(p1.y, p2.y) - J_EPS > std::max(from.y, to.y)) {
+                return false;
+            }
             return trans->IntersectionWith(step) == 1;
         });
 
@@ -86,9 +134,10 @@ SimulationHelper::FindPassedDoor(const Pedestrian& ped, const std::vector<Transi
     return *passedTrans;
 }
 
-bool SimulationHelper::UpdateFlowRegulation(Building& building, const SimulationClock& clock)
+std::vector<int>
+SimulationHelper::UpdateFlowRegulation(Building& building, const SimulationClock& clock)
 {
-    bool stateChanged = false;
+    std::vector<int> changedDoors;
 
     for(auto [transID, trans] : building.GetAllTransitions()) {
         DoorState state = trans->GetState();
@@ -107,48 +156,59 @@ bool SimulationHelper::UpdateFlowRegulation(Building& building, const Simulation
             }
         }
 
-        stateChanged = stateChanged || (state != trans->GetState());
+        if(state != trans->GetState()) {
+            changedDoors.emplace_back(trans->GetUniqueID());
+        }
     }
-    return stateChanged;
+    return changedDoors;
 }
 
-bool SimulationHelper::UpdateTrainFlowRegulation(Building& building, double time)
+std::vector<int> SimulationHelper::UpdateTrainFlowRegulation(Building& building, double time)
 {
-    bool geometryChanged = false;
-    for(auto const& [trainID, trainType] : building.GetTrains()) {
-        auto trainAddedDoors = building.GetTrainDoorsAdded(trainID);
-        if(trainAddedDoors.has_value()) {
-            auto trainDoors = trainAddedDoors.value();
-
-            int trainUsage = std::accumulate(
-                std::begin(trainDoors),
-                std::end(trainDoors),
-                0,
-                [&building](int i, const Transition& trans) {
-                    return building.GetTransition(trans.GetID())->GetDoorUsage() + i;
-                });
-
-            int maxAgents = trainType._maxAgents;
-            if(trainUsage > maxAgents) {
-                std::for_each(
-                    std::begin(trainDoors),
-                    std::end(trainDoors),
-                    [&building, trainUsage, maxAgents, time](Transition trans) {
-                        if(!building.GetTransition(trans.GetID())->IsClose()) {
-                            building.GetTransition(trans.GetID())->Close();
-                            LOG_INFO(
-                                "Closing train door {} with ID {} at t={:.2f}. Door usage = {} "
-                                "(Train Capacity {})",
-                                trans.GetType(),
-                                trans.GetID(),
-                                time,
-                                trainUsage,
-                                maxAgents);
-                        }
-                    });
-                geometryChanged = true;
+    std::vector<int> closedDoors;
+    const auto& trains = building.GetTrains();
+    for(const auto& [trainID, trainDoors] : building.GetTrainDoorUsage()) {
+        const auto train = trains.find(trainID);
+        if(train == trains.end()) {
+            continue;
+        }
+        const int trainUsage = trainDoors._usage;
+        const int maxAgents = train->second._maxAgents;
+        if(trainUsage <= maxAgents) {
+            continue;
+        }
+        for(Transition* trans : trainDoors._doors) {
+            if(!trans->IsClose()) {
+                trans->Close();
+                closedDoors.emplace_back(trans->GetUniqueID());
+                LOG_INFO(
+                    "Closing train door {} with ID {} at t={:.2f}. Door usage = {} "
+                    "(Train Capacity {})",
+                    trans->GetType(),
+                    trans->GetID(),
+                    time,
+                    trainUsage,
+                    maxAgents);
             }
         }
     }
-    return geometryChanged;
+    return closedDoors;
+}
+
+int SimulationHelper::FindExit(
+    Router& router,
+    Pedestrian& ped,
+    std::uint64_t iteration,
+    int period)
+{
+    const int subRoomUID = ped.GetSubRoom()->GetUID();
+    const std::size_t routesVersion = router.GetRoutesVersion();
+    const int target = ped.GetRouteDecision(subRoomUID, routesVersion);
+    if(target != FINAL_DEST_OUT &&
+       (iteration + ped.GetUID().getID()) % static_cast<std::uint64_t>(period) != 0) {
+        return target;
+    }
+    const int newTarget = router.FindExit(&ped);
+    ped.SetRouteDecision(subRoomUID, routesVersion, newTarget);
+    return newTarget;
 }
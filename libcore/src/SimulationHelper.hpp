@@ -23,7 +23,10 @@
 #include "geometry/Building.hpp"
 #include "geometry/Transition.hpp"
 #include "pedestrian/Pedestrian.hpp"
+#include "routing/Router.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -31,43 +34,56 @@
 namespace SimulationHelper
 {
 /**
- * Find pedestrians who have moved to outside of the geometry, and are no longer in the simulation
- * scope.
- * @pre For each ped in peds at least once UpdateRoom(-1,-1) is called, should be done by
- * SimulationHelper::UpdatePedestriansLocations. Meaning that the pedestrian could not be located to
- * one of the neighboring rooms.
+ * Updates the locations of the pedestrians after they moved, in a single pass over them:
+ * - the room and subroom of each pedestrian are updated, the search starts at the previous
+ *   subroom of the pedestrian and its neighbors,
+ * - the door usage of the transitions passed in the last step is increased,
+ * - pedestrians who moved to outside of the geometry are collected.
+ * Locating the pedestrians and searching the passed doors is distributed over several threads for
+ * many pedestrians. The door usage is increased afterwards in the order of \p peds, so the
+ * recorded flow does not depend on the threads.
+ * The threads are started for each call instead of being kept in a pool. Each of them locates at
+ * least a thousand pedestrians, which takes far longer than starting and joining it, and
+ * simulations with fewer pedestrians do not start any.
  * @param building geometry used in the simulation
- * @param peds list of pedestrians to check
- * @return list of pedestrians who have moved to outside of the geometry
+ * @param peds pedestrians to update
+ * @param time elapsed time of the simulation
+ * @param maxThreads upper bound of the threads used, 0 for the number of hardware threads
+ * @return pedestrians who have moved to outside of the geometry and are no longer in the
+ * simulation scope
  */
-std::vector<Pedestrian::UID> FindPedestriansOutside(
-    const Building& building,
-    const std::vector<std::unique_ptr<Pedestrian>>& peds);
-
-/**
- * Increments the door usage of the doors by the peds in \p pedsChangedRoom.
- * @param building geometry used in the simulation
- * @param pedsChangedRoom list of pedestrians who have changed their room
- * @param time elapsed of the simulation
- */
-void UpdateFlowAtDoors(
+std::vector<Pedestrian::UID> UpdateLocations(
     Building& building,
     const std::vector<std::unique_ptr<Pedestrian>>& peds,
-    double time);
+    double time,
+    std::size_t maxThreads = 0);
 
 /**
  * Triggers the flow regulation, and closes/opens doors accordingly
  * @param building geometry used in the simulation
- * @return a change to the geometry was made
+ * @return unique IDs of the doors whose state changed
  */
-bool UpdateFlowRegulation(Building& building, const SimulationClock& clock);
+std::vector<int> UpdateFlowRegulation(Building& building, const SimulationClock& clock);
 
 /**
  * Triggers the flow regulation for trains, and closes/opens doors accordingly
  * @param building geometry used in the simulation
- * @return a change to the geometry was made
+ * @return unique IDs of the train doors which were closed
+ */
+std::vector<int> UpdateTrainFlowRegulation(Building& building, double time);
+
+/**
+ * Finds the next door of a pedestrian. The router is only asked if the last route decision of
+ * \p ped is no longer valid (see Pedestrian::GetRouteDecision) or if it is the turn of \p ped to
+ * re-evaluate its route. The pedestrians take turns by their UID, so each of them re-evaluates
+ * its route every \p period steps and only a fraction of them is routed in each step.
+ * @param router router of the pedestrian
+ * @param ped pedestrian to route
+ * @param iteration current step of the simulation
+ * @param period steps between two re-evaluations of the route, 1 routes in every step
+ * @return UID of the next door, FINAL_DEST_OUT if none was found
  */
-bool UpdateTrainFlowRegulation(Building& building, double time);
+int FindExit(Router& router, Pedestrian& ped, std::uint64_t iteration, int period);
 
 /**
  * Finds the transition that was passed by a pedestrian \p ped in the last time step.
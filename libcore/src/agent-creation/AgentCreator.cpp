@@ -7,38 +7,77 @@
 #include "pedestrian/Pedestrian.hpp"
 
 #include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
 #include <tuple>
 
-std::multimap<size_t, std::unique_ptr<Pedestrian>>
-CreateAllPedestrians(Configuration* configuration, Building* building, double max_time)
+AgentCreator::AgentCreator(
+    Configuration* configuration,
+    Building* building,
+    double max_time,
+    bool on_demand)
+    : _sources(building), _clock(configuration->dT), _maxTime(max_time)
 {
     using AgentVec = std::vector<std::unique_ptr<Pedestrian>>;
     AgentVec agents;
 
     PedDistributor pd(configuration, &agents);
     pd.Distribute(building);
-    std::multimap<size_t, std::unique_ptr<Pedestrian>> result{};
 
     for(auto&& ped : agents) {
-        result.emplace(std::make_pair(0, std::move(ped)));
+        _distributed.emplace(std::make_pair(0, std::move(ped)));
     }
+    _distributedCount = _distributed.size();
+    _created = _distributedCount;
     agents.clear();
 
-    AgentsSourcesManager mgr(building);
     for(const auto& src : pd.GetAgentsSources()) {
-        mgr.AddSource(src);
+        _sources.AddSource(src);
+    }
+    if(!on_demand) {
+        _sources.GenerateAgents();
     }
-    mgr.GenerateAgents();
-    SimulationClock clock(configuration->dT);
+}
+
+std::multimap<size_t, std::unique_ptr<Pedestrian>> AgentCreator::CreateUntil(size_t iteration)
+{
+    std::multimap<size_t, std::unique_ptr<Pedestrian>> result = std::move(_distributed);
+    _distributed.clear();
 
-    do {
-        auto agents = mgr.ProcessAllSources(clock.ElapsedTime());
+    while(!_completed && _clock.Iteration() < iteration) {
+        auto agents = _sources.ProcessAllSources(_clock.ElapsedTime());
+        _created += agents.size();
         for(auto&& ped : agents) {
-            result.emplace(std::make_pair(clock.Iteration(), std::move(ped)));
+            result.emplace(std::make_pair(_clock.Iteration(), std::move(ped)));
         }
-        clock.Advance();
-    } while(!mgr.IsCompleted() && clock.ElapsedTime() < max_time);
+        _clock.Advance();
+        _completed = _sources.IsCompleted() || _clock.ElapsedTime() >= _maxTime;
+    }
     return result;
 }
+
+bool AgentCreator::IsCompleted() const
+{
+    return _completed && _distributed.empty();
+}
+
+size_t AgentCreator::AgentsCreated() const
+{
+    return _created;
+}
+
+size_t AgentCreator::MaxAgentNumber() const
+{
+    if(_completed) {
+        return _created;
+    }
+    return _distributedCount + _sources.GetMaxAgentNumber();
+}
+
+std::multimap<size_t, std::unique_ptr<Pedestrian>>
+CreateAllPedestrians(Configuration* configuration, Building* building, double max_time)
+{
+    AgentCreator creator(configuration, building, max_time);
+    return creator.CreateUntil(std::numeric_limits<size_t>::max());
+}
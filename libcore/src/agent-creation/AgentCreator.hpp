@@ -1,13 +1,75 @@
 #pragma once
 
+#include "SimulationClock.hpp"
 #include "general/Configuration.hpp"
 #include "geometry/Building.hpp"
+#include "pedestrian/AgentsSourcesManager.hpp"
 #include "pedestrian/Pedestrian.hpp"
 
 #include <map>
 #include <memory>
 #include <tuple>
 
+/**
+ * Creates the agents of the start distributions and of the sources iteration by iteration.
+ *
+ * The agents of the start distributions enter at iteration 0. The sources are processed up to
+ * the iteration requested, so a simulation can query the agents of the next iterations only and
+ * keep the agents which did not enter yet out of memory.
+ */
+class AgentCreator
+{
+public:
+    /**
+     * Distributes the agents of the start distributions.
+     * @param configuration configuration with the agent distributions and sources
+     * @param building building the agents are created in
+     * @param max_time no agents are created after \p max_time [s]
+     * @param on_demand if the sources generate their agents when they are needed instead of
+     * generating all agents of the run upfront
+     */
+    AgentCreator(
+        Configuration* configuration,
+        Building* building,
+        double max_time,
+        bool on_demand = false);
+
+    AgentCreator(const AgentCreator&) = delete;
+    AgentCreator& operator=(const AgentCreator&) = delete;
+
+    /**
+     * Creates the agents entering before \p iteration which were not created yet.
+     * @param iteration first iteration whose agents are not created
+     * @return agents by the iteration they enter the simulation
+     */
+    std::multimap<size_t, std::unique_ptr<Pedestrian>> CreateUntil(size_t iteration);
+
+    /// @return if all agents have been created
+    bool IsCompleted() const;
+
+    /// @return number of agents created so far
+    size_t AgentsCreated() const;
+
+    /// @return upper bound of the number of agents created over the whole run
+    size_t MaxAgentNumber() const;
+
+private:
+    std::multimap<size_t, std::unique_ptr<Pedestrian>> _distributed;
+    AgentsSourcesManager _sources;
+    SimulationClock _clock;
+    double _maxTime;
+    bool _completed{false};
+    size_t _distributedCount{0};
+    size_t _created{0};
+};
+
+/**
+ * Creates all agents of the run upfront.
+ * @param configuration configuration with the agent distributions and sources
+ * @param building building the agents are created in
+ * @param max_time no agents are created after \p max_time [s]
+ * @return agents by the iteration they enter the simulation
+ */
 std::multimap<size_t, std::unique_ptr<Pedestrian>>
 CreateAllPedestrians(Configuration* configuration, Building* building, double max_time);
 
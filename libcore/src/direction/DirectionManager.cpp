@@ -34,14 +34,17 @@
 
 #include <memory>
 
-static std::unique_ptr<DirectionStrategy>
-make_direction_strategy(DirectionStrategyType type, const Configuration& config, Building* building)
+static std::unique_ptr<DirectionStrategy> make_direction_strategy(
+    DirectionStrategyType type,
+    const Configuration& config,
+    Building* building,
+    FloorfieldRepository* floorfields)
 {
     switch(type) {
         case DirectionStrategyType::IN_RANGE_BOTTLENECK:
             return std::make_unique<DirectionInRangeBottleneck>();
         case DirectionStrategyType::LOCAL_FLOORFIELD:
-            return std::make_unique<DirectionLocalFloorfield>(config, building);
+            return std::make_unique<DirectionLocalFloorfield>(config, building, floorfields);
         case DirectionStrategyType::MIDDLE_POINT:
             return std::make_unique<DirectionMiddlePoint>();
         case DirectionStrategyType::MIN_SEPERATION_SHORTER_LINE:
@@ -64,10 +67,13 @@ make_waiting_strategy(std::optional<WaitingStrategyType> type)
 }
 
 std::unique_ptr<DirectionManager>
-DirectionManager::Create(const Configuration& config, Building* building)
+DirectionManager::Create(
+    const Configuration& config,
+    Building* building,
+    FloorfieldRepository* floorfields)
 {
     auto directionStrategy =
-        make_direction_strategy(config.directionStrategyType, config, building);
+        make_direction_strategy(config.directionStrategyType, config, building, floorfields);
     auto waitingStrategy = make_waiting_strategy(config.waitingStrategyType);
 
     return std::make_unique<DirectionManager>(
@@ -84,14 +90,35 @@ DirectionManager::DirectionManager(
 {
 }
 
+void DirectionManager::ComputeTargets(const std::vector<std::unique_ptr<Pedestrian>>& agents)
+{
+    _walking.clear();
+    for(const auto& agent : agents) {
+        if(!agent->InPremovement(_currentTime) && !(agent->IsWaiting() && _waitingStrategy)) {
+            _walking.emplace_back(agent.get());
+        }
+    }
+    _directionStrategy->GetTargets(_walking, _walkingTargets);
+
+    // _walking keeps the order of agents
+    std::size_t index = 0;
+    for(const auto& agent : agents) {
+        if(index < _walking.size() && _walking[index] == agent.get()) {
+            agent->SetDirectionTarget(_step, _walkingTargets[index++]);
+        }
+    }
+}
+
 Point DirectionManager::GetTarget(const Pedestrian* ped)
 {
-    const auto* room = _building->GetRoom(ped->GetPos());
+    const auto* room = ped->GetRoom();
     if(ped->IsWaiting() && _waitingStrategy) {
         return _waitingStrategy->GetTarget(room, ped, _currentTime);
-    } else {
-        return _directionStrategy->GetTarget(room, ped);
     }
+    if(auto target = ped->GetDirectionTarget(_step)) {
+        return *target;
+    }
+    return _directionStrategy->GetTarget(room, ped);
 }
 
 WaitingStrategy& DirectionManager::GetWaitingStrategy() const
@@ -27,9 +27,12 @@
 #include "general/Macros.hpp"
 #include "pedestrian/Pedestrian.hpp"
 
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 class Building;
+class FloorfieldRepository;
 
 class DirectionManager
 {
@@ -38,10 +41,16 @@ private:
     std::unique_ptr<WaitingStrategy> _waitingStrategy;
     const Building* _building;
     double _currentTime;
+    /// time step counted by Update(), the targets of ComputeTargets() are stored with it in the
+    /// pedestrians, 0 is never a step
+    std::size_t _step{1};
+    /// buffers of ComputeTargets(), reused in every time step
+    std::vector<const Pedestrian*> _walking;
+    std::vector<Point> _walkingTargets;
 
 public:
     static std::unique_ptr<DirectionManager>
-    Create(const Configuration& config, Building* building);
+    Create(const Configuration& config, Building* building, FloorfieldRepository* floorfields);
 
     DirectionManager(
         std::unique_ptr<DirectionStrategy> directionStrategy,
@@ -49,7 +58,18 @@ public:
         const Building* building);
     ~DirectionManager() = default;
 
-    void Update(double time) { _currentTime = time; };
+    void Update(double time)
+    {
+        _currentTime = time;
+        ++_step;
+    };
+
+    /**
+     * Computes the desired directions of all walking pedestrians (not waiting, premovement time
+     * over) in one batch. Until the next Update(), GetTarget() returns these targets.
+     * @param agents all pedestrians of the simulation
+     */
+    void ComputeTargets(const std::vector<std::unique_ptr<Pedestrian>>& agents);
 
     /**
      * Get the desired direction of the pedestrians at the current time step.
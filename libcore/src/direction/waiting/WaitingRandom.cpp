@@ -35,7 +35,7 @@ double fRand(double fMin, double fMax)
     return fMin + f * (fMax - fMin);
 }
 
-Point WaitingRandom::GetWaitingPosition(const Room* room, const Pedestrian* ped, double time)
+Point WaitingRandom::GetWaitingPosition(const Room* /*room*/, const Pedestrian* ped, double time)
 {
     // Polygon of either subroom or waiting area
     std::vector<Point> polygon;
@@ -44,7 +44,7 @@ Point WaitingRandom::GetWaitingPosition(const Room* room, const Pedestrian* ped,
     if(ped->IsInsideWaitingAreaWaiting(time)) {
         polygon = ped->GetBuilding()->GetFinalGoal(ped->GetLastGoalID())->GetPolygon();
     } else {
-        SubRoom* subRoom = room->GetSubRoom(ped->GetPos());
+        SubRoom* subRoom = ped->GetSubRoom();
         polygon = subRoom->GetPolygon();
     }
 
@@ -72,7 +72,7 @@ Point WaitingRandom::GetWaitingPosition(const Room* room, const Pedestrian* ped,
         } while(!goal->IsInsideGoal(target));
 
     } else {
-        SubRoom* subRoom = room->GetSubRoom(ped->GetPos());
+        SubRoom* subRoom = ped->GetSubRoom();
 
         do {
             target.x = fRand(xMin, xMax);
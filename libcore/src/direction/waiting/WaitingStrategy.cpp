@@ -40,7 +40,7 @@ Point WaitingStrategy::GetTarget(const Room* room, const Pedestrian* ped, double
     // check if waiting pos is set
     if(waitingPos.x == std::numeric_limits<double>::max() &&
        waitingPos.y == std::numeric_limits<double>::max()) {
-        SubRoom* subroom = ped->GetBuilding()->GetSubRoom(ped->GetPos());
+        SubRoom* subroom = ped->GetSubRoom();
         do {
             target = GetWaitingPosition(room, ped, time);
         } while(!subroom->IsInSubRoom(target));
@@ -36,7 +36,19 @@
 #include "routing/ff_router/UnivFFviaFM.hpp"
 
 #include <Logger.hpp>
+#include <algorithm>
 #include <chrono>
+#include <numeric>
+
+void DirectionStrategy::GetTargets(
+    const std::vector<const Pedestrian*>& peds,
+    std::vector<Point>& targets) const
+{
+    targets.resize(peds.size());
+    for(std::size_t index = 0; index < peds.size(); ++index) {
+        targets[index] = GetTarget(peds[index]->GetRoom(), peds[index]);
+    }
+}
 
 /// 1
 Point DirectionMiddlePoint::GetTarget(const Room* /*room*/, const Pedestrian* ped) const
@@ -98,48 +110,104 @@ Point DirectionLocalFloorfield::GetTarget(const Room* room, const Pedestrian* pe
     return (p + ped->GetPos());
 }
 
+void DirectionLocalFloorfield::GetTargets(
+    const std::vector<const Pedestrian*>& peds,
+    std::vector<Point>& targets) const
+{
+    targets.resize(peds.size());
+    _batchOrder.resize(peds.size());
+    std::iota(_batchOrder.begin(), _batchOrder.end(), 0);
+    std::sort(_batchOrder.begin(), _batchOrder.end(), [&peds](std::size_t a, std::size_t b) {
+        const int roomA = peds[a]->GetRoom()->GetID();
+        const int roomB = peds[b]->GetRoom()->GetID();
+        return roomA != roomB ? roomA < roomB :
+                                peds[a]->GetDestination() < peds[b]->GetDestination();
+    });
+
+    auto begin = _batchOrder.begin();
+    while(begin != _batchOrder.end()) {
+        const int roomID = peds[*begin]->GetRoom()->GetID();
+        const auto end = std::find_if(begin, _batchOrder.end(), [&peds, roomID](std::size_t i) {
+            return peds[i]->GetRoom()->GetID() != roomID;
+        });
+
+        _batchPositions.clear();
+        _batchDestIDs.clear();
+        for(auto iter = begin; iter != end; ++iter) {
+            _batchPositions.emplace_back(peds[*iter]->GetPos());
+            _batchDestIDs.emplace_back(peds[*iter]->GetDestination());
+        }
+        _locffviafm.at(roomID)->GetDirectionsToUIDs(
+            _batchPositions, _batchDestIDs, _batchDirections);
+        for(auto iter = begin; iter != end; ++iter) {
+            const auto index = static_cast<std::size_t>(iter - begin);
+            targets[*iter] = _batchDirections[index] + _batchPositions[index];
+        }
+        begin = end;
+    }
+}
+
 Point DirectionLocalFloorfield::GetDir2Wall(const Pedestrian* ped) const
 {
     Point p;
-    auto [roomID, _1, _2] = _building->GetRoomAndSubRoomIDs(ped->GetPos());
+    const int roomID = ped->GetSubRoom()->GetRoomID();
     _locffviafm.at(roomID)->GetDir2WallAt(ped->GetPos(), p);
     return p;
 }
 
 double DirectionLocalFloorfield::GetDistance2Wall(const Pedestrian* ped) const
 {
-    auto [roomID, _1, _2] = _building->GetRoomAndSubRoomIDs(ped->GetPos());
+    const int roomID = ped->GetSubRoom()->GetRoomID();
     return _locffviafm.at(roomID)->GetDistance2WallAt(ped->GetPos());
 }
 
 double DirectionLocalFloorfield::GetDistance2Target(const Pedestrian* ped, int UID) const
 {
-    auto [roomID, _1, _2] = _building->GetRoomAndSubRoomIDs(ped->GetPos());
+    const int roomID = ped->GetSubRoom()->GetRoomID();
     return _locffviafm.at(roomID)->GetCostToDestination(UID, ped->GetPos());
 }
 
 void DirectionLocalFloorfield::ReInit()
 {
     for(auto& roomPair : _building->GetAllRooms()) {
-        auto newfield = std::make_unique<UnivFFviaFM>(
-            roomPair.second.get(), _stepsize, _wallAvoidDistance, _useDistancefield);
-        newfield->SetUser(DISTANCE_AND_DIRECTIONS_USED);
-        newfield->SetMode(LINESEGMENT);
-        if(_useDistancefield) {
-            newfield->SetSpeedMode(FF_WALL_AVOID);
-        } else {
-            newfield->SetSpeedMode(FF_HOMO_SPEED);
-        }
-        newfield->AddAllTargetsParallel();
-        _locffviafm[roomPair.first] = std::move(newfield);
+        ReInitRoom(roomPair.second.get());
     }
 };
 
-DirectionLocalFloorfield::DirectionLocalFloorfield(const Configuration& config, Building* building)
+void DirectionLocalFloorfield::ReInit(const std::set<int>& roomIDs)
+{
+    for(int roomID : roomIDs) {
+        if(auto* room = _building->GetRoom(roomID); room != nullptr) {
+            ReInitRoom(room);
+        }
+    }
+}
+
+void DirectionLocalFloorfield::ReInitRoom(Room* room)
+{
+    FloorfieldParameters parameters;
+    parameters.hx = _stepsize;
+    parameters.wallAvoidDistance = _wallAvoidDistance;
+    parameters.useWallDistances = _useDistancefield;
+    parameters.user = DISTANCE_AND_DIRECTIONS_USED;
+    parameters.mode = LINESEGMENT;
+    parameters.speedMode = _useDistancefield ? FF_WALL_AVOID : FF_HOMO_SPEED;
+    parameters.lazy = _lazy;
+    parameters.memoryBudget = _memoryBudget;
+    _locffviafm[room->GetID()] = _floorfields->Get(room, parameters);
+}
+
+DirectionLocalFloorfield::DirectionLocalFloorfield(
+    const Configuration& config,
+    Building* building,
+    FloorfieldRepository* floorfields)
     : _building(building)
+    , _floorfields(floorfields)
     , _stepsize(config.deltaH)
     , _wallAvoidDistance(config.wallAvoidDistance)
     , _useDistancefield(config.useWallAvoidance)
+    , _lazy(config.useLazyFloorfields)
+    , _memoryBudget(static_cast<std::size_t>(config.floorfieldRoomMemoryBudget * 1024 * 1024))
 {
     ReInit();
 }
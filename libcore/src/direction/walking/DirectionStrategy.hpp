@@ -24,9 +24,11 @@
 
 #include "geometry/Building.hpp"
 #include "geometry/Point.hpp"
+#include "routing/ff_router/FloorfieldRepository.hpp"
 #include "routing/ff_router/UnivFFviaFM.hpp"
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -56,6 +58,13 @@ public:
 
     virtual void ReInit(){};
 
+    /**
+     * Reinitializes the strategy after the geometry of some rooms changed.
+     * Strategies without room-local state perform a full ReInit().
+     * @param roomIDs IDs of the rooms whose geometry changed
+     */
+    virtual void ReInit(const std::set<int>& /*roomIDs*/) { ReInit(); };
+
     /**
      * Getter for the goal at the current time-step.
      * @param room Room \p ped is in
@@ -64,6 +73,15 @@ public:
      */
     virtual Point GetTarget(const Room* room, const Pedestrian* ped) const = 0;
 
+    /**
+     * Getter for the goals of several pedestrians at the current time-step.
+     * The default calls GetTarget() for each pedestrian.
+     * @param peds Pedestrians whose goals are determined
+     * @param[out] targets Goal of each pedestrian in \p peds
+     */
+    virtual void
+    GetTargets(const std::vector<const Pedestrian*>& peds, std::vector<Point>& targets) const;
+
     /**
      * Returns the distance to the wall of a pedestrian.
      * Only used by GradientModel.
@@ -132,19 +150,45 @@ public:
 class DirectionLocalFloorfield : public DirectionStrategy
 {
 public:
-    DirectionLocalFloorfield(const Configuration& config, Building* building);
+    DirectionLocalFloorfield(
+        const Configuration& config,
+        Building* building,
+        FloorfieldRepository* floorfields);
     ~DirectionLocalFloorfield() override = default;
 
     void ReInit() override;
+    void ReInit(const std::set<int>& roomIDs) override;
     Point GetTarget(const Room* room, const Pedestrian* ped) const override;
+
+    /**
+     * Looks up the directions of all pedestrians of a room in one batch, interpolated bilinearly
+     * between the grid points of the floor field (see UnivFFviaFM::GetDirectionsToUIDs()).
+     * Not thread-safe, the buffers of the batches are reused between calls.
+     */
+    void GetTargets(const std::vector<const Pedestrian*>& peds, std::vector<Point>& targets)
+        const override;
     Point GetDir2Wall(const Pedestrian* ped) const override;
     double GetDistance2Wall(const Pedestrian* ped) const override;
     double GetDistance2Target(const Pedestrian* ped, int UID) const override;
 
 private:
-    std::map<int, std::unique_ptr<UnivFFviaFM>> _locffviafm;
+    /**
+     * Recomputes the floor field of a single room.
+     * @param room room whose floor field is rebuilt
+     */
+    void ReInitRoom(Room* room);
+
+    std::map<int, std::shared_ptr<UnivFFviaFM>> _locffviafm;
+    /// buffers of GetTargets(), indices of the pedestrians sorted by room and door
+    mutable std::vector<std::size_t> _batchOrder;
+    mutable std::vector<Point> _batchPositions;
+    mutable std::vector<int> _batchDestIDs;
+    mutable std::vector<Point> _batchDirections;
     Building* _building;
+    FloorfieldRepository* _floorfields;
     double _stepsize;
     double _wallAvoidDistance;
     bool _useDistancefield;
+    bool _lazy;
+    std::size_t _memoryBudget;
 };
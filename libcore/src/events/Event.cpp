@@ -27,10 +27,7 @@ CreatePedestrianEvent::CreatePedestrianEvent(
     , _v0_down_stairs{agent->GetV0DownStairsNorm()}
     , _v0_escalator_up{agent->GetV0EscalatorUpNorm()}
     , _v0_escalator_down{agent->GetV0EscalatorDownNorm()}
-    , _smooth_factor_up_stairs{agent->GetSmoothFactorUpStairs()}
-    , _smooth_factor_down_stairs{agent->GetSmoothFactorDownStairs()}
-    , _smooth_factor_escalator_up{agent->GetSmoothFactorUpEscalators()}
-    , _smooth_factor_escalator_down{agent->GetSmoothFactorDownEscalators()}
+    , _profile{agent->GetProfile()}
 {
 }
 
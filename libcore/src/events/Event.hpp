@@ -3,6 +3,7 @@
 #include "Enum.hpp"
 #include "geometry/Point.hpp"
 #include "geometry/TrainGeometryInterface.hpp"
+#include "pedestrian/PedestrianProfile.hpp"
 
 #include <chrono>
 #include <fmt/format.h>
@@ -40,10 +41,7 @@ public:
     double _v0_escalator_up;
     double _v0_escalator_down;
 
-    double _smooth_factor_up_stairs;
-    double _smooth_factor_down_stairs;
-    double _smooth_factor_escalator_up;
-    double _smooth_factor_escalator_down;
+    std::shared_ptr<const PedestrianProfile> _profile;
 
     CreatePedestrianEvent(Pedestrian const* agent, std::chrono::nanoseconds min_time);
 };
@@ -2,23 +2,117 @@
 
 #include "events/EventVisitors.hpp"
 
-IteratorPair<EventManager::ConstEventIteratorType> EventManager::NextEvents(SimulationClock _clock)
+#include <Logger.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace
 {
-    auto ub = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::duration<double>(_clock.ElapsedTime()));
-    auto lb_exclusive = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::duration<double>(_clock.ElapsedTime() - _clock.dT()));
+/// average number of entries per bucket before the number of buckets is doubled
+constexpr std::size_t MAX_BUCKET_LOAD = 4;
+constexpr std::size_t INITIAL_BUCKETS = 256;
+} // namespace
 
-    return {_events.upper_bound(lb_exclusive), _events.upper_bound(ub)};
+EventManager::EventManager(double dT) : _dT(dT), _buckets(INITIAL_BUCKETS)
+{
 }
 
 void EventManager::AddEvent(const Event& event)
 {
-    _events.insert({EventMinTime(event), event});
+    const auto time = EventMinTime(event);
+    const std::uint64_t iteration = IterationAt(time);
+    if(iteration < _nextIteration) {
+        LOG_WARNING(
+            "Event at {:.2f}s is before the current time of the simulation and is dropped",
+            std::chrono::duration<double>(time).count());
+        return;
+    }
+
+    Entry entry{iteration, time, _sequence++, EventType::CREATE_PEDESTRIAN, 0};
+    if(const auto* create = std::get_if<CreatePedestrianEvent>(&event)) {
+        entry.index = _createPedestrianEvents.Add(*create);
+    } else if(const auto* door = std::get_if<DoorEvent>(&event)) {
+        entry.type = EventType::DOOR;
+        entry.index = _doorEvents.Add(*door);
+    } else {
+        entry.type = EventType::TRAIN;
+        entry.index = _trainEvents.Add(std::get<TrainEvent>(event));
+    }
+    Insert(entry);
+}
+
+bool EventManager::HasEvents() const
+{
+    return _size > 0;
+}
+
+std::size_t EventManager::Size() const
+{
+    return _size;
+}
+
+std::chrono::nanoseconds EventManager::TimeOf(std::int64_t iteration) const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(_dT * iteration));
+}
+
+std::uint64_t EventManager::IterationAt(std::chrono::nanoseconds time) const
+{
+    // the estimate is corrected, so events match the time the clock reports exactly
+    auto iteration = static_cast<std::int64_t>(
+        std::floor(std::chrono::duration<double>(time).count() / _dT));
+    iteration = std::max<std::int64_t>(iteration, 0);
+    while(TimeOf(iteration) < time) {
+        ++iteration;
+    }
+    while(iteration > 0 && TimeOf(iteration - 1) >= time) {
+        --iteration;
+    }
+    return static_cast<std::uint64_t>(iteration);
+}
+
+void EventManager::Insert(const Entry& entry)
+{
+    if(_size >= MAX_BUCKET_LOAD * _buckets.size()) {
+        Grow();
+    }
+    _buckets[entry.iteration & (_buckets.size() - 1)].push_back(entry);
+    ++_size;
+}
+
+void EventManager::Grow()
+{
+    std::vector<std::vector<Entry>> buckets(2 * _buckets.size());
+    for(const auto& bucket : _buckets) {
+        for(const Entry& entry : bucket) {
+            buckets[entry.iteration & (buckets.size() - 1)].push_back(entry);
+        }
+    }
+    _buckets = std::move(buckets);
 }
 
-bool EventManager::HasEventsAfter(const SimulationClock& clock)
+void EventManager::CollectDueEvents(std::uint64_t iteration)
 {
-    return _events.lower_bound(std::chrono::duration_cast<std::chrono::nanoseconds>(
-               std::chrono::duration<double>(clock.ElapsedTime() - clock.dT()))) != _events.end();
+    for(; _nextIteration <= iteration; ++_nextIteration) {
+        if(_size == 0) {
+            _nextIteration = iteration + 1;
+            break;
+        }
+        // the bucket also holds entries of later rounds through the calendar
+        auto& bucket = _buckets[_nextIteration & (_buckets.size() - 1)];
+        for(std::size_t i = 0; i < bucket.size();) {
+            if(bucket[i].iteration != _nextIteration) {
+                ++i;
+                continue;
+            }
+            _due.push_back(bucket[i]);
+            bucket[i] = bucket.back();
+            bucket.pop_back();
+            --_size;
+        }
+    }
+    std::sort(_due.begin(), _due.end(), [](const Entry& a, const Entry& b) {
+        return a.time < b.time || (a.time == b.time && a.sequence < b.sequence);
+    });
 }
@@ -1,21 +1,133 @@
 #pragma once
 
 #include "Event.hpp"
-#include "IteratorPair.hpp"
 #include "SimulationClock.hpp"
 
 #include <chrono>
-#include <map>
+#include <cstdint>
+#include <vector>
 
+/**
+ * \class EventManager
+ *
+ * \brief Calendar queue of the events, indexed by the iteration they are processed at.
+ *
+ * An event is processed at the first iteration whose time is not before the time of the event.
+ * Events are stored by type in arrays whose slots are reused, the buckets of the calendar only
+ * hold small entries. Adding an event and processing the events of an iteration take constant
+ * time on average, the number of buckets grows with the number of pending events.
+ */
 class EventManager
 {
 public:
-    using EventsContainerType = std::multimap<std::chrono::nanoseconds, Event>;
-    using ConstEventIteratorType = EventsContainerType::const_iterator;
-    IteratorPair<ConstEventIteratorType> NextEvents(SimulationClock _clock);
+    /**
+     * @param dT time step [s] of the simulation
+     */
+    explicit EventManager(double dT);
+
+    /**
+     * Adds \p event, events before the last processed iteration are dropped.
+     * @param event event to add
+     */
     void AddEvent(const Event& event);
-    bool HasEventsAfter(const SimulationClock& clock);
+
+    /**
+     * Processes and removes the events due up to the current iteration of \p clock, ordered by
+     * their time and, at equal times, by the order they were added in. \p visitor must not add
+     * events.
+     * @param clock clock of the simulation
+     * @param visitor callable for each event type
+     */
+    template <typename Visitor>
+    void ProcessNextEvents(const SimulationClock& clock, Visitor&& visitor);
+
+    /// @return if events are left to be processed
+    bool HasEvents() const;
+
+    /// @return number of events left to be processed
+    std::size_t Size() const;
 
 private:
-    EventsContainerType _events;
+    enum class EventType : std::uint8_t { CREATE_PEDESTRIAN, DOOR, TRAIN };
+
+    struct Entry {
+        std::uint64_t iteration;
+        std::chrono::nanoseconds time;
+        /// order the events were added in
+        std::uint64_t sequence;
+        EventType type;
+        std::uint32_t index;
+    };
+
+    /// Events of one type, slots of processed events are reused.
+    template <typename T>
+    struct Slots {
+        std::vector<T> values;
+        std::vector<std::uint32_t> free;
+
+        std::uint32_t Add(const T& value);
+        void Remove(std::uint32_t index) { free.push_back(index); }
+    };
+
+    /// @return first iteration whose time is not before \p time
+    std::uint64_t IterationAt(std::chrono::nanoseconds time) const;
+
+    /// @return time of \p iteration, as the clock converts it
+    std::chrono::nanoseconds TimeOf(std::int64_t iteration) const;
+
+    void Insert(const Entry& entry);
+
+    /// Moves the entries due up to \p iteration into _due, sorted by time and sequence.
+    void CollectDueEvents(std::uint64_t iteration);
+
+    /// Doubles the number of buckets.
+    void Grow();
+
+    double _dT;
+    Slots<CreatePedestrianEvent> _createPedestrianEvents;
+    Slots<DoorEvent> _doorEvents;
+    Slots<TrainEvent> _trainEvents;
+    /// bucket iteration & (size - 1) holds the entries of iteration
+    std::vector<std::vector<Entry>> _buckets;
+    std::vector<Entry> _due;
+    std::size_t _size{0};
+    std::uint64_t _sequence{0};
+    /// first iteration which was not processed yet
+    std::uint64_t _nextIteration{0};
 };
+
+template <typename T>
+std::uint32_t EventManager::Slots<T>::Add(const T& value)
+{
+    if(free.empty()) {
+        values.push_back(value);
+        return static_cast<std::uint32_t>(values.size() - 1);
+    }
+    const std::uint32_t index = free.back();
+    free.pop_back();
+    values[index] = value;
+    return index;
+}
+
+template <typename Visitor>
+void EventManager::ProcessNextEvents(const SimulationClock& clock, Visitor&& visitor)
+{
+    CollectDueEvents(clock.Iteration());
+    for(const Entry& entry : _due) {
+        switch(entry.type) {
+            case EventType::CREATE_PEDESTRIAN:
+                visitor(_createPedestrianEvents.values[entry.index]);
+                _createPedestrianEvents.Remove(entry.index);
+                break;
+            case EventType::DOOR:
+                visitor(_doorEvents.values[entry.index]);
+                _doorEvents.Remove(entry.index);
+                break;
+            case EventType::TRAIN:
+                visitor(_trainEvents.values[entry.index]);
+                _trainEvents.Remove(entry.index);
+                break;
+        }
+    }
+    _due.clear();
+}
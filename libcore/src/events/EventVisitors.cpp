@@ -36,10 +36,7 @@ void ProcessEvent(const CreatePedestrianEvent& event, Simulation& sim)
         event._v0_down_stairs,
         event._v0_escalator_up,
         event._v0_escalator_down);
-    ped->SetSmoothFactorEscalatorUpStairs(event._smooth_factor_escalator_up);
-    ped->SetSmoothFactorEscalatorDownStairs(event._smooth_factor_escalator_down);
-    ped->SetSmoothFactorUpStairs(event._smooth_factor_up_stairs);
-    ped->SetSmoothFactorDownStairs(event._smooth_factor_down_stairs);
+    ped->SetProfile(event._profile);
     ped->SetPos(event._position);
     ped->SetRouterId(event._router_id);
 
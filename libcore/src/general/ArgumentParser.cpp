@@ -42,6 +42,16 @@ bool ArgumentParser::PrintVersionAndExit() const
     return printVersionAndExit;
 }
 
+bool ArgumentParser::EstimateEvacuation() const
+{
+    return estimateEvacuation;
+}
+
+bool ArgumentParser::StreamAgents() const
+{
+    return streamAgents;
+}
+
 std::tuple<ArgumentParser::Execution, int> ArgumentParser::Parse(int argc, char* argv[])
 {
     // Silence warnigns about unused member. Opts are keept as class members
@@ -50,6 +60,8 @@ std::tuple<ArgumentParser::Execution, int> ArgumentParser::Parse(int argc, char*
     (void) iniFilePathOpt;
     (void) logLevelOpt;
     (void) versionFlag;
+    (void) estimateFlag;
+    (void) streamFlag;
     try {
         app.parse(argc, argv);
     } catch(const CLI::ParseError& e) {
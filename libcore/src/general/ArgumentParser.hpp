@@ -45,6 +45,8 @@ private:
     fs::path iniFilePath{"ini.xml"};
     Logging::Level logLevel{Logging::Level::Info};
     bool printVersionAndExit{false};
+    bool estimateEvacuation{false};
+    bool streamAgents{false};
 
     CLI::App app{"JuPedSim"};
     CLI::Option* iniFilePathOpt =
@@ -58,6 +60,16 @@ private:
             ->transform(CLI::CheckedTransformer(logLevelMapping, CLI::ignore_case));
     CLI::Option* versionFlag =
         app.add_flag("--version", printVersionAndExit, "Prints version information and exits.");
+    CLI::Option* estimateFlag = app.add_flag(
+        "--estimate-evacuation",
+        estimateEvacuation,
+        "Estimates the evacuation time with a network flow model instead of simulating the "
+        "agents.");
+    CLI::Option* streamFlag = app.add_flag(
+        "--stream-agents",
+        streamAgents,
+        "Creates the agents of sources during the simulation instead of before it. Memory then "
+        "grows with the agents in the simulation instead of all agents of the run.");
 
 public:
     enum class Execution { CONTINUE, ABORT };
@@ -71,6 +83,12 @@ public:
     /// @return if version info shall be printed and then exited.
     bool PrintVersionAndExit() const;
 
+    /// @return if the evacuation shall be estimated instead of simulated.
+    bool EstimateEvacuation() const;
+
+    /// @return if the agents shall be created during the simulation.
+    bool StreamAgents() const;
+
     /// Parses command line arguments
     /// Parsing ends in one of three states:
     ///     1) Everything parsed, all ok -> returns [CONTINUE, 0]
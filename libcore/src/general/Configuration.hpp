@@ -60,6 +60,21 @@ struct Configuration {
     double deltaH{0.0625};
     double wallAvoidDistance{0.4};
     bool useWallAvoidance{true};
+    bool useLazyFloorfields{false};
+    /// memory budget in MB for the door floor fields of each lazy floor field of a room, 0 means
+    /// unlimited
+    double floorfieldRoomMemoryBudget{0};
+    /// interval in s of recomputing the ff router distances weighted by the agent density,
+    /// 0 disables it
+    double ffQuickestInterval{0};
+    /// recompute the density weighted distances in a background thread
+    bool ffQuickestAsync{false};
+    /// steps after which a background result is applied (waiting for it if necessary),
+    /// 0 applies it at the first step it is ready
+    int ffQuickestApplyAfterSteps{0};
+    /// steps between two route decisions of an agent, decisions of different agents are
+    /// staggered; agents entering a new subroom decide immediately
+    int routeReevaluationPeriod{1};
     bool hasDirectionalEscalators{false};
     std::optional<WaitingStrategyType> waitingStrategyType{};
     DirectionStrategyType directionStrategyType{DirectionStrategyType::MIN_SEPERATION_SHORTER_LINE};
@@ -149,17 +149,12 @@ Room* Building::GetRoom(int index) const
 
 std::tuple<Room*, SubRoom*> Building::GetRoomAndSubRoom(const Point position) const
 {
-    for(auto const& [_, room] : _rooms) {
-        auto it = std::find_if(
-            room->GetAllSubRooms().begin(),
-            room->GetAllSubRooms().end(),
-            [position](const auto& val) { return val.second->IsInSubRoom(position); });
-        if(it != room->GetAllSubRooms().end()) {
-            return {room.get(), it->second.get()};
-        }
+    auto located = _subroomLocator.Locate(position);
+    if(std::get<1>(located) == nullptr) {
+        throw std::runtime_error(fmt::format(
+            FMT_STRING("Position {} could not be found in any subroom."), position.toString()));
     }
-    throw std::runtime_error(fmt::format(
-        FMT_STRING("Position {} could not be found in any subroom."), position.toString()));
+    return located;
 }
 
 Room* Building::GetRoom(const Point position) const
@@ -179,16 +174,35 @@ std::tuple<int, int, int> Building::GetRoomAndSubRoomIDs(const Point position) c
 
 bool Building::IsInAnySubRoom(const Point pos) const
 {
-    for(auto const& [_, room] : _rooms) {
-        auto it = std::find_if(
-            room->GetAllSubRooms().begin(), room->GetAllSubRooms().end(), [pos](const auto& val) {
-                return val.second->IsInSubRoom(pos);
-            });
-        if(it != room->GetAllSubRooms().end()) {
-            return true;
+    return std::get<1>(_subroomLocator.Locate(pos)) != nullptr;
+}
+
+std::tuple<Room*, SubRoom*>
+Building::LocateSubRoom(const Point& position, SubRoom* previous) const
+{
+    // a position on a door belongs to both subrooms, it is resolved like a lookup without
+    // history to keep the result independent of where the agent came from
+    const auto onDoor = [&position](const SubRoom* subroom) {
+        const auto& crossings = subroom->GetAllCrossings();
+        const auto& transitions = subroom->GetAllTransitions();
+        const auto contains = [&position](const Crossing* door) {
+            return door->IsInLineSegment(position);
+        };
+        return std::any_of(crossings.begin(), crossings.end(), contains) ||
+               std::any_of(transitions.begin(), transitions.end(), contains);
+    };
+
+    if(previous != nullptr && !onDoor(previous)) {
+        if(previous->IsInSubRoom(position)) {
+            return {GetRoom(previous->GetRoomID()), previous};
+        }
+        for(auto* neighbor : previous->GetNeighbors()) {
+            if(!onDoor(neighbor) && neighbor->IsInSubRoom(position)) {
+                return {GetRoom(neighbor->GetRoomID()), neighbor};
+            }
         }
     }
-    return false;
+    return _subroomLocator.Locate(position);
 }
 
 void Building::AddRoom(Room* room)
@@ -430,6 +444,8 @@ bool Building::AddCrossing(Crossing* line)
         LOG_ERROR("Duplicate index for crossing found [{}] in Routing::AddCrossing()", IDCrossing);
         exit(EXIT_FAILURE);
     }
+    // passages are only written with the statistics, otherwise counting them suffices
+    line->GetFlowRecorder().SetKeepRecords(_configuration && _configuration->showStatistics);
     _crossings[IDCrossing] = line;
     return true;
 }
@@ -437,6 +453,7 @@ bool Building::AddCrossing(Crossing* line)
 bool Building::RemoveTransition(const Transition* line)
 {
     if(_transitions.count(line->GetID()) != 0) {
+        _transitionsByUID.erase(_transitions.at(line->GetID())->GetUniqueID());
         _transitions.erase(line->GetID());
         return true;
     }
@@ -450,7 +467,9 @@ bool Building::AddTransition(Transition* line)
             "Duplicate index for transition found [{}] in Routing::AddTransition()", line->GetID());
         exit(EXIT_FAILURE);
     }
+    line->GetFlowRecorder().SetKeepRecords(_configuration && _configuration->showStatistics);
     _transitions[line->GetID()] = line;
+    _transitionsByUID[line->GetUniqueID()] = line;
 
     return true;
 }
@@ -686,66 +705,13 @@ bool Building::SanityCheck()
 
 void Building::InitGrid()
 {
-    // first look for the geometry boundaries
-    double x_min = FLT_MAX;
-    double x_max = FLT_MIN;
-    double y_min = FLT_MAX;
-    double y_max = FLT_MIN;
-
-    // finding the bounding of the grid
-    //  and collect the pedestrians
-    for(auto&& itr_room : _rooms) {
-        for(auto&& itr_subroom : itr_room.second->GetAllSubRooms()) {
-            for(auto&& wall : itr_subroom.second->GetAllWalls()) {
-                double x1 = wall.GetPoint1().x;
-                double y1 = wall.GetPoint1().y;
-                double x2 = wall.GetPoint2().x;
-                double y2 = wall.GetPoint2().y;
-
-                double xmax = (x1 > x2) ? x1 : x2;
-                double xmin = (x1 > x2) ? x2 : x1;
-                double ymax = (y1 > y2) ? y1 : y2;
-                double ymin = (y1 > y2) ? y2 : y1;
-
-                x_min = (xmin <= x_min) ? xmin : x_min;
-                x_max = (xmax >= x_max) ? xmax : x_max;
-                y_max = (ymax >= y_max) ? ymax : y_max;
-                y_min = (ymin <= y_min) ? ymin : y_min;
-            }
-        }
-    }
-
-    double cellSize = _configuration->linkedCellSize;
-    // make the grid slightly larger.
-    x_min = x_min - 1 * cellSize;
-    x_max = x_max + 1 * cellSize;
-    y_min = y_min - 1 * cellSize;
-    y_max = y_max + 1 * cellSize;
-
-    // no algorithms
-    //  the domain is made of a single cell
-    if(cellSize == -1) {
-        LOG_INFO("Brute Force will be used for neighborhoods query");
-        if((x_max - x_min) < (y_max - y_min)) {
-            cellSize = (y_max - y_min);
-        } else {
-            cellSize = (x_max - x_min);
-        }
-
-    } else {
-        LOG_INFO("Initializing the grid with cell size: {}.", cellSize);
-    }
-
-    LOG_INFO("Done with Initializing the grid");
+    _subroomLocator.Build(_rooms);
 }
 
 Transition* Building::GetTransitionByUID(int uid) const
 {
-    for(auto&& trans : _transitions) {
-        if(trans.second->GetUniqueID() == uid)
-            return trans.second;
-    }
-    return nullptr;
+    auto iter = _transitionsByUID.find(uid);
+    return iter == _transitionsByUID.end() ? nullptr : iter->second;
 }
 
 Crossing* Building::GetCrossingByUID(int uid) const
@@ -762,7 +728,7 @@ void Building::AddTrainType(int trainID, TrainType type)
     _trains.emplace(trainID, type);
 }
 
-std::map<int, TrainType> Building::GetTrains() const
+const std::map<int, TrainType>& Building::GetTrains() const
 {
     return _trains;
 }
@@ -821,31 +787,36 @@ std::optional<std::vector<Wall>> Building::GetTrainWallsRemoved(int trainID)
     return std::nullopt;
 }
 
-void Building::AddTrainDoorAdded(int trainID, Transition trainAddedDoor)
+void Building::AddTrainDoorAdded(int trainID, Transition* trainAddedDoor)
 {
-    auto iter = _trainDoorsAdded.find(trainID);
-
-    if(iter != _trainDoorsAdded.end()) {
-        iter->second.emplace_back(trainAddedDoor);
-    } else {
-        _trainDoorsAdded.emplace(trainID, std::vector<Transition>{trainAddedDoor});
-    }
+    auto& trainDoors = _trainDoorUsage[trainID];
+    trainDoors._doors.push_back(trainAddedDoor);
+    trainDoors._usage += trainAddedDoor->GetDoorUsage();
+    _trainOfDoor[trainAddedDoor->GetUniqueID()] = trainID;
 }
 
 void Building::ClearTrainDoorsAdded(int trainID)
 {
-    _trainDoorsAdded.erase(trainID);
+    auto iter = _trainDoorUsage.find(trainID);
+    if(iter != _trainDoorUsage.end()) {
+        for(const Transition* door : iter->second._doors) {
+            _trainOfDoor.erase(door->GetUniqueID());
+        }
+        _trainDoorUsage.erase(iter);
+    }
 }
 
-std::optional<std::vector<Transition>> Building::GetTrainDoorsAdded(int trainID)
+void Building::IncreaseTrainDoorUsage(int doorUID, int number)
 {
-    auto iter = _trainDoorsAdded.find(trainID);
-
-    if(iter != _trainDoorsAdded.end()) {
-        return iter->second;
+    auto iter = _trainOfDoor.find(doorUID);
+    if(iter != _trainOfDoor.end()) {
+        _trainDoorUsage[iter->second]._usage += number;
     }
+}
 
-    return std::nullopt;
+const std::map<int, TrainDoorUsage>& Building::GetTrainDoorUsage() const
+{
+    return _trainDoorUsage;
 }
 
 void Building::AddTrackWall(int trackID, int roomID, int subRoomID, Wall trackWall)
@@ -32,6 +32,7 @@
 #include "NavLineParameters.hpp"
 #include "Obstacle.hpp"
 #include "Room.hpp"
+#include "SubRoomLocator.hpp"
 #include "TrainGeometryInterface.hpp"
 #include "Transition.hpp"
 #include "Wall.hpp"
@@ -39,6 +40,7 @@
 #include "neighborhood/NeighborhoodSearch.hpp"
 
 #include <optional>
+#include <unordered_map>
 
 using PointWall = std::pair<Point, Wall>;
 
@@ -55,10 +57,15 @@ private:
     std::map<int, std::shared_ptr<Room>> _rooms;
     std::map<int, Crossing*> _crossings;
     std::map<int, Transition*> _transitions;
+    /// transitions by their unique ID
+    std::unordered_map<int, Transition*> _transitionsByUID;
     std::map<int, Hline*> _hLines;
     std::map<int, Goal*> _goals;
     std::map<int, TrainType> _trains;
 
+    /// point location index used to find the subroom of a position
+    SubRoomLocator _subroomLocator;
+
     std::map<int, Track> _tracks;
     std::map<int, Point> _trackStarts;
 
@@ -73,9 +80,14 @@ private:
     std::map<int, std::vector<Wall>> _trainWallsRemoved;
 
     /**
-     * Map of doors added temporarily for a specific train
+     * Doors added temporarily for a specific train and their usage
+     */
+    std::map<int, TrainDoorUsage> _trainDoorUsage;
+
+    /**
+     * Train IDs by the unique IDs of their doors
      */
-    std::map<int, std::vector<Transition>> _trainDoorsAdded;
+    std::unordered_map<int, int> _trainOfDoor;
 
 public:
     explicit Building(Configuration* config);
@@ -97,6 +109,15 @@ public:
 
     bool IsInAnySubRoom(const Point pos) const;
 
+    /**
+     * Finds the subroom containing \p position, checking \p previous and its neighbors first.
+     * Agents move at most into a neighboring subroom per step, so only few subrooms are tested.
+     * @param position position to locate
+     * @param previous subroom the position was located in before, may be nullptr
+     * @return room and subroom containing \p position, nullptrs if it is outside of all subrooms
+     */
+    std::tuple<Room*, SubRoom*> LocateSubRoom(const Point& position, SubRoom* previous) const;
+
     Room* GetRoom(const Point position) const;
     SubRoom* GetSubRoom(const Point position) const;
 
@@ -141,6 +162,10 @@ public:
     // convenience methods
     bool InitGeometry();
 
+    /**
+     * (Re)builds the grid used to locate the subroom of a position. Needs to be called after
+     * the polygon of a subroom changed.
+     */
     void InitGrid();
 
     void AddRoom(Room* room);
@@ -170,9 +195,21 @@ public:
     void ClearTrainWallsRemoved(int trainID);
     std::optional<std::vector<Wall>> GetTrainWallsRemoved(int trainID);
 
-    void AddTrainDoorAdded(int trainID, Transition trainAddedDoor);
+    void AddTrainDoorAdded(int trainID, Transition* trainAddedDoor);
     void ClearTrainDoorsAdded(int trainID);
-    std::optional<std::vector<Transition>> GetTrainDoorsAdded(int trainID);
+
+    /**
+     * Counts agents passing a door towards the usage of its train.
+     * @param doorUID unique ID of the passed door, doors of no train are ignored
+     * @param number number of agents which have passed the door
+     */
+    void IncreaseTrainDoorUsage(int doorUID, int number);
+
+    /**
+     * Get the doors and their usage of the trains which have arrived
+     * @return doors and usage with trainID as key
+     */
+    const std::map<int, TrainDoorUsage>& GetTrainDoorUsage() const;
 
     // ------------------------------------
     bool AddCrossing(Crossing* line);
@@ -218,7 +255,7 @@ public:
      * Get the train types as map
      * @return train types of the building with trainID as key
      */
-    std::map<int, TrainType> GetTrains() const;
+    const std::map<int, TrainType>& GetTrains() const;
 
     void AddTrackWall(int trackID, int roomID, int subRoomID, Wall trackWall);
 
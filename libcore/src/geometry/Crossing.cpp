@@ -29,7 +29,6 @@
 #include "SubRoom.hpp"
 
 #include <Logger.hpp>
-#include <fmt/core.h>
 
 Crossing::Crossing()
 {
@@ -190,7 +189,7 @@ void Crossing::IncreaseDoorUsage(int number, double time, Pedestrian::UID ped_id
     _doorUsage += number;
     _tempDoorUsage += number;
     _lastPassingTime = time;
-    _flowAtExit += fmt::format("{} {} {}\n", time, _doorUsage, ped_id);
+    _flow.Record(time, _doorUsage, ped_id);
 }
 
 void Crossing::IncreasePartialDoorUsage(int number)
@@ -238,9 +237,14 @@ double Crossing::GetLastPassingTime() const
     return _lastPassingTime;
 }
 
-const std::string& Crossing::GetFlowCurve() const
+FlowRecorder& Crossing::GetFlowRecorder()
 {
-    return _flowAtExit;
+    return _flow;
+}
+
+const FlowRecorder& Crossing::GetFlowRecorder() const
+{
+    return _flow;
 }
 
 void Crossing::SetOutflowRate(double outflow)
@@ -27,6 +27,7 @@
 #pragma once
 
 #include "DoorState.hpp"
+#include "FlowRecorder.hpp"
 #include "Hline.hpp"
 #include "pedestrian/Pedestrian.hpp"
 
@@ -89,7 +90,7 @@ private:
     /**
      * Timestamp and number of pedestrians who have passed the door.
      */
-    std::string _flowAtExit;
+    FlowRecorder _flow;
 
     /**
      * Current state of the door.
@@ -256,10 +257,16 @@ public:
     void SetOutflowRate(double outflow);
 
     /**
-     * Returns the time stamps and number of pedestrians passing the door.
-     * @return the time stamps and number of pedestrians passing the door.
+     * Returns the recorder of the pedestrians passing the door.
+     * @return the recorder of the pedestrians passing the door.
      */
-    [[nodiscard]] const std::string& GetFlowCurve() const;
+    [[nodiscard]] FlowRecorder& GetFlowRecorder();
+
+    /**
+     * Returns the recorder of the pedestrians passing the door.
+     * @return the recorder of the pedestrians passing the door.
+     */
+    [[nodiscard]] const FlowRecorder& GetFlowRecorder() const;
 
     /**
      * Returns the last time a ped used the door.
@@ -0,0 +1,107 @@
+#include "FlowRecorder.hpp"
+
+#include "IO/OutputHandler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+#include <iterator>
+#include <numeric>
+
+FlowRecorder::FlowRecorder(double binWidth) : _binWidth(binWidth)
+{
+}
+
+void FlowRecorder::Record(double time, int usage, Pedestrian::UID pedId)
+{
+    ++_passages;
+    const std::size_t bin = Bin(time);
+    if(bin >= _bins.size()) {
+        _bins.resize(bin + 1, 0);
+    }
+    ++_bins[bin];
+    if(_keepRecords) {
+        _pending.push_back({time, usage, pedId});
+    }
+}
+
+void FlowRecorder::SetKeepRecords(bool keepRecords)
+{
+    _keepRecords = keepRecords;
+    if(!_keepRecords) {
+        _pending.clear();
+    }
+}
+
+const std::vector<FlowRecord>& FlowRecorder::PendingRecords() const
+{
+    return _pending;
+}
+
+void FlowRecorder::Flush(OutputHandler& sink)
+{
+    if(_pending.empty()) {
+        return;
+    }
+    fmt::memory_buffer buffer;
+    for(std::size_t i = 0; i < _pending.size(); ++i) {
+        const FlowRecord& record = _pending[i];
+        // the sink terminates the last line
+        fmt::format_to(
+            std::back_inserter(buffer),
+            i + 1 < _pending.size() ? "{} {} {}\n" : "{} {} {}",
+            record.time,
+            record.usage,
+            record.pedId);
+    }
+    sink.Write(fmt::to_string(buffer));
+    _pending.clear();
+}
+
+std::size_t FlowRecorder::Passages() const
+{
+    return _passages;
+}
+
+std::size_t FlowRecorder::Passages(double begin, double end) const
+{
+    if(end <= begin || _bins.empty()) {
+        return 0;
+    }
+    const std::size_t first = std::min(Bin(begin), _bins.size());
+    // end is exclusive, a span ending at a bin border does not touch the next bin
+    const std::size_t last =
+        std::min(static_cast<std::size_t>(std::ceil(end / _binWidth)), _bins.size());
+    if(first >= last) {
+        return 0;
+    }
+    return std::accumulate(_bins.begin() + first, _bins.begin() + last, std::size_t{0});
+}
+
+double FlowRecorder::Flow(double begin, double end) const
+{
+    if(end <= begin) {
+        return 0.;
+    }
+    const double binBegin = std::floor(std::max(begin, 0.) / _binWidth) * _binWidth;
+    const double binEnd = std::ceil(end / _binWidth) * _binWidth;
+    if(binEnd <= binBegin) {
+        return 0.;
+    }
+    return static_cast<double>(Passages(begin, end)) / (binEnd - binBegin);
+}
+
+const std::vector<std::uint32_t>& FlowRecorder::PassagesPerBin() const
+{
+    return _bins;
+}
+
+double FlowRecorder::BinWidth() const
+{
+    return _binWidth;
+}
+
+std::size_t FlowRecorder::Bin(double time) const
+{
+    return static_cast<std::size_t>(std::max(time, 0.) / _binWidth);
+}
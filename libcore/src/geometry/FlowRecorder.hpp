@@ -0,0 +1,98 @@
+#pragma once
+
+#include "pedestrian/Pedestrian.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class OutputHandler;
+
+/**
+ * Passage of one pedestrian through a door.
+ */
+struct FlowRecord {
+    /// time of the passage [s]
+    double time;
+    /// number of pedestrians which have passed the door, including this one
+    int usage;
+    Pedestrian::UID pedId;
+};
+
+/**
+ * \class FlowRecorder
+ *
+ * \brief Records the pedestrians passing a door.
+ *
+ * Passages are kept as typed records until they are written to a sink with Flush, afterwards
+ * only the number of passages per time bin is kept. Aggregated flows can be queried at any time
+ * from these bins, so the memory needed does not grow with the number of passages.
+ */
+class FlowRecorder
+{
+public:
+    /**
+     * @param binWidth width [s] of the time bins the passages are counted in
+     */
+    explicit FlowRecorder(double binWidth = 1.);
+
+    /**
+     * Records a passage.
+     * @param time time of the passage [s]
+     * @param usage number of pedestrians which have passed the door, including this one
+     * @param pedId id of the pedestrian
+     */
+    void Record(double time, int usage, Pedestrian::UID pedId);
+
+    /**
+     * Sets if passages are kept until they are flushed, they are only counted otherwise. Passages
+     * are not kept by default, so recorders nobody flushes do not grow.
+     * @param keepRecords if passages are kept
+     */
+    void SetKeepRecords(bool keepRecords);
+
+    /// @return passages recorded since the last flush
+    [[nodiscard]] const std::vector<FlowRecord>& PendingRecords() const;
+
+    /**
+     * Writes the passages recorded since the last flush to \p sink, one line with time, usage
+     * and pedestrian id per passage, and drops them afterwards.
+     * @param sink sink to write to
+     */
+    void Flush(OutputHandler& sink);
+
+    /// @return number of passages recorded
+    [[nodiscard]] std::size_t Passages() const;
+
+    /**
+     * Counts the passages in the time bins overlapping [\p begin, \p end).
+     * @param begin start of the time span [s]
+     * @param end end of the time span [s]
+     * @return number of passages
+     */
+    [[nodiscard]] std::size_t Passages(double begin, double end) const;
+
+    /**
+     * Flow through the door in the time bins overlapping [\p begin, \p end).
+     * @param begin start of the time span [s]
+     * @param end end of the time span [s]
+     * @return flow [1/s], 0 for an empty time span
+     */
+    [[nodiscard]] double Flow(double begin, double end) const;
+
+    /// @return number of passages per time bin, bin i starts at i * binWidth
+    [[nodiscard]] const std::vector<std::uint32_t>& PassagesPerBin() const;
+
+    /// @return width [s] of the time bins
+    [[nodiscard]] double BinWidth() const;
+
+private:
+    /// @return bin of \p time, negative times fall into the first bin
+    [[nodiscard]] std::size_t Bin(double time) const;
+
+    double _binWidth;
+    bool _keepRecords{false};
+    std::size_t _passages{0};
+    std::vector<std::uint32_t> _bins;
+    std::vector<FlowRecord> _pending;
+};
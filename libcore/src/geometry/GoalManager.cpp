@@ -29,17 +29,44 @@
 #include "WaitingArea.hpp"
 #include "pedestrian/Pedestrian.hpp"
 
-GoalManager::GoalManager(Building* building, Simulation* simulation)
-    : _building(building), _simulation(simulation)
+#include <algorithm>
+#include <limits>
+
+GoalManager::GoalManager(Building* building, Simulation* simulation, unsigned int seed)
+    : _building(building), _simulation(simulation), _generator(seed)
 {
+    if(!_building) {
+        return;
+    }
+    for(const auto& [id, goal] : _building->GetAllGoals()) {
+        auto* wa = dynamic_cast<WaitingArea*>(goal);
+        if(wa == nullptr) {
+            continue;
+        }
+        WaitingAreaEntry entry{
+            wa,
+            std::numeric_limits<double>::max(),
+            std::numeric_limits<double>::lowest(),
+            std::numeric_limits<double>::max(),
+            std::numeric_limits<double>::lowest()};
+        for(const Point& p : wa->GetPolygon()) {
+            entry.minX = std::min(entry.minX, p.x);
+            entry.maxX = std::max(entry.maxX, p.x);
+            entry.minY = std::min(entry.minY, p.y);
+            entry.maxY = std::max(entry.maxY, p.y);
+        }
+        _waitingAreaIndex[id] = _waitingAreas.size();
+        _waitingAreas.push_back(entry);
+        for(const auto& [nextGoal, _] : wa->GetNextGoals()) {
+            _predecessors[nextGoal].push_back(wa);
+        }
+    }
 }
 
 void GoalManager::ProcessPedPosition(Pedestrian* ped, double time)
 {
     // Ped is in current waiting area
-    if(CheckInsideWaitingArea(ped, ped->GetFinalDestination())) {
-        WaitingArea* wa =
-            dynamic_cast<WaitingArea*>(_building->GetAllGoals().at(ped->GetFinalDestination()));
+    if(WaitingArea* wa = CheckInsideWaitingArea(ped, ped->GetFinalDestination())) {
         wa->AddPed(ped->GetUID());
         ped->EnterGoal();
         if(!wa->IsOpen()) {
@@ -54,21 +81,18 @@ void GoalManager::ProcessPedPosition(Pedestrian* ped, double time)
 
 void GoalManager::ProcessWaitingAreas(double time)
 {
-    if(_building) {
-        for(auto goalItr : _building->GetAllGoals()) {
-            if(auto wa = dynamic_cast<WaitingArea*>(goalItr.second)) {
-                if(!wa->IsWaiting(time, _building)) {
-                    auto pedsInside = wa->GetPedInside();
-                    for(auto p : pedsInside) {
-                        auto& ped = _simulation->Agent(p);
-                        wa->RemovePed(p);
-                        ped.LeaveGoal();
-                        if(wa->IsOpen()) {
-                            SetState(wa->GetId(), true);
-                        }
-                        ped.SetFinalDestination(wa->GetNextGoal());
-                    }
+    for(const auto& entry : _waitingAreas) {
+        auto* wa = entry.area;
+        if(!wa->IsWaiting(time, _building)) {
+            auto pedsInside = wa->GetPedInside();
+            for(auto p : pedsInside) {
+                auto& ped = _simulation->Agent(p);
+                wa->RemovePed(p);
+                ped.LeaveGoal();
+                if(wa->IsOpen()) {
+                    SetState(wa->GetId(), true);
                 }
+                ped.SetFinalDestination(wa->GetNextGoal(_generator));
             }
         }
     }
@@ -88,33 +112,37 @@ bool GoalManager::CheckInside(Pedestrian* ped, int goalID)
     return false;
 }
 
-bool GoalManager::CheckInsideWaitingArea(Pedestrian* ped, int goalID)
+WaitingArea* GoalManager::CheckInsideWaitingArea(Pedestrian* ped, int goalID)
 {
-    if(goalID < 0) {
-        return false;
+    auto iter = _waitingAreaIndex.find(goalID);
+    if(iter == _waitingAreaIndex.end()) {
+        return nullptr;
     }
 
-    Goal* goal = _building->GetAllGoals().at(goalID);
-
-    if(goal != nullptr) {
-        if(dynamic_cast<WaitingArea*>(goal)) {
-            return goal->IsInsideGoal(ped->GetPos());
-        }
+    const auto& entry = _waitingAreas[iter->second];
+    const Point& pos = ped->GetPos();
+    if(pos.x < entry.minX || pos.x > entry.maxX || pos.y < entry.minY || pos.y > entry.maxY) {
+        return nullptr;
     }
-    return false;
+    return entry.area->IsInsideGoal(pos) ? entry.area : nullptr;
 }
 
 void GoalManager::SetState(int goalID, bool state)
 {
-    for(auto& goalItr : _building->GetAllGoals()) {
-        if(auto goal = dynamic_cast<WaitingArea*>(goalItr.second)) {
-            goal->UpdateProbabilities(state, goalID);
-        }
+    auto iter = _predecessors.find(goalID);
+    if(iter == _predecessors.end()) {
+        return;
+    }
+    for(auto* wa : iter->second) {
+        wa->UpdateProbabilities(state, goalID);
     }
 }
 
 void GoalManager::update(double time)
 {
+    if(_waitingAreas.empty()) {
+        return;
+    }
     for(const auto& ped : _simulation->Agents()) {
         ProcessPedPosition(ped.get(), time);
     }
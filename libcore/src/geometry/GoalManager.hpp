@@ -26,23 +26,49 @@
 #pragma once
 
 #include "Goal.hpp"
-#include "Simulation.hpp"
 #include "geometry/Building.hpp"
 #include "pedestrian/Pedestrian.hpp"
 
 #include <map>
+#include <random>
+#include <unordered_map>
 #include <vector>
 
 class Simulation;
+class WaitingArea;
 
+/**
+ * The goal manager lives as long as the simulation. The waiting areas of the building are
+ * collected once on construction, agents are only tested against the polygon of their waiting
+ * area if they are within its bounding box.
+ */
 class GoalManager
 {
 private:
+    /// Waiting area with the bounding box of its polygon
+    struct WaitingAreaEntry {
+        WaitingArea* area;
+        double minX, maxX, minY, maxY;
+    };
+
     Building* _building;
     Simulation* _simulation;
+    /// waiting areas ordered by their ID
+    std::vector<WaitingAreaEntry> _waitingAreas;
+    /// goal ID to index in _waitingAreas
+    std::unordered_map<int, std::size_t> _waitingAreaIndex;
+    /// goal ID to the waiting areas listing the goal as next goal
+    std::unordered_map<int, std::vector<WaitingArea*>> _predecessors;
+    /// random stream choosing the next goals of agents leaving waiting areas
+    std::mt19937_64 _generator;
 
 public:
-    GoalManager(Building* building, Simulation* _simulation);
+    /**
+     * @param building building with the goals, the goals must not change afterwards
+     * @param simulation simulation with the agents
+     * @param seed seed of the random choice of the next goals
+     */
+    GoalManager(Building* building, Simulation* simulation, unsigned int seed);
 
     /**
      * Checks if the pedestrians have entered a goal/wa or if the waiting inside a waiting area is
@@ -79,9 +105,10 @@ private:
      * Checks if pedestrian is inside a specific waiting area
      * @param[in] ped pedestrians, which position is checked
      * @param[in] goalID ID of the waiting area
-     * @return ped is inside goalID
+     * @return waiting area \p ped is inside of, nullptr if goalID is no waiting area or ped is
+     * outside
      */
-    bool CheckInsideWaitingArea(Pedestrian* ped, int goalID);
+    WaitingArea* CheckInsideWaitingArea(Pedestrian* ped, int goalID);
 
     /**
      * Sets the state of a specific goal and informs the other goals of changes
@@ -0,0 +1,89 @@
+#include "SegmentIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+SegmentIndex::SegmentIndex(double cellSize) : _cellSize(cellSize)
+{
+}
+
+void SegmentIndex::Insert(const Line& line)
+{
+    const Point& p1 = line.GetPoint1();
+    const Point& p2 = line.GetPoint2();
+    const long iMin = CellIndex(std::min(p1.x, p2.x) - _margin);
+    const long iMax = CellIndex(std::max(p1.x, p2.x) + _margin);
+    const long jMin = CellIndex(std::min(p1.y, p2.y) - _margin);
+    const long jMax = CellIndex(std::max(p1.y, p2.y) + _margin);
+
+    const std::size_t index = _lines.size();
+    _lines.push_back(line);
+    for(long j = jMin; j <= jMax; ++j) {
+        for(long i = iMin; i <= iMax; ++i) {
+            _cells[Key(i, j)].push_back(index);
+        }
+    }
+}
+
+bool SegmentIndex::Contains(const Line& line) const
+{
+    // an equal segment has its centre within J_EPS of the centre of line
+    const Point& centre = line.GetCentre();
+    auto iter = _cells.find(Key(CellIndex(centre.x), CellIndex(centre.y)));
+    if(iter == _cells.end()) {
+        return false;
+    }
+    return std::any_of(iter->second.begin(), iter->second.end(), [this, &line](auto index) {
+        return _lines[index] == line;
+    });
+}
+
+bool SegmentIndex::IsCloserThan(const Point& point, double distance) const
+{
+    if(distance <= 0) {
+        return false;
+    }
+    // scanning all segments is cheaper than visiting more cells than there are occupied ones
+    const double span = 2 * distance / _cellSize + 1;
+    if(span * span > static_cast<double>(_cells.size())) {
+        return std::any_of(_lines.begin(), _lines.end(), [&point, distance](const Line& line) {
+            return line.DistTo(point) < distance;
+        });
+    }
+    const long iMin = CellIndex(point.x - distance);
+    const long iMax = CellIndex(point.x + distance);
+    const long jMin = CellIndex(point.y - distance);
+    const long jMax = CellIndex(point.y + distance);
+
+    for(long j = jMin; j <= jMax; ++j) {
+        for(long i = iMin; i <= iMax; ++i) {
+            auto iter = _cells.find(Key(i, j));
+            if(iter == _cells.end()) {
+                continue;
+            }
+            for(auto index : iter->second) {
+                if(_lines[index].DistTo(point) < distance) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+std::size_t SegmentIndex::Size() const
+{
+    return _lines.size();
+}
+
+long SegmentIndex::CellIndex(double coordinate) const
+{
+    return static_cast<long>(std::floor(coordinate / _cellSize));
+}
+
+SegmentIndex::CellKey SegmentIndex::Key(long i, long j)
+{
+    // shifting negative values is undefined, cell indices are negative below the origin
+    return static_cast<CellKey>(
+        (static_cast<std::uint64_t>(i) << 32) ^ (static_cast<std::uint64_t>(j) & 0xffffffff));
+}
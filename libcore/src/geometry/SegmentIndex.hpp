@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Line.hpp"
+#include "general/Macros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Spatial index of line segments for equality and proximity queries.
+ *
+ * Each segment is registered in all cells of a sparse uniform grid touched by its bounding box,
+ * so queries only compare the segments around the query position. Segments can be added at any
+ * time, the extent of the index does not need to be known in advance.
+ */
+class SegmentIndex
+{
+public:
+    /**
+     * @param cellSize edge length of the grid cells
+     */
+    explicit SegmentIndex(double cellSize = 1.);
+    ~SegmentIndex() = default;
+
+    SegmentIndex(const SegmentIndex&) = default;
+    SegmentIndex& operator=(const SegmentIndex&) = default;
+
+    SegmentIndex(SegmentIndex&&) = default;
+    SegmentIndex& operator=(SegmentIndex&&) = default;
+
+    /**
+     * Adds a copy of \p line to the index.
+     * @param line segment to add
+     */
+    void Insert(const Line& line);
+
+    /**
+     * @return true if the index contains a segment equal to \p line (see Line::operator==)
+     */
+    bool Contains(const Line& line) const;
+
+    /**
+     * @return true if any segment of the index is closer than \p distance to \p point
+     */
+    bool IsCloserThan(const Point& point, double distance) const;
+
+    /**
+     * @return number of segments in the index
+     */
+    std::size_t Size() const;
+
+private:
+    using CellKey = std::int64_t;
+
+    long CellIndex(double coordinate) const;
+    static CellKey Key(long i, long j);
+
+    /// cells covering the bounding box of the segments are enlarged by this margin, so segments
+    /// equal within J_EPS are found in the cell of the query
+    static constexpr double _margin{2 * J_EPS};
+
+    double _cellSize;
+    std::vector<Line> _lines;
+    std::unordered_map<CellKey, std::vector<std::size_t>> _cells;
+};
@@ -0,0 +1,139 @@
+#include "SubRoomLocator.hpp"
+
+#include "Room.hpp"
+#include "SubRoom.hpp"
+#include "Transition.hpp"
+#include "Wall.hpp"
+
+#include <Logger.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+/// Bounding box of everything IsInSubRoom() may accept.
+std::tuple<Point, Point> BoundingBox(const SubRoom& subroom)
+{
+    Point min{std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    Point max{std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+    const auto extend = [&min, &max](const Point& p) {
+        min = Point{std::min(min.x, p.x), std::min(min.y, p.y)};
+        max = Point{std::max(max.x, p.x), std::max(max.y, p.y)};
+    };
+    for(const auto& p : subroom.GetPolygon()) {
+        extend(p);
+    }
+    for(const auto& wall : subroom.GetAllWalls()) {
+        extend(wall.GetPoint1());
+        extend(wall.GetPoint2());
+    }
+    for(const auto* trans : subroom.GetAllTransitions()) {
+        extend(trans->GetPoint1());
+        extend(trans->GetPoint2());
+    }
+    for(const auto* cross : subroom.GetAllCrossings()) {
+        extend(cross->GetPoint1());
+        extend(cross->GetPoint2());
+    }
+    return {min, max};
+}
+} // namespace
+
+void SubRoomLocator::Build(const std::map<int, std::shared_ptr<Room>>& rooms, double cellSize)
+{
+    _cells.clear();
+    _nx = _ny = 0;
+
+    Point min{std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    Point max{std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+    std::vector<std::tuple<Candidate, Point, Point>> subrooms;
+    for(const auto& [_, room] : rooms) {
+        for(const auto& [__, subroom] : room->GetAllSubRooms()) {
+            auto [subMin, subMax] = BoundingBox(*subroom);
+            if(subMin.x > subMax.x) {
+                continue;
+            }
+            min = Point{std::min(min.x, subMin.x), std::min(min.y, subMin.y)};
+            max = Point{std::max(max.x, subMax.x), std::max(max.y, subMax.y)};
+            subrooms.emplace_back(Candidate{room.get(), subroom.get()}, subMin, subMax);
+        }
+    }
+    if(subrooms.empty()) {
+        return;
+    }
+
+    _origin = min - Point{_margin, _margin};
+    const Point extent = max - min + Point{2 * _margin, 2 * _margin};
+    _cellSize = std::max(cellSize, std::sqrt(extent.x * extent.y / _maxCells));
+    _nx = static_cast<long>(std::ceil(extent.x / _cellSize)) + 1;
+    _ny = static_cast<long>(std::ceil(extent.y / _cellSize)) + 1;
+    _cells.resize(_nx * _ny);
+
+    for(const auto& [candidate, subMin, subMax] : subrooms) {
+        polygon_type polygon;
+        for(const auto& p : candidate.subroom->GetPolygon()) {
+            bg::append(polygon.outer(), p);
+        }
+        bg::correct(polygon);
+        // without a valid polygon, the subroom is a candidate in its whole bounding box
+        const bool usePolygon = polygon.outer().size() >= 3;
+
+        const long iMin = static_cast<long>((subMin.x - _margin - _origin.x) / _cellSize);
+        const long iMax = static_cast<long>((subMax.x + _margin - _origin.x) / _cellSize);
+        const long jMin = static_cast<long>((subMin.y - _margin - _origin.y) / _cellSize);
+        const long jMax = static_cast<long>((subMax.y + _margin - _origin.y) / _cellSize);
+        for(long j = std::max(0L, jMin); j <= std::min(_ny - 1, jMax); ++j) {
+            for(long i = std::max(0L, iMin); i <= std::min(_nx - 1, iMax); ++i) {
+                if(usePolygon) {
+                    const Point low =
+                        _origin + Point{i * _cellSize - _margin, j * _cellSize - _margin};
+                    const double size = _cellSize + 2 * _margin;
+                    polygon_type cell;
+                    bg::append(cell.outer(), low);
+                    bg::append(cell.outer(), low + Point{size, 0});
+                    bg::append(cell.outer(), low + Point{size, size});
+                    bg::append(cell.outer(), low + Point{0, size});
+                    bg::correct(cell);
+                    if(!bg::intersects(cell, polygon)) {
+                        continue;
+                    }
+                }
+                _cells[j * _nx + i].push_back(candidate);
+            }
+        }
+    }
+
+    std::size_t maxCandidates = 0;
+    for(const auto& cell : _cells) {
+        maxCandidates = std::max(maxCandidates, cell.size());
+    }
+    LOG_INFO(
+        "Subroom lookup grid: {}x{} cells of {:.2f} m, at most {} subrooms per cell.",
+        _nx,
+        _ny,
+        _cellSize,
+        maxCandidates);
+}
+
+std::tuple<Room*, SubRoom*> SubRoomLocator::Locate(const Point& position) const
+{
+    if(const auto* cell = Cell(position)) {
+        for(const auto& candidate : *cell) {
+            if(candidate.subroom->IsInSubRoom(position)) {
+                return {candidate.room, candidate.subroom};
+            }
+        }
+    }
+    return {nullptr, nullptr};
+}
+
+const std::vector<SubRoomLocator::Candidate>* SubRoomLocator::Cell(const Point& position) const
+{
+    const double x = (position.x - _origin.x) / _cellSize;
+    const double y = (position.y - _origin.y) / _cellSize;
+    if(!(x >= 0 && y >= 0 && x < _nx && y < _ny)) {
+        return nullptr;
+    }
+    return &_cells[static_cast<long>(y) * _nx + static_cast<long>(x)];
+}
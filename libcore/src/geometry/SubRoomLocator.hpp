@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Point.hpp"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+class Room;
+class SubRoom;
+
+/**
+ * Point location index of the subrooms of a building.
+ *
+ * The bounding box of the geometry is covered by a uniform grid. Each cell lists the subrooms
+ * whose polygon touches the cell, so a query only tests the one or two subrooms around the
+ * point instead of all subrooms of the building. The candidates of a cell keep the order of
+ * the rooms and subrooms, a point on the boundary of two subrooms is located in the same subroom
+ * as by a linear search.
+ */
+class SubRoomLocator
+{
+public:
+    SubRoomLocator() = default;
+    ~SubRoomLocator() = default;
+
+    SubRoomLocator(const SubRoomLocator&) = delete;
+    SubRoomLocator& operator=(const SubRoomLocator&) = delete;
+
+    SubRoomLocator(SubRoomLocator&&) = default;
+    SubRoomLocator& operator=(SubRoomLocator&&) = default;
+
+    /**
+     * (Re)builds the index, needs to be called after the polygon of a subroom changed.
+     * @param rooms all rooms of the building
+     * @param cellSize edge length of the grid cells, enlarged for very large geometries
+     */
+    void Build(const std::map<int, std::shared_ptr<Room>>& rooms, double cellSize = 1.);
+
+    /**
+     * Finds the subroom containing \p position.
+     * @param position point to locate
+     * @return room and subroom containing \p position, nullptrs if there is none
+     */
+    std::tuple<Room*, SubRoom*> Locate(const Point& position) const;
+
+private:
+    struct Candidate {
+        Room* room;
+        SubRoom* subroom;
+    };
+
+    /// cells are enlarged by this margin when checking which subrooms touch them
+    static constexpr double _margin{0.1};
+    /// upper bound of the number of cells
+    static constexpr std::size_t _maxCells{1u << 22};
+
+    /**
+     * Returns the cell containing \p position.
+     * @param position point
+     * @return candidates of the cell, nullptr if \p position is outside of the grid
+     */
+    const std::vector<Candidate>* Cell(const Point& position) const;
+
+    Point _origin{};
+    double _cellSize{1.};
+    long _nx{0};
+    long _ny{0};
+    std::vector<std::vector<Candidate>> _cells;
+};
@@ -25,6 +25,8 @@
 #include <string>
 #include <vector>
 
+class Transition;
+
 /**
  * Information where a specific track is located, and which walls describe the platform edges.
  */
@@ -54,3 +56,11 @@ struct TrainType {
     double _length; /** Length of the train. */
     std::map<int, TrainDoor> _doors; /** Doors of the train. */
 };
+
+/**
+ * Doors of an arrived train and the number of agents which have passed them.
+ */
+struct TrainDoorUsage {
+    std::vector<Transition*> _doors; /** Doors of the train added to the building. */
+    int _usage{0}; /** Number of agents which have passed the doors. */
+};
@@ -133,10 +133,8 @@ void WaitingArea::SetWaitingTime(int waitingTime)
     WaitingArea::_waitingTime = waitingTime;
 }
 
-int WaitingArea::GetNextGoal()
+int WaitingArea::GetNextGoal(std::mt19937_64& generator)
 {
-    // TODO create global util for random numbers
-    std::mt19937_64 gen(_rd());
     // probability of the next goals
     std::vector<double> weights;
     // states if at least one of the succeeding goals is open
@@ -156,7 +154,7 @@ int WaitingArea::GetNextGoal()
         // if at least one open goal, get random number regarding the
         // weights
         std::discrete_distribution<> distribution(weights.begin(), weights.end());
-        int index = distribution(gen);
+        int index = distribution(generator);
 
         auto iter = _nextGoals.begin();
         std::advance(iter, index);
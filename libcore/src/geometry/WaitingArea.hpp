@@ -39,11 +39,6 @@ class Building;
 class WaitingArea : public Goal
 {
 protected:
-    /**
-     * Random device
-     */
-    std::random_device _rd;
-
     /**
      * Number of pedestrians which are allowed inside the waiting area
      */
@@ -159,9 +154,10 @@ public:
     /**
      * Returns the ID of the next goal based on the probability. Only
      * considers open goals.
+     * @param[in] generator random stream drawing the next goal
      * @return ID of the next goal or own ID if no open goal available
      */
-    int GetNextGoal();
+    int GetNextGoal(std::mt19937_64& generator);
 
     /**
      * Adds ped to the pedestrians inside the waiting area
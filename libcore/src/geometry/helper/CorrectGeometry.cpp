@@ -265,11 +265,11 @@ void AddTrainDoors(
         std::end(trainDoors),
         [trainId, &building, &room, &subroom](const Transition& door) {
             auto trainDoor = new Transition(door);
-            building.AddTrainDoorAdded(trainId, door);
             // Important: Door needs to be added to room, subroom, and building!
             room->AddTransitionID(trainDoor->GetUniqueID());
             subroom->AddTransition(trainDoor);
             building.AddTransition(trainDoor);
+            building.AddTrainDoorAdded(trainId, trainDoor);
         });
 
     subroom->Update();
@@ -61,6 +61,7 @@ void AgentsParameters::InitV0UpStairs(double mean, double stdv, double smoothFac
     }
     _V0UpStairs = std::normal_distribution<double>(mean, stdv);
     _smoothFactorUpStairs = smoothFactor;
+    _profile.reset();
 }
 
 void AgentsParameters::InitV0DownStairs(double mean, double stdv, double smoothFactor)
@@ -70,6 +71,7 @@ void AgentsParameters::InitV0DownStairs(double mean, double stdv, double smoothF
     }
     _V0DownStairs = std::normal_distribution<double>(mean, stdv);
     _smoothFactorDownStairs = smoothFactor;
+    _profile.reset();
 }
 
 void AgentsParameters::InitEscalatorUpStairs(double mean, double stdv, double smoothFactor)
@@ -79,6 +81,7 @@ void AgentsParameters::InitEscalatorUpStairs(double mean, double stdv, double sm
     }
     _EscalatorUpStairs = std::normal_distribution<double>(mean, stdv);
     _smoothFactorEscalatorUpStairs = smoothFactor;
+    _profile.reset();
 }
 
 void AgentsParameters::InitEscalatorDownStairs(double mean, double stdv, double smoothFactor)
@@ -88,6 +91,7 @@ void AgentsParameters::InitEscalatorDownStairs(double mean, double stdv, double
     }
     _EscalatorDownStairs = std::normal_distribution<double>(mean, stdv);
     _smoothFactorEscalatorDownStairs = smoothFactor;
+    _profile.reset();
 }
 
 void AgentsParameters::InitBmax(double mean, double stdv)
@@ -306,3 +310,16 @@ double AgentsParameters::GetBmaxMean()
 {
     return _Bmax.mean();
 }
+
+std::shared_ptr<const PedestrianProfile> AgentsParameters::GetProfile()
+{
+    if(!_profile) {
+        PedestrianProfile profile;
+        profile.smoothFactorUpStairs = _smoothFactorUpStairs;
+        profile.smoothFactorDownStairs = _smoothFactorDownStairs;
+        profile.smoothFactorEscalatorUpStairs = _smoothFactorEscalatorUpStairs;
+        profile.smoothFactorEscalatorDownStairs = _smoothFactorEscalatorDownStairs;
+        _profile = std::make_shared<const PedestrianProfile>(profile);
+    }
+    return _profile;
+}
@@ -28,6 +28,9 @@
  **/
 #pragma once
 
+#include "PedestrianProfile.hpp"
+
+#include <memory>
 #include <random>
 
 class AgentsParameters
@@ -206,6 +209,11 @@ public:
 
     double GetBmaxMean();
 
+    /**
+     * @return parameters shared by all agents of this set, created on the first call
+     */
+    std::shared_ptr<const PedestrianProfile> GetProfile();
+
 private:
     int _id;
     std::default_random_engine _generator;
@@ -224,6 +232,7 @@ private:
     std::normal_distribution<double> _Tau;
     std::normal_distribution<double> _T;
     const double judge = 10000;
+    std::shared_ptr<const PedestrianProfile> _profile;
 
 public:
     /**
@@ -32,6 +32,7 @@
 #include "StartDistribution.hpp"
 
 #include <Logger.hpp>
+#include <algorithm>
 
 AgentsSource::AgentsSource(
     int id,
@@ -80,6 +81,19 @@ void AgentsSource::GenerateAgentsAndAddToPool(int count, Building* building)
     _agentsGenerated += count;
 }
 
+void AgentsSource::FillPool(int count, Building* building)
+{
+    const int missing = std::min(count - GetPoolSize(), _maxAgents - _agentsGenerated);
+    if(missing <= 0) {
+        return;
+    }
+    // new agents queue up behind the agents which found no place before
+    std::vector<Pedestrian*> peds;
+    GenerateAgents(peds, missing, building);
+    _agents.insert(_agents.end(), peds.begin(), peds.end());
+    _agentsGenerated += missing;
+}
+
 void AgentsSource::RemoveAgentsFromPool(std::vector<Pedestrian*>& ped, int count)
 {
     if((int) _agents.size() >= count) {
@@ -100,6 +114,22 @@ bool AgentsSource::Greedy() const
 {
     return _greedy;
 }
+
+void AgentsSource::SetPlacement(Placement placement, unsigned int seed)
+{
+    _placement = placement;
+    _placementGenerator.seed(seed);
+}
+
+AgentsSource::Placement AgentsSource::GetPlacement() const
+{
+    return _placement;
+}
+
+std::mt19937& AgentsSource::PlacementGenerator()
+{
+    return _placementGenerator;
+}
 int AgentsSource::GetPoolSize() const
 {
     return (int) _agents.size();
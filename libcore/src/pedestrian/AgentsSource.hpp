@@ -31,6 +31,7 @@
 #include "pedestrian/Pedestrian.hpp"
 
 #include <memory>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -41,6 +42,9 @@ class Building;
 class AgentsSource
 {
 public:
+    /// algorithm positioning the agents of a source
+    enum class Placement { VORONOI, BEST_CANDIDATE };
+
     /**
      * Constructor
      */
@@ -79,6 +83,14 @@ public:
      */
     void GenerateAgentsAndAddToPool(int count, Building* building);
 
+    /**
+     * Generates agents until the pool holds \p count agents or the source generated its
+     * maximum number of agents. Pools filled upfront are not changed.
+     * @param count number of agents needed from the pool
+     * @param building building the agents are generated for
+     */
+    void FillPool(int count, Building* building);
+
     /**
      * Generate agents, but do not add them to the pool.
      *
@@ -136,6 +148,17 @@ public:
     float GetRate() const;
     std::vector<int> GetLifeSpan() const;
     bool Greedy() const;
+
+    /**
+     * Sets the algorithm positioning the agents.
+     * @param placement algorithm
+     * @param seed seed of the random positions
+     */
+    void SetPlacement(Placement placement, unsigned int seed);
+    Placement GetPlacement() const;
+    /// @return random generator of the positions, it keeps its state between time steps
+    std::mt19937& PlacementGenerator();
+
     void SetStartDistribution(std::shared_ptr<StartDistribution>);
     const std::shared_ptr<StartDistribution> GetStartDistribution() const;
 
@@ -146,6 +169,8 @@ private:
     int _groupID = -1;
     std::string _caption = "no caption";
     bool _greedy = false;
+    Placement _placement = Placement::VORONOI;
+    std::mt19937 _placementGenerator;
     int _agentsGenerated = 0;
     std::vector<float> _boundaries;
     double _time; /// planned generation time. here \var _maxAgents = 1
@@ -28,6 +28,7 @@
  **/
 #include "AgentsSourcesManager.hpp"
 
+#include "BestCandidateSampler.hpp"
 #include "Pedestrian.hpp"
 #include "geometry/Building.hpp"
 #include "neighborhood/NeighborhoodSearch.hpp"
@@ -70,6 +71,11 @@ AgentsSourcesManager::ProcessAllSources(double current_time) const
             src->ResetRemainingAgents();
 
         bool timeToCreate = newCycle || subCycle;
+        if(timeToCreate && (src->GetPlanTime() <= current_time) && inTime &&
+           src->GetRemainingAgents()) {
+            // without GenerateAgents the pools are filled when agents are needed
+            src->FillPool(src->GetChunkAgents() * src->GetPercent(), _building);
+        }
         LOG_DEBUG(
             "timeToCreate: {} pool size: {} plan time < current time: {} inTime: {} "
             "remainingAgents: {}",
@@ -99,6 +105,10 @@ AgentsSourcesManager::ProcessAllSources(double current_time) const
                     src->GetStartX(),
                     src->GetStartY());
                 InitFixedPosition(src.get(), peds);
+            } else if(src->GetPlacement() == AgentsSource::Placement::BEST_CANDIDATE) {
+                if(!ComputeBestPositionBestCandidate(src.get(), peds, _building, source_peds)) {
+                    LOG_WARNING("There was no place for some pedestrians");
+                }
             } else if(!ComputeBestPositionVoronoiBoost(src.get(), peds, _building, source_peds))
                 LOG_WARNING("There was no place for some pedestrians");
 
@@ -76,7 +76,8 @@ public:
 
     /**
      * Trigger the sources to generate the specified
-     * number of agents for this frequency
+     * number of agents for this frequency. Without calling this, ProcessAllSources generates
+     * the agents when they are needed.
      */
     void GenerateAgents();
 
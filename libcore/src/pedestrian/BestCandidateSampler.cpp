@@ -0,0 +1,176 @@
+#include "BestCandidateSampler.hpp"
+
+#include "AgentsSource.hpp"
+#include "Pedestrian.hpp"
+#include "StartDistribution.hpp"
+#include "geometry/Building.hpp"
+#include "geometry/Obstacle.hpp"
+#include "geometry/SubRoom.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+/// candidates drawn for each agent
+constexpr std::size_t CANDIDATES = 16;
+/// random positions tried for each agent, positions close to walls are not candidates
+constexpr std::size_t MAX_ATTEMPTS = 16 * CANDIDATES;
+} // namespace
+
+BestCandidateSampler::BestCandidateSampler(
+    const SubRoom& subroom,
+    const std::vector<float>& boundaries,
+    std::mt19937& generator)
+    : _subroom(subroom)
+    , _generator(generator)
+    , _xMin(boundaries[0])
+    , _xMax(boundaries[1])
+    , _yMin(boundaries[2])
+    , _yMax(boundaries[3])
+{
+    double xMin = std::numeric_limits<double>::max();
+    double xMax = std::numeric_limits<double>::lowest();
+    double yMin = std::numeric_limits<double>::max();
+    double yMax = std::numeric_limits<double>::lowest();
+    for(const Point& vertex : subroom.GetPolygon()) {
+        xMin = std::min(xMin, vertex.x);
+        xMax = std::max(xMax, vertex.x);
+        yMin = std::min(yMin, vertex.y);
+        yMax = std::max(yMax, vertex.y);
+    }
+    _xMin = std::max(_xMin, xMin);
+    _xMax = std::min(_xMax, xMax);
+    _yMin = std::max(_yMin, yMin);
+    _yMax = std::min(_yMax, yMax);
+
+    for(const auto& wall : subroom.GetAllWalls()) {
+        _walls.Insert(wall);
+    }
+    for(const auto* obstacle : subroom.GetAllObstacles()) {
+        for(const auto& wall : obstacle->GetAllWalls()) {
+            _walls.Insert(wall);
+        }
+    }
+    for(const auto* transition : subroom.GetAllTransitions()) {
+        _doors.Insert(*transition);
+    }
+    for(const auto* crossing : subroom.GetAllCrossings()) {
+        _doors.Insert(*crossing);
+    }
+}
+
+void BestCandidateSampler::AddAgent(const Point& position)
+{
+    _agents[Key(CellIndex(position.x), CellIndex(position.y))].push_back(position);
+}
+
+std::optional<Point> BestCandidateSampler::Place(double radius, bool greedy)
+{
+    if(_xMin >= _xMax || _yMin >= _yMax) {
+        return std::nullopt;
+    }
+    std::uniform_real_distribution<double> x(_xMin, _xMax);
+    std::uniform_real_distribution<double> y(_yMin, _yMax);
+
+    std::vector<Point> candidates;
+    std::vector<double> weights;
+    double maxDistance = 0;
+    for(std::size_t attempt = 0; attempt < MAX_ATTEMPTS && candidates.size() < CANDIDATES;
+        ++attempt) {
+        const double candidateX = x(_generator);
+        const Point candidate{candidateX, y(_generator)};
+        if(!IsValid(candidate, radius)) {
+            continue;
+        }
+        const double distance = DistanceToAgents(candidate);
+        maxDistance = std::max(maxDistance, distance);
+        candidates.push_back(candidate);
+        // agents must not overlap, as with the vertices of the Voronoi placement
+        weights.push_back(distance > 2 * radius ? distance * distance : 0.);
+    }
+    if(maxDistance <= 2 * radius) {
+        return std::nullopt;
+    }
+
+    std::size_t chosen = 0;
+    if(greedy) {
+        chosen = std::max_element(weights.begin(), weights.end()) - weights.begin();
+    } else {
+        std::discrete_distribution<std::size_t> distribution(weights.begin(), weights.end());
+        chosen = distribution(_generator);
+    }
+    AddAgent(candidates[chosen]);
+    return candidates[chosen];
+}
+
+bool BestCandidateSampler::IsValid(const Point& position, double radius) const
+{
+    return _subroom.IsInSubRoom(position) && !_walls.IsCloserThan(position, radius) &&
+           !_doors.IsCloserThan(position, radius + 0.1);
+}
+
+double BestCandidateSampler::DistanceToAgents(const Point& position) const
+{
+    // agents closer than _maxDistance are in the cell of the position or its neighbors
+    const std::int64_t i = CellIndex(position.x);
+    const std::int64_t j = CellIndex(position.y);
+    double minDistance = _maxDistance;
+    for(std::int64_t dj = -1; dj <= 1; ++dj) {
+        for(std::int64_t di = -1; di <= 1; ++di) {
+            auto cell = _agents.find(Key(i + di, j + dj));
+            if(cell == _agents.end()) {
+                continue;
+            }
+            for(const Point& agent : cell->second) {
+                minDistance = std::min(minDistance, Distance(position, agent));
+            }
+        }
+    }
+    return minDistance;
+}
+
+std::int64_t BestCandidateSampler::CellIndex(double coordinate) const
+{
+    return static_cast<std::int64_t>(std::floor(coordinate / _maxDistance));
+}
+
+BestCandidateSampler::CellKey BestCandidateSampler::Key(std::int64_t i, std::int64_t j)
+{
+    // shifting negative values is undefined, cell indices are negative below the origin
+    return static_cast<CellKey>(
+        (static_cast<std::uint64_t>(i) << 32) ^ (static_cast<std::uint64_t>(j) & 0xffffffff));
+}
+
+bool ComputeBestPositionBestCandidate(
+    AgentsSource* src,
+    std::vector<Pedestrian*>& peds,
+    Building* building,
+    std::vector<Pedestrian*>& peds_queue)
+{
+    auto dist = src->GetStartDistribution();
+    SubRoom* subroom = building->GetRoom(dist->GetRoomId())->GetSubRoom(dist->GetSubroomID());
+
+    BestCandidateSampler sampler(*subroom, src->GetBoundaries(), src->PlacementGenerator());
+    for(const auto* ped : peds_queue) {
+        sampler.AddAgent(ped->GetPos());
+    }
+
+    std::vector<Pedestrian*> placed;
+    std::vector<Pedestrian*> peds_without_place;
+    for(auto* ped : peds) {
+        if(auto position = sampler.Place(ped->GetEllipse().GetBmax(), src->Greedy())) {
+            ped->SetPos(*position);
+            placed.push_back(ped);
+        } else {
+            peds_without_place.push_back(ped);
+        }
+    }
+    peds = std::move(placed);
+    // requeue the pedestrians which found no place in the source
+    if(!peds_without_place.empty()) {
+        src->AddAgentsToPool(peds_without_place);
+    }
+    return peds_without_place.empty();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "geometry/Point.hpp"
+#include "geometry/SegmentIndex.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+class AgentsSource;
+class Building;
+class Pedestrian;
+class SubRoom;
+
+/**
+ * \class BestCandidateSampler
+ *
+ * \brief Places agents in a subroom with Mitchell's best candidate algorithm.
+ *
+ * For each agent a few random candidates are drawn and the one farthest from the agents placed
+ * so far is taken. Agents and walls are kept in spatial hashes, so placing an agent costs a
+ * constant number of lookups instead of a Voronoi diagram of all agents.
+ */
+class BestCandidateSampler
+{
+public:
+    /**
+     * @param subroom subroom to place the agents in
+     * @param boundaries x_min, x_max, y_min and y_max of the area to place the agents in
+     * @param generator random generator drawing the candidates
+     */
+    BestCandidateSampler(
+        const SubRoom& subroom,
+        const std::vector<float>& boundaries,
+        std::mt19937& generator);
+
+    /**
+     * Adds an agent the next agents keep their distance to.
+     * @param position position of the agent
+     */
+    void AddAgent(const Point& position);
+
+    /**
+     * Finds a position for an agent and adds the agent there.
+     * @param radius radius of the agent
+     * @param greedy if the candidate farthest from the other agents is taken, otherwise
+     * candidates are taken with a probability proportional to their squared distance
+     * @return position of the agent, no value if no candidate is farther than two radii from the
+     * other agents and far enough from walls and doors
+     */
+    std::optional<Point> Place(double radius, bool greedy);
+
+private:
+    using CellKey = std::int64_t;
+
+    /// @return if an agent with \p radius at \p position stays clear of walls and doors
+    bool IsValid(const Point& position, double radius) const;
+
+    /// @return distance to the closest agent, at most _maxDistance
+    double DistanceToAgents(const Point& position) const;
+
+    std::int64_t CellIndex(double coordinate) const;
+    static CellKey Key(std::int64_t i, std::int64_t j);
+
+    const SubRoom& _subroom;
+    std::mt19937& _generator;
+    double _xMin;
+    double _xMax;
+    double _yMin;
+    double _yMax;
+    SegmentIndex _walls;
+    SegmentIndex _doors;
+    /// candidates farther from all agents than this are equally good
+    double _maxDistance{2.};
+    std::unordered_map<CellKey, std::vector<Point>> _agents;
+};
+
+/**
+ * Positions incoming pedestrians with the best candidate algorithm in the subroom of their
+ * source. Pedestrians which find no place are removed from \p peds and put back into the pool
+ * of \p src.
+ * @param src source of the pedestrians
+ * @param peds pedestrians to place
+ * @param building building of the source
+ * @param peds_queue pedestrians placed before in this time step
+ * @return true if all pedestrians found a place
+ */
+bool ComputeBestPositionBestCandidate(
+    AgentsSource* src,
+    std::vector<Pedestrian*>& peds,
+    Building* building,
+    std::vector<Pedestrian*>& peds_queue);
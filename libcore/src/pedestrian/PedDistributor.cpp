@@ -28,12 +28,19 @@
 
 #include "IO/PedDistributionParser.hpp"
 #include "general/Filesystem.hpp"
+#include "geometry/Obstacle.hpp"
+#include "geometry/SegmentIndex.hpp"
 #include "geometry/SubRoom.hpp"
 #include "geometry/Wall.hpp"
 #include "pedestrian/Pedestrian.hpp"
 
 #include <Logger.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <limits>
+#include <thread>
+#include <tuple>
 
 PedDistributor::PedDistributor(
     const Configuration* configuration,
@@ -57,7 +64,7 @@ const std::vector<std::shared_ptr<AgentsSource>>& PedDistributor::GetAgentsSourc
     return _start_dis_sources;
 }
 
-bool PedDistributor::Distribute(Building* building) const
+bool PedDistributor::Distribute(Building* building, std::size_t maxThreads) const
 {
     LOG_INFO("Init Distribute");
     int nPeds_is = 0;
@@ -65,6 +72,8 @@ bool PedDistributor::Distribute(Building* building) const
 
     // store the position in a map since we are not computing for all rooms/subrooms.
     std::map<int, std::map<int, std::vector<Point>>> allFreePos;
+    // subrooms whose positions are computed, with the distribution shuffling them
+    std::vector<std::tuple<int, const SubRoom*, StartDistribution*>> pending;
 
     // collect the available positions for that subroom
     for(const auto& dist : _start_dis_sub) {
@@ -84,11 +93,8 @@ bool PedDistributor::Distribute(Building* building) const
         if(allFreePosRoom.count(subroomID) > 0) {
             continue;
         }
-
-        auto possibleSubroomPositions = PossiblePositions(*sr);
-        shuffle(
-            possibleSubroomPositions.begin(), possibleSubroomPositions.end(), dist->GetGenerator());
-        allFreePosRoom[subroomID] = possibleSubroomPositions;
+        allFreePosRoom[subroomID];
+        pending.emplace_back(roomID, sr, dist.get());
     } // for sub_dis
 
     // collect the available positions for that room
@@ -106,13 +112,37 @@ bool PedDistributor::Distribute(Building* building) const
             // the positions were already computed
             if(allFreePosRoom.count(subroomID) > 0)
                 continue;
-            auto possibleSubroomPositions = PossiblePositions(*it_sr.second);
-            shuffle(
-                possibleSubroomPositions.begin(),
-                possibleSubroomPositions.end(),
-                dist->GetGenerator());
-            allFreePosRoom[subroomID] = possibleSubroomPositions;
+            allFreePosRoom[subroomID];
+            pending.emplace_back(roomID, it_sr.second.get(), dist.get());
+        }
+    }
+
+    // the subrooms are independent, their positions are computed concurrently
+    std::vector<std::vector<Point>> positions(pending.size());
+    std::atomic<std::size_t> nextJob{0};
+    const auto work = [this, &pending, &positions, &nextJob]() {
+        for(std::size_t job = nextJob++; job < pending.size(); job = nextJob++) {
+            positions[job] = PossiblePositions(*std::get<1>(pending[job]));
         }
+    };
+    if(maxThreads == 0) {
+        maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const std::size_t threads = std::min(maxThreads, pending.size());
+    std::vector<std::thread> workers;
+    for(std::size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for(auto& worker : workers) {
+        worker.join();
+    }
+
+    // shuffle in the order of the distributions, so the positions do not depend on the threads
+    for(std::size_t job = 0; job < pending.size(); ++job) {
+        auto [roomID, sr, dist] = pending[job];
+        shuffle(positions[job].begin(), positions[job].end(), dist->GetGenerator());
+        allFreePos[roomID][sr->GetSubRoomID()] = std::move(positions[job]);
     }
 
     // now proceed to the distribution
@@ -403,73 +433,91 @@ std::vector<Point> PedDistributor::PossiblePositions(const SubRoom& r) const
     } else if(*max_x - *min_x < uni) {
         all_positions = PositionsOnFixX(*min_x, *max_x, *min_y, *max_y, r, bufx, bufy, max_size);
     } else {
-        // create the grid
+        // walls, doors and obstacles closer than max_buf reject a position
+        SegmentIndex barriers(std::max(max_buf, 0.5));
+        for(const auto& w : r.GetAllWalls()) {
+            barriers.Insert(w);
+        }
+        for(const auto& t : r.GetAllTransitions()) {
+            barriers.Insert(*t);
+        }
+        for(const auto& c : r.GetAllCrossings()) {
+            barriers.Insert(*c);
+        }
+        // bounding boxes of the obstacles, Obstacle::Contains is only called within them
+        struct ObstacleBox {
+            const Obstacle* obstacle;
+            double minX, maxX, minY, maxY;
+        };
+        std::vector<ObstacleBox> obstacleBoxes;
+        for(const auto& obst : r.GetAllObstacles()) {
+            ObstacleBox box{
+                obst,
+                std::numeric_limits<double>::max(),
+                std::numeric_limits<double>::lowest(),
+                std::numeric_limits<double>::max(),
+                std::numeric_limits<double>::lowest()};
+            for(const auto& wall : obst->GetAllWalls()) {
+                barriers.Insert(wall);
+                for(const Point& p : {wall.GetPoint1(), wall.GetPoint2()}) {
+                    box.minX = std::min(box.minX, p.x);
+                    box.maxX = std::max(box.maxX, p.x);
+                    box.minY = std::min(box.minY, p.y);
+                    box.maxY = std::max(box.maxY, p.y);
+                }
+            }
+            obstacleBoxes.push_back(box);
+        }
+
+        // create the grid, each column is rasterized with the intersections of the polygon
+        // edges. The edges are walls or doors, so positions far enough from the barriers lie
+        // strictly inside or outside of the polygon.
+        std::vector<double> crossings;
+        std::vector<ObstacleBox> columnObstacles;
         double x = (*min_x);
         while(x < *max_x) {
+            columnObstacles.clear();
+            for(const auto& box : obstacleBoxes) {
+                if(box.minX <= x && x <= box.maxX) {
+                    columnObstacles.push_back(box);
+                }
+            }
+            crossings.clear();
+            for(std::size_t i = 0; i < poly.size(); ++i) {
+                const Point& p1 = poly[i];
+                const Point& p2 = poly[(i + 1) % poly.size()];
+                if((p1.x <= x) != (p2.x <= x)) {
+                    crossings.push_back(p1.y + (x - p1.x) * (p2.y - p1.y) / (p2.x - p1.x));
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            std::size_t crossing = 0;
             double y = (*min_y);
             while(y < *max_y) {
                 y += max_size;
                 Point pos = Point(x, y);
-                bool tooNear = false;
 
                 // skip if the position is not in the polygon
-                if(!r.IsInSubRoom(pos))
-                    continue;
-
-                // check the distance to all Walls
-                for(const auto& w : r.GetAllWalls()) {
-                    if(w.DistTo(pos) < max_buf) {
-                        tooNear = true;
-                        break; // too close
-                    }
+                while(crossing < crossings.size() && crossings[crossing] <= y) {
+                    ++crossing;
                 }
-
-                // check the distance to all transitions
-                if(tooNear == true)
+                if(crossing % 2 == 0)
                     continue;
-                for(const auto& t : r.GetAllTransitions()) {
-                    if(t->DistTo(pos) < max_buf) {
-                        // too close
-                        tooNear = true;
-                        break;
-                    }
-                }
 
-                //  and check the distance to all crossings
-                if(tooNear == true)
+                // check the distance to all walls, transitions, crossings and obstacles
+                if(barriers.IsCloserThan(pos, max_buf))
                     continue;
-                for(const auto& c : r.GetAllCrossings()) {
-                    if(c->DistTo(pos) < max_buf) {
-                        // too close
-                        tooNear = true;
-                        break;
-                    }
-                }
 
-                // and finally the distance to all opened obstacles
-                if(tooNear == true)
+                // and finally skip positions in obstacles
+                if(std::any_of(
+                       columnObstacles.begin(), columnObstacles.end(), [&pos](const auto& box) {
+                           return box.minY <= pos.y && pos.y <= box.maxY &&
+                                  box.obstacle->Contains(pos);
+                       }))
                     continue;
 
-                for(const auto& obst : r.GetAllObstacles()) {
-                    for(const auto& wall : obst->GetAllWalls()) {
-                        if(wall.DistTo(pos) < max_buf) {
-                            tooNear = true;
-                            break; // too close
-                        }
-                    }
-
-                    // only continue if...
-                    if(tooNear == true)
-                        continue;
-
-                    if(obst->Contains(pos)) {
-                        tooNear = true;
-                        break; // too close
-                    }
-                }
-
-                if(tooNear == false)
-                    all_positions.push_back(pos);
+                all_positions.push_back(pos);
             }
             x += max_size;
         }
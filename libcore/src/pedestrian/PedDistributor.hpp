@@ -32,6 +32,7 @@
 #include "geometry/Building.hpp"
 #include "routing/Router.hpp"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -80,7 +81,10 @@ public:
     virtual ~PedDistributor();
 
     /**
-     * Return the possible positions for distributing the agents in the subroom
+     * Return the possible positions for distributing the agents in the subroom.
+     * The grid is rasterized column by column against the polygon of the subroom, the distance
+     * to walls, doors and obstacles is checked with a spatial index. The function only reads
+     * the subroom, so several subrooms can be processed concurrently.
      */
     std::vector<Point> PossiblePositions(const SubRoom& r) const;
 
@@ -96,9 +100,12 @@ public:
     /**
      *
      *Distribute all agents based on the configuration (ini) file
+     * The possible positions of the subrooms are computed concurrently, the result does not
+     * depend on the number of threads.
+     * @param maxThreads upper bound of the threads used, 0 for the number of hardware threads
      * @return true if everything went fine
      */
-    bool Distribute(Building* building) const;
+    bool Distribute(Building* building, std::size_t maxThreads = 0) const;
 
     /**
      * provided for convenience
@@ -30,12 +30,46 @@
 #include "geometry/Line.hpp"
 #include "geometry/SubRoom.hpp"
 #include "geometry/WaitingArea.hpp"
+#include "util/ObjectPool.hpp"
 
 #include <Logger.hpp>
 #include <cassert>
 
 double Pedestrian::_minPremovementTime = std::numeric_limits<double>::max();
 
+namespace
+{
+jps::ObjectPool<Pedestrian>& Pool()
+{
+    // never destroyed, agents may be released during static destruction
+    static auto* pool = new jps::ObjectPool<Pedestrian>();
+    return *pool;
+}
+} // namespace
+
+void* Pedestrian::operator new(std::size_t size)
+{
+    if(size != sizeof(Pedestrian)) {
+        return ::operator new(size);
+    }
+    return Pool().Allocate();
+}
+
+void Pedestrian::operator delete(void* ptr, std::size_t size)
+{
+    if(size != sizeof(Pedestrian)) {
+        ::operator delete(ptr);
+        return;
+    }
+    Pool().Deallocate(ptr);
+}
+
+std::shared_ptr<const PedestrianProfile> Pedestrian::DefaultProfile()
+{
+    static const auto profile = std::make_shared<const PedestrianProfile>();
+    return profile;
+}
+
 bool Pedestrian::InPremovement(double now)
 {
     return _premovement >= now;
@@ -45,9 +79,9 @@ double Pedestrian::SelectV0(SubroomType type, double delta) const
 {
     switch(type) {
         case SubroomType::ESCALATOR_UP:
-            return _v0EscalatorUpStairs + _building->GetSubRoom(GetPos())->GetEscalatorSpeed();
+            return _v0EscalatorUpStairs + _subRoom->GetEscalatorSpeed();
         case SubroomType::ESCALATOR_DOWN:
-            return _v0EscalatorDownStairs + _building->GetSubRoom(GetPos())->GetEscalatorSpeed();
+            return _v0EscalatorDownStairs + _subRoom->GetEscalatorSpeed();
         case SubroomType::STAIR:
             if(fabs(delta) < 1)
                 return std::max(0., _ellipse.GetV0());
@@ -67,11 +101,11 @@ double Pedestrian::SelectSmoothFactor(SubroomType type, double delta) const
 {
     switch(type) {
         case SubroomType::ESCALATOR_UP:
-            return _smoothFactorEscalatorUpStairs;
+            return _profile->smoothFactorEscalatorUpStairs;
         case SubroomType::ESCALATOR_DOWN:
-            return _smoothFactorEscalatorDownStairs;
+            return _profile->smoothFactorEscalatorDownStairs;
         case SubroomType::STAIR:
-            return (delta < 0) ? _smoothFactorDownStairs : _smoothFactorUpStairs;
+            return (delta < 0) ? _profile->smoothFactorDownStairs : _profile->smoothFactorUpStairs;
         case SubroomType::FLOOR:
         case SubroomType::CORRIDOR:
         case SubroomType::ENTRANCE:
@@ -118,24 +152,14 @@ void Pedestrian::SetV(const Point& v)
     _ellipse.SetV(v);
 }
 
-void Pedestrian::SetSmoothFactorUpStairs(double c)
+void Pedestrian::SetProfile(std::shared_ptr<const PedestrianProfile> profile)
 {
-    _smoothFactorUpStairs = c;
+    _profile = std::move(profile);
 }
 
-void Pedestrian::SetSmoothFactorDownStairs(double c)
+const std::shared_ptr<const PedestrianProfile>& Pedestrian::GetProfile() const
 {
-    _smoothFactorDownStairs = c;
-}
-
-void Pedestrian::SetSmoothFactorEscalatorUpStairs(double c)
-{
-    _smoothFactorEscalatorUpStairs = c;
-}
-
-void Pedestrian::SetSmoothFactorEscalatorDownStairs(double c)
-{
-    _smoothFactorEscalatorDownStairs = c;
+    return _profile;
 }
 
 void Pedestrian::SetV0Norm(
@@ -163,7 +187,7 @@ Pedestrian::UID Pedestrian::GetUID() const
 
 double Pedestrian::GetMass() const
 {
-    return _mass;
+    return _profile->mass;
 }
 
 double Pedestrian::GetTau() const
@@ -195,8 +219,7 @@ const Line& Pedestrian::GetExitLine() const
 
 int Pedestrian::GetUniqueRoomID() const
 {
-    auto [room_id, sub_room_id, _] = _building->GetRoomAndSubRoomIDs(GetPos());
-    return room_id * 1000 + sub_room_id;
+    return _subRoom->GetRoomID() * 1000 + _subRoom->GetSubRoomID();
 }
 
 Point Pedestrian::GetLastE0() const
@@ -229,7 +252,7 @@ double Pedestrian::GetV0Norm() const
     // @todo: we need to know the difference of the ped_elevation to the old_nav_elevation, and use
     // this in the function f.
     // detect the walking direction based on the elevation
-    SubRoom* sub = _building->GetSubRoom(GetPos());
+    SubRoom* sub = _subRoom;
     double ped_elevation = sub->GetElevation(_ellipse.GetCenter());
     const Point& target = _navLine.GetCentre();
     double nav_elevation = sub->GetElevation(target);
@@ -362,24 +385,24 @@ double Pedestrian::GetV0EscalatorDownNorm() const
 
 double Pedestrian::GetSmoothFactorUpStairs() const
 {
-    return _smoothFactorUpStairs;
+    return _profile->smoothFactorUpStairs;
 }
 double Pedestrian::GetSmoothFactorDownStairs() const
 {
-    return _smoothFactorDownStairs;
+    return _profile->smoothFactorDownStairs;
 }
 double Pedestrian::GetSmoothFactorUpEscalators() const
 {
-    return _smoothFactorEscalatorUpStairs;
+    return _profile->smoothFactorEscalatorUpStairs;
 }
 double Pedestrian::GetSmoothFactorDownEscalators() const
 {
-    return _smoothFactorEscalatorDownStairs;
+    return _profile->smoothFactorEscalatorDownStairs;
 }
 
 double Pedestrian::GetElevation() const
 {
-    return _building->GetSubRoom(GetPos())->GetElevation(GetPos());
+    return _subRoom->GetElevation(GetPos());
 }
 
 void Pedestrian::SetPremovementTime(double pretime)
@@ -410,6 +433,22 @@ void Pedestrian::SetBuilding(Building* building)
     _building = building;
 }
 
+void Pedestrian::UpdateRoom(Room* room, SubRoom* subroom)
+{
+    _room = room;
+    _subRoom = subroom;
+}
+
+Room* Pedestrian::GetRoom() const
+{
+    return _room;
+}
+
+SubRoom* Pedestrian::GetSubRoom() const
+{
+    return _subRoom;
+}
+
 int Pedestrian::GetLastGoalID() const
 {
     return _lastGoalID;
@@ -457,6 +496,37 @@ void Pedestrian::EndWaiting()
     _waitingPos.y = std::numeric_limits<double>::max();
 }
 
+void Pedestrian::SetRouteDecision(int subRoomUID, std::size_t routesVersion, int target)
+{
+    _routedSubRoomUID = subRoomUID;
+    _routedFinalDestination = _desiredFinalDestination;
+    _routedVersion = routesVersion;
+    _routedTarget = target;
+}
+
+int Pedestrian::GetRouteDecision(int subRoomUID, std::size_t routesVersion) const
+{
+    if(subRoomUID != _routedSubRoomUID || _desiredFinalDestination != _routedFinalDestination ||
+       routesVersion != _routedVersion) {
+        return FINAL_DEST_OUT;
+    }
+    return _routedTarget;
+}
+
+void Pedestrian::SetDirectionTarget(std::size_t step, const Point& target)
+{
+    _directionStep = step;
+    _directionTarget = target;
+}
+
+std::optional<Point> Pedestrian::GetDirectionTarget(std::size_t step) const
+{
+    if(step != _directionStep) {
+        return std::nullopt;
+    }
+    return _directionTarget;
+}
+
 const Point& Pedestrian::GetWaitingPos() const
 {
     return _waitingPos;
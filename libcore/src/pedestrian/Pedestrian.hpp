@@ -28,15 +28,20 @@
 
 #include "AgentsParameters.hpp"
 #include "Ellipse.hpp"
+#include "PedestrianProfile.hpp"
 #include "general/Macros.hpp"
 #include "geometry/Line.hpp"
 #include "geometry/SubroomType.hpp"
 #include "util/UniqueID.hpp"
 
 #include <map>
+#include <memory>
+#include <optional>
 
 class Building;
+class Room;
 class Router;
+class SubRoom;
 class WalkingSpeed;
 class Pedestrian
 {
@@ -53,7 +58,6 @@ private:
     double _premovement = 0;
 
     // gcfm specific parameters
-    double _mass = 1; // Mass: 1
     double _tau = 0.5; // Reaction time: 0.5
     double _t = 1.0; // OV function
 
@@ -65,14 +69,8 @@ private:
     double _v0DownStairs = 0.6;
     double _v0EscalatorUpStairs = 0.8;
     double _v0EscalatorDownStairs = 0.8;
-    /// c in f() and g() for v0 transition on stairs up
-    double _smoothFactorUpStairs = 15;
-    /// c in f() and g() for v0 transition on stairs down
-    double _smoothFactorDownStairs = 15;
-    /// c in f() and g() for v0 transition on escalators up
-    double _smoothFactorEscalatorUpStairs = 15;
-    /// c in f() and g() for v0 transition on escalators down
-    double _smoothFactorEscalatorDownStairs = 15;
+    /// parameters shared with the other agents of the parameter set
+    std::shared_ptr<const PedestrianProfile> _profile{DefaultProfile()};
     int _router_id{0};
     Point _lastE0 = Point(0, 0);
 
@@ -86,17 +84,35 @@ private:
 
     /// a pointer to the complete building
     Building* _building = nullptr;
+    /// room and subroom the pedestrian is in, updated by the simulation after every step
+    Room* _room = nullptr;
+    SubRoom* _subRoom = nullptr;
 
     int _lastGoalID = -1;
     bool _insideGoal = false;
     bool _waiting = false;
+    /// subroom UID, final destination, routes version and target of the last route decision
+    int _routedSubRoomUID = -1;
+    int _routedFinalDestination = FINAL_DEST_OUT;
+    std::size_t _routedVersion = 0;
+    int _routedTarget = FINAL_DEST_OUT;
+    /// desired direction computed for all walking pedestrians in time step _directionStep
+    Point _directionTarget;
+    std::size_t _directionStep = 0;
     Point _waitingPos =
         Point(std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
 
+    /// @return profile of agents created without a parameter set
+    static std::shared_ptr<const PedestrianProfile> DefaultProfile();
+
 public:
     Pedestrian() = default;
     ~Pedestrian() = default;
 
+    /// agents are allocated from a jps::ObjectPool, this keeps the agents close in memory
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size);
+
     bool InPremovement(double now);
 
     /**
@@ -115,10 +131,12 @@ public:
      * Nearly zero for horizontal movement.
      */
     double SelectSmoothFactor(SubroomType type, double delta) const;
-    void SetSmoothFactorUpStairs(double c);
-    void SetSmoothFactorDownStairs(double c);
-    void SetSmoothFactorEscalatorUpStairs(double c);
-    void SetSmoothFactorEscalatorDownStairs(double c);
+    /**
+     * Sets the parameters shared with the other agents of the parameter set.
+     * @param profile shared parameters, must not be null
+     */
+    void SetProfile(std::shared_ptr<const PedestrianProfile> profile);
+    const std::shared_ptr<const PedestrianProfile>& GetProfile() const;
     void SetTau(double tau);
     void SetEllipse(const JEllipse& e);
     void SetRouterId(int id) { _router_id = id; }
@@ -228,6 +246,23 @@ public:
      */
     void SetBuilding(Building* building);
 
+    /**
+     * Sets the room and subroom the pedestrian is in.
+     * @param room room containing the position, nullptr if the pedestrian left the geometry
+     * @param subroom subroom containing the position, nullptr if the pedestrian left the geometry
+     */
+    void UpdateRoom(Room* room, SubRoom* subroom);
+
+    /**
+     * @return the room the pedestrian was located in by the last call of UpdateRoom()
+     */
+    Room* GetRoom() const;
+
+    /**
+     * @return the subroom the pedestrian was located in by the last call of UpdateRoom()
+     */
+    SubRoom* GetSubRoom() const;
+
     void EnterGoal();
 
     void LeaveGoal();
@@ -245,6 +280,36 @@ public:
     void StartWaiting();
     void EndWaiting();
 
+    /**
+     * Stores the target the router chose for this pedestrian.
+     * @param subRoomUID UID of the subroom the pedestrian was in
+     * @param routesVersion version of the routes of the router, see Router::GetRoutesVersion()
+     * @param target UID of the chosen door, FINAL_DEST_OUT if none was found
+     */
+    void SetRouteDecision(int subRoomUID, std::size_t routesVersion, int target);
+
+    /**
+     * Returns the target of the last route decision if it is still valid, i.e. it was made in
+     * the same subroom for the current final destination on the current routes of the router.
+     * @param subRoomUID UID of the subroom the pedestrian is in
+     * @param routesVersion version of the routes of the router, see Router::GetRoutesVersion()
+     * @return UID of the door, FINAL_DEST_OUT if the route has to be decided again
+     */
+    int GetRouteDecision(int subRoomUID, std::size_t routesVersion) const;
+
+    /**
+     * Stores the desired direction computed for all walking pedestrians in one batch.
+     * @param step time step of the DirectionManager the direction is computed in
+     * @param target desired direction
+     */
+    void SetDirectionTarget(std::size_t step, const Point& target);
+
+    /**
+     * @param step current time step of the DirectionManager
+     * @return desired direction stored in \p step, nullopt if none was computed in this step
+     */
+    std::optional<Point> GetDirectionTarget(std::size_t step) const;
+
     Point GetLastPosition() const;
 };
 
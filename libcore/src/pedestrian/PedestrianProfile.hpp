@@ -0,0 +1,21 @@
+#pragma once
+
+/**
+ * \struct PedestrianProfile
+ *
+ * \brief Parameters which are equal for all agents of a parameter set.
+ *
+ * A profile is created once per AgentsParameters and shared by its agents, it is never changed
+ * after creation. Values drawn for each agent, like the desired speeds, stay in Pedestrian.
+ */
+struct PedestrianProfile {
+    double mass = 1;
+    /// c in f() and g() for v0 transition on stairs up
+    double smoothFactorUpStairs = 15;
+    /// c in f() and g() for v0 transition on stairs down
+    double smoothFactorDownStairs = 15;
+    /// c in f() and g() for v0 transition on escalators up
+    double smoothFactorEscalatorUpStairs = 15;
+    /// c in f() and g() for v0 transition on escalators down
+    double smoothFactorEscalatorDownStairs = 15;
+};
@@ -50,11 +50,8 @@ StartDistribution::StartDistribution(int seed)
     _yMin = -FLT_MAX;
     _yMax = FLT_MAX;
     _groupParameters = nullptr;
-    static bool _seeded = false; // seed only once, not every time
-    if(!_seeded) {
-        _generator = std::default_random_engine(seed);
-        _seeded = true;
-    }
+    // each distribution is seeded, not only the first one created in the process
+    _generator = std::default_random_engine(seed);
 }
 
 StartDistribution::~StartDistribution()
@@ -178,10 +175,7 @@ Pedestrian* StartDistribution::GenerateAgent(Building* building, std::vector<Poi
         _groupParameters->GetV0DownStairs(),
         _groupParameters->GetEscalatorUpStairs(),
         _groupParameters->GetEscalatorDownStairs());
-    ped->SetSmoothFactorEscalatorUpStairs(_groupParameters->_smoothFactorEscalatorUpStairs);
-    ped->SetSmoothFactorEscalatorDownStairs(_groupParameters->_smoothFactorEscalatorDownStairs);
-    ped->SetSmoothFactorUpStairs(_groupParameters->_smoothFactorUpStairs);
-    ped->SetSmoothFactorDownStairs(_groupParameters->_smoothFactorDownStairs);
+    ped->SetProfile(_groupParameters->GetProfile());
 
     // first default Position
     int index = -1;
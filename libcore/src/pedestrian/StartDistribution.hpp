@@ -64,7 +64,6 @@ private:
     // pre movement time distribution
     mutable std::normal_distribution<double> _premovementTime;
 
-    static bool seeded;
     // random number generator engine
     mutable std::default_random_engine _generator;
 
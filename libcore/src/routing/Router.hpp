@@ -25,6 +25,9 @@
 #include "geometry/Building.hpp"
 #include "pedestrian/Pedestrian.hpp"
 
+#include <cstddef>
+#include <set>
+
 class Simulation;
 
 /// Abstract base class for all routers.
@@ -35,6 +38,7 @@ class Router
 protected:
     double _currentTime{0.0};
     Simulation* _simulation{nullptr};
+    std::size_t _routesVersion{0};
 
     Router() = default;
 
@@ -47,10 +51,20 @@ protected:
 public:
     virtual ~Router() = default;
 
-    void UpdateTime(double time) { _currentTime = time; }
+    /// Called once at the beginning of every simulation step.
+    /// @param time current time in simulation
+    virtual void UpdateTime(double time) { _currentTime = time; }
 
     void SetSimulation(Simulation* simulation) { _simulation = simulation; }
 
+    /// Marks the routes found so far as outdated, e.g. after the router was updated.
+    void MarkRoutesChanged() { ++_routesVersion; }
+
+    /// Version of the routes of this router, it changes whenever previously found routes may
+    /// have become outdated. Agents decide their route again when it changes.
+    /// @return version of the routes
+    std::size_t GetRoutesVersion() const { return _routesVersion; }
+
     /// Find the next suitable target for Pedestrian p.
     /// @post (*p).exitline/.exitindex are set (important!)
     /// @param p the Pedestrian
@@ -59,4 +73,15 @@ public:
 
     /// Update the router, when geometry changed due to external changes.
     virtual void Update() = 0;
+
+    /// Update the router after only some doors or rooms changed.
+    /// Routers without support for partial updates perform a full Update().
+    /// @param changedDoors UIDs of the doors whose state changed
+    /// @param changedRooms IDs of the rooms whose geometry changed
+    virtual void UpdateIncremental(
+        const std::set<int>& /*changedDoors*/,
+        const std::set<int>& /*changedRooms*/)
+    {
+        Update();
+    }
 };
@@ -30,6 +30,7 @@
 #include "math/OperationalModel.hpp"
 #include "pedestrian/Pedestrian.hpp"
 #include "routing/RoutingStrategy.hpp"
+#include "routing/ff_router/HierarchicalRouter.hpp"
 #include "routing/ff_router/ffRouter.hpp"
 #include "routing/global_shortest/GlobalRouter.hpp"
 
@@ -41,14 +42,19 @@
 RoutingEngine::RoutingEngine(
     Configuration* config,
     Building* building,
-    DirectionManager* directionManager)
+    DirectionManager* directionManager,
+    FloorfieldRepository* floorfields)
 {
-    auto buildRouter =
-        [config, building, directionManager](const auto& strategy_info) -> std::unique_ptr<Router> {
+    auto buildRouter = [config, building, directionManager, floorfields](
+                           const auto& strategy_info) -> std::unique_ptr<Router> {
         const auto& [strategy, parameters] = strategy_info;
         switch(strategy) {
             case RoutingStrategy::ROUTING_FF_GLOBAL_SHORTEST:
-                return std::make_unique<FFRouter>(config, building, directionManager);
+                return std::make_unique<FFRouter>(
+                    config, building, directionManager, floorfields);
+            case RoutingStrategy::ROUTING_FF_HIERARCHICAL:
+                return std::make_unique<HierarchicalRouter>(
+                    config, building, directionManager, floorfields);
             case RoutingStrategy::ROUTING_GLOBAL_SHORTEST:
                 return std::make_unique<GlobalRouter>(building, *parameters);
             case RoutingStrategy::UNKNOWN:
@@ -92,7 +98,7 @@ Router* RoutingEngine::GetRouter(int id) const
 
 bool RoutingEngine::NeedsUpdate() const
 {
-    return _needUpdate;
+    return _needUpdate || !_changedDoors.empty() || !_changedRooms.empty();
 }
 
 void RoutingEngine::setNeedUpdate(bool needUpdate)
@@ -100,10 +106,27 @@ void RoutingEngine::setNeedUpdate(bool needUpdate)
     _needUpdate = needUpdate;
 }
 
+void RoutingEngine::MarkDoorChanged(int doorUID)
+{
+    _changedDoors.insert(doorUID);
+}
+
+void RoutingEngine::MarkRoomChanged(int roomID)
+{
+    _changedRooms.insert(roomID);
+}
+
 void RoutingEngine::UpdateRouter()
 {
     for(auto&& [_, r] : _routers) {
-        r->Update();
+        if(_needUpdate) {
+            r->Update();
+        } else {
+            r->UpdateIncremental(_changedDoors, _changedRooms);
+        }
+        r->MarkRoutesChanged();
     }
     _needUpdate = false;
+    _changedDoors.clear();
+    _changedRooms.clear();
 }
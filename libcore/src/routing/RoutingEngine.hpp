@@ -31,19 +31,32 @@
 #include "math/OperationalModel.hpp"
 
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
+class FloorfieldRepository;
+
 class RoutingEngine
 {
     /// collections of all routers used
     std::map<int, std::unique_ptr<Router>> _routers{};
 
-    /// states if the routers need to be updated
+    /// states if the routers need a full update
     bool _needUpdate{false};
 
+    /// UIDs of doors whose state changed since the last update
+    std::set<int> _changedDoors{};
+
+    /// IDs of rooms whose geometry changed since the last update
+    std::set<int> _changedRooms{};
+
 public:
-    RoutingEngine(Configuration* config, Building* building, DirectionManager* directionManager);
+    RoutingEngine(
+        Configuration* config,
+        Building* building,
+        DirectionManager* directionManager,
+        FloorfieldRepository* floorfields);
     ~RoutingEngine() = default;
 
     RoutingEngine(const RoutingEngine&) = delete;
@@ -74,7 +87,19 @@ public:
     void setNeedUpdate(bool needUpdate);
 
     /**
-     * Updates all used routers
+     * Marks the state of a door as changed, routers will be updated incrementally
+     * @param doorUID unique ID of the door
+     */
+    void MarkDoorChanged(int doorUID);
+
+    /**
+     * Marks the geometry of a room as changed, routers will be updated incrementally
+     * @param roomID ID of the room
+     */
+    void MarkRoomChanged(int roomID);
+
+    /**
+     * Updates all used routers, incrementally if only doors or rooms were marked as changed
      */
     void UpdateRouter();
 };
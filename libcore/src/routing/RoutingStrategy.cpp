@@ -11,5 +11,8 @@ RoutingStrategy from_string<RoutingStrategy>(const std::string& string)
     if(string == "ff_global_shortest") {
         return RoutingStrategy::ROUTING_FF_GLOBAL_SHORTEST;
     }
+    if(string == "ff_hierarchical") {
+        return RoutingStrategy::ROUTING_FF_HIERARCHICAL;
+    }
     return RoutingStrategy::UNKNOWN;
 }
@@ -4,7 +4,12 @@
 
 #include <string>
 
-enum class RoutingStrategy { ROUTING_GLOBAL_SHORTEST, ROUTING_FF_GLOBAL_SHORTEST, UNKNOWN };
+enum class RoutingStrategy {
+    ROUTING_GLOBAL_SHORTEST,
+    ROUTING_FF_GLOBAL_SHORTEST,
+    ROUTING_FF_HIERARCHICAL,
+    UNKNOWN
+};
 
 template <>
 RoutingStrategy from_string<RoutingStrategy>(const std::string& string);
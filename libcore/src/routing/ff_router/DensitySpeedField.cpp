@@ -0,0 +1,163 @@
+#include "DensitySpeedField.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+/**
+ * @return normalized weights of a Gaussian with standard deviation \p sigma sampled every \p h,
+ * truncated at three standard deviations
+ */
+std::vector<double> GaussianKernel(double sigma, double h)
+{
+    if(sigma <= 0.) {
+        return {1.};
+    }
+    const auto radius = static_cast<long int>(std::ceil(3. * sigma / h));
+    std::vector<double> kernel(2 * radius + 1);
+    for(long int k = -radius; k <= radius; ++k) {
+        const double x = k * h / sigma;
+        kernel[k + radius] = std::exp(-0.5 * x * x);
+    }
+    const double sum = std::accumulate(kernel.begin(), kernel.end(), 0.);
+    for(double& weight : kernel) {
+        weight /= sum;
+    }
+    return kernel;
+}
+
+/**
+ * @return \p index reflected at the border of \p size grid points, the border lies half a grid
+ * spacing outside the first and last point, so the smoothing conserves the mass
+ */
+long int Reflect(long int index, long int size)
+{
+    if(index < 0) {
+        index = -index - 1;
+    } else if(index >= size) {
+        index = 2 * size - 1 - index;
+    }
+    // kernels wider than the grid are reflected only once
+    return std::clamp(index, 0L, size - 1);
+}
+} // namespace
+
+DensitySpeedField::DensitySpeedField(const RectGrid& grid, DensitySpeedParameters parameters)
+    : _grid(grid)
+    , _parameters(parameters)
+    , _kernelX(GaussianKernel(parameters.sigma, grid.Gethx()))
+    , _kernelY(GaussianKernel(parameters.sigma, grid.Gethy()))
+    , _density(grid.GetnPoints(), 0.)
+    , _buffer(grid.GetnPoints(), 0.)
+{
+}
+
+void DensitySpeedField::UpdateDensity(const std::vector<Point>& positions)
+{
+    const long int iMax = _grid.GetiMax();
+    const long int jMax = _grid.GetjMax();
+    const double hx = _grid.Gethx();
+    const double hy = _grid.Gethy();
+    const double mass = 1. / (hx * hy);
+
+    std::fill(_buffer.begin(), _buffer.end(), 0.);
+    bool empty = true;
+    for(const Point& pos : positions) {
+        if(!_grid.IncludesPoint(pos)) {
+            continue;
+        }
+        empty = false;
+        const double u = (pos.x - _grid.GetxMin()) / hx;
+        const double v = (pos.y - _grid.GetyMin()) / hy;
+        const long int i0 = std::clamp(static_cast<long int>(std::floor(u)), 0L, iMax - 1);
+        const long int j0 = std::clamp(static_cast<long int>(std::floor(v)), 0L, jMax - 1);
+        const long int i1 = std::min(i0 + 1, iMax - 1);
+        const long int j1 = std::min(j0 + 1, jMax - 1);
+        const double fx = std::clamp(u - i0, 0., 1.);
+        const double fy = std::clamp(v - j0, 0., 1.);
+        _buffer[j0 * iMax + i0] += (1. - fx) * (1. - fy) * mass;
+        _buffer[j0 * iMax + i1] += fx * (1. - fy) * mass;
+        _buffer[j1 * iMax + i0] += (1. - fx) * fy * mass;
+        _buffer[j1 * iMax + i1] += fx * fy * mass;
+    }
+
+    if(empty) {
+        std::fill(_density.begin(), _density.end(), 0.);
+        return;
+    }
+    Smooth(_buffer, _density, true);
+    Smooth(_density, _buffer, false);
+    std::swap(_density, _buffer);
+}
+
+const std::vector<double>& DensitySpeedField::Density() const
+{
+    return _density;
+}
+
+void DensitySpeedField::ApplyFundamentalDiagram(const double* freeSpeed, double* speed) const
+{
+    for(std::size_t key = 0; key < _density.size(); ++key) {
+        speed[key] = freeSpeed[key] * SpeedFactor(_density[key]);
+    }
+}
+
+double DensitySpeedField::SpeedFactor(double density) const
+{
+    if(density <= 0.) {
+        return 1.;
+    }
+    if(density >= _parameters.jamDensity) {
+        return _parameters.minSpeedFactor;
+    }
+    const double factor =
+        1. - std::exp(-_parameters.gamma * (1. / density - 1. / _parameters.jamDensity));
+    return std::max(_parameters.minSpeedFactor, factor);
+}
+
+void DensitySpeedField::Smooth(
+    const std::vector<double>& input,
+    std::vector<double>& output,
+    bool alongX) const
+{
+    const long int iMax = _grid.GetiMax();
+    const long int jMax = _grid.GetjMax();
+    const auto& kernel = alongX ? _kernelX : _kernelY;
+    const auto radius = static_cast<long int>(kernel.size() / 2);
+
+    if(alongX) {
+        for(long int j = 0; j < jMax; ++j) {
+            const double* in = input.data() + j * iMax;
+            double* out = output.data() + j * iMax;
+            for(long int i = 0; i < iMax; ++i) {
+                double sum = 0.;
+                if(i >= radius && i + radius < iMax) {
+                    for(long int k = -radius; k <= radius; ++k) {
+                        sum += kernel[k + radius] * in[i + k];
+                    }
+                } else {
+                    for(long int k = -radius; k <= radius; ++k) {
+                        sum += kernel[k + radius] * in[Reflect(i + k, iMax)];
+                    }
+                }
+                out[i] = sum;
+            }
+        }
+        return;
+    }
+
+    // rows are added as a whole, so the inner loop runs over contiguous memory
+    std::fill(output.begin(), output.end(), 0.);
+    for(long int j = 0; j < jMax; ++j) {
+        double* out = output.data() + j * iMax;
+        for(long int k = -radius; k <= radius; ++k) {
+            const double weight = kernel[k + radius];
+            const double* in = input.data() + Reflect(j + k, jMax) * iMax;
+            for(long int i = 0; i < iMax; ++i) {
+                out[i] += weight * in[i];
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "geometry/Point.hpp"
+#include "routing/ff_router/mesh/RectGrid.hpp"
+
+#include <vector>
+
+/**
+ * Parameters of the density estimation and of the fundamental diagram used by DensitySpeedField.
+ */
+struct DensitySpeedParameters {
+    /// standard deviation [m] of the Gaussian smoothing kernel, 0.5 m weights the agents as
+    /// strongly as a disc with a radius of 1 m
+    double sigma{0.5};
+    /// density [1/m^2] at which agents come to a halt
+    double jamDensity{5.4};
+    /// shape parameter of the fundamental diagram [1/m^2]
+    double gamma{1.913};
+    /// lower bound of the speed factor, agents are slowed down but never stopped, so fields
+    /// computed with the speed stay connected
+    double minSpeedFactor{0.1};
+};
+
+/**
+ * \class DensitySpeedField
+ *
+ * \brief Local walking speed on a RectGrid derived from the density of the agents.
+ *
+ * The density is estimated in two steps, both linear in their input:
+ * - rasterization: each agent adds its mass to the four grid points around its position
+ *   (bilinear weights), independent of the kernel size.
+ * - smoothing: the rasterized density is convolved with a truncated Gaussian, separately along x
+ *   and along y. Mass leaving the grid is reflected at its border.
+ *
+ * The density is converted to a speed factor by the fundamental diagram of Weidmann,
+ * v / v0 = 1 - exp(-gamma (1 / rho - 1 / rhoJam)).
+ *
+ * The buffers are kept between updates, repeated updates on the same grid do not allocate.
+ */
+class DensitySpeedField
+{
+public:
+    /**
+     * @param grid grid to compute the density and speed on
+     * @param parameters parameters of the density estimation and the fundamental diagram
+     */
+    explicit DensitySpeedField(const RectGrid& grid, DensitySpeedParameters parameters = {});
+
+    /**
+     * Estimates the density of agents at \p positions.
+     * @param positions positions of the agents, positions outside the grid are ignored.
+     */
+    void UpdateDensity(const std::vector<Point>& positions);
+
+    /**
+     * @return density [1/m^2] at each grid point, indexed by the key of the grid point
+     */
+    const std::vector<double>& Density() const;
+
+    /**
+     * Writes the speed at each grid point, the free speed scaled by the speed factor of the
+     * density at that point.
+     * @param freeSpeed speed without other agents at each grid point
+     * @param speed output, speed at each grid point
+     */
+    void ApplyFundamentalDiagram(const double* freeSpeed, double* speed) const;
+
+    /**
+     * @param density density [1/m^2]
+     * @return speed relative to the free speed at \p density, at least minSpeedFactor
+     */
+    double SpeedFactor(double density) const;
+
+private:
+    /**
+     * Convolves \p input with the smoothing kernel along x or y.
+     */
+    void Smooth(const std::vector<double>& input, std::vector<double>& output, bool alongX) const;
+
+    RectGrid _grid;
+    DensitySpeedParameters _parameters;
+    /// weights of the smoothing kernel from -radius to +radius grid points along x and y
+    std::vector<double> _kernelX;
+    std::vector<double> _kernelY;
+    std::vector<double> _density;
+    std::vector<double> _buffer;
+};
@@ -0,0 +1,97 @@
+#include "FloorfieldRepository.hpp"
+
+#include "UnivFFviaFM.hpp"
+#include "geometry/Room.hpp"
+
+#include <Logger.hpp>
+#include <algorithm>
+
+namespace
+{
+/// Fields with the same grid share the geometry and the wall distance field.
+bool SameGrid(const FloorfieldParameters& a, const FloorfieldParameters& b)
+{
+    if(a.hx != b.hx || a.useWallDistances != b.useWallDistances) {
+        return false;
+    }
+    return !a.useWallDistances || a.wallAvoidDistance == b.wallAvoidDistance;
+}
+
+/**
+ * A field computing directions also provides the distances. The lazy mode and the memory budget
+ * have to match, otherwise a user would get door fields evicted under a budget it did not ask for.
+ */
+bool Provides(const FloorfieldParameters& existing, const FloorfieldParameters& requested)
+{
+    return SameGrid(existing, requested) && existing.mode == requested.mode &&
+           existing.speedMode == requested.speedMode && existing.lazy == requested.lazy &&
+           existing.memoryBudget == requested.memoryBudget &&
+           (existing.user == requested.user || existing.user == DISTANCE_AND_DIRECTIONS_USED);
+}
+} // namespace
+
+std::shared_ptr<UnivFFviaFM>
+FloorfieldRepository::Get(Room* room, const FloorfieldParameters& parameters)
+{
+    std::lock_guard lock(_mutex);
+    auto& entries = _entries[room->GetID()];
+
+    // forget fields nobody uses anymore
+    entries.erase(
+        std::remove_if(
+            entries.begin(),
+            entries.end(),
+            [](const Entry& entry) { return entry.field.expired(); }),
+        entries.end());
+
+    std::shared_ptr<UnivFFviaFM> base;
+    for(const auto& entry : entries) {
+        auto field = entry.field.lock();
+        if(!field) {
+            continue;
+        }
+        if(Provides(entry.parameters, parameters)) {
+            return field;
+        }
+        if(!base && SameGrid(entry.parameters, parameters)) {
+            base = field;
+        }
+    }
+
+    std::shared_ptr<UnivFFviaFM> field;
+    if(base) {
+        LOG_DEBUG("Deriving floor field of room {:d} from existing grid.", room->GetID());
+        field = std::make_shared<UnivFFviaFM>(
+            *base, parameters.user, parameters.mode, parameters.speedMode);
+    } else {
+        field = std::make_shared<UnivFFviaFM>(
+            room, parameters.hx, parameters.wallAvoidDistance, parameters.useWallDistances);
+        field->SetUser(parameters.user);
+        field->SetMode(parameters.mode);
+        field->SetSpeedMode(parameters.speedMode);
+    }
+    field->SetLazy(parameters.lazy);
+    field->SetMemoryBudget(parameters.memoryBudget);
+    field->AddAllTargetsParallel();
+
+    entries.push_back({parameters, field});
+    return field;
+}
+
+void FloorfieldRepository::Invalidate(int roomID)
+{
+    std::lock_guard lock(_mutex);
+    _entries.erase(roomID);
+}
+
+std::size_t FloorfieldRepository::Size() const
+{
+    std::lock_guard lock(_mutex);
+    std::size_t size = 0;
+    for(const auto& [_, entries] : _entries) {
+        size += std::count_if(entries.begin(), entries.end(), [](const Entry& entry) {
+            return !entry.field.expired();
+        });
+    }
+    return size;
+}
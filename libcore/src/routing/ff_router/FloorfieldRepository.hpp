@@ -0,0 +1,98 @@
+#pragma once
+
+#include "general/Macros.hpp"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class Room;
+class UnivFFviaFM;
+
+/**
+ * Parameters a floor field of a room is computed with.
+ */
+struct FloorfieldParameters {
+    /// grid size
+    double hx{0.125};
+    /// wall avoidance distance, only relevant if \a useWallDistances is set
+    double wallAvoidDistance{0.};
+    /// compute the wall distance field
+    bool useWallDistances{false};
+    /// target mode (LINESEGMENT, CENTERPOINT)
+    int mode{LINESEGMENT};
+    /// user mode (DISTANCE_MEASUREMENTS_ONLY, DISTANCE_AND_DIRECTIONS_USED)
+    int user{DISTANCE_AND_DIRECTIONS_USED};
+    /// speed mode (FF_HOMO_SPEED, FF_WALL_AVOID, FF_PED_SPEED)
+    int speedMode{FF_HOMO_SPEED};
+    /// compute door floor fields on demand
+    bool lazy{false};
+    /// memory budget for the door floor fields of this field in bytes, 0 means unlimited
+    std::size_t memoryBudget{0};
+};
+
+/**
+ * Shared storage of the floor fields of all rooms.
+ *
+ * Floor field users (FFRouter, HierarchicalRouter, DirectionLocalFloorfield) request their
+ * fields here instead of constructing them. A field is computed once and shared by all users
+ * requesting it with compatible parameters. The repository only keeps weak references, a field is
+ * freed when its last user releases it.
+ *
+ * - A field computing directions also serves users only measuring distances.
+ * - All other parameters, including the lazy mode and the memory budget, have to be equal.
+ * - A new field on the same grid as an existing one (same room, grid size and wall settings)
+ *   copies the geometry and the wall distance field from it instead of recomputing them.
+ *
+ * The routers use CENTERPOINT fields with a grid size of 0.125 m, DirectionLocalFloorfield uses
+ * LINESEGMENT fields with the grid size delta_h (0.0625 m by default). The routers and the
+ * direction strategy therefore never share a field, and with the default delta_h not even the
+ * grid. Fields are only shared among the routers (FFRouter and HierarchicalRouter, also across
+ * router IDs) and among the direction strategies.
+ */
+class FloorfieldRepository
+{
+public:
+    FloorfieldRepository() = default;
+    ~FloorfieldRepository() = default;
+
+    FloorfieldRepository(const FloorfieldRepository&) = delete;
+    FloorfieldRepository& operator=(const FloorfieldRepository&) = delete;
+
+    FloorfieldRepository(FloorfieldRepository&&) = delete;
+    FloorfieldRepository& operator=(FloorfieldRepository&&) = delete;
+
+    /**
+     * Returns a floor field of \p room with all door floor fields computed (or available on
+     * demand in lazy mode).
+     * @param room room the floor field covers
+     * @param parameters parameters of the floor field
+     * @return shared floor field
+     */
+    std::shared_ptr<UnivFFviaFM> Get(Room* room, const FloorfieldParameters& parameters);
+
+    /**
+     * Drops all fields of a room after its geometry changed. Users still holding such a field
+     * keep it alive, but subsequent calls to Get() compute a new one.
+     * @param roomID ID of the room
+     */
+    void Invalidate(int roomID);
+
+    /**
+     * Returns the number of fields still alive.
+     * @return number of fields still used by at least one user
+     */
+    std::size_t Size() const;
+
+private:
+    struct Entry {
+        FloorfieldParameters parameters;
+        std::weak_ptr<UnivFFviaFM> field;
+    };
+
+    /// entries of each room
+    std::map<int, std::vector<Entry>> _entries;
+    mutable std::mutex _mutex;
+};
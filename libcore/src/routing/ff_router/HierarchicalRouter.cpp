@@ -0,0 +1,480 @@
+#include "HierarchicalRouter.hpp"
+
+#include "UnivFFviaFM.hpp"
+#include "direction/DirectionManager.hpp"
+#include "direction/walking/DirectionStrategy.hpp"
+#include "general/Configuration.hpp"
+#include "geometry/SubRoom.hpp"
+#include "geometry/WaitingArea.hpp"
+#include "pedestrian/Pedestrian.hpp"
+#include "routing/ff_router/mesh/RectGrid.hpp"
+
+#include <Logger.hpp>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+constexpr double unreachable = std::numeric_limits<double>::max();
+
+// The overlay is undirected, so the outside and goal vertices would connect their doors for
+// free. Their edges get a cost far above any walking distance instead: paths to a target pass
+// exactly one of them, paths using a target vertex as shortcut pass at least two.
+constexpr double connectorCost = 1e9;
+
+void AddUnique(std::vector<int>& values, int value)
+{
+    if(std::find(values.begin(), values.end(), value) == values.end()) {
+        values.push_back(value);
+    }
+}
+} // namespace
+
+HierarchicalRouter::HierarchicalRouter(
+    Configuration* config,
+    Building* building,
+    DirectionManager* directionManager,
+    FloorfieldRepository* floorfields)
+    : _config(config)
+    , _directionManager(directionManager)
+    , _building(building)
+    , _floorfields(floorfields)
+{
+    if(_config->hasDirectionalEscalators) {
+        LOG_WARNING("ffHierarchicalRouter: directional escalators are treated as bidirectional.");
+    }
+    Build();
+}
+
+void HierarchicalRouter::Build()
+{
+    CollectDoors();
+    std::size_t numDoorPairs = 0;
+    for(auto& [roomID, level] : _rooms) {
+        CalculateDoorDistances(roomID);
+        CalculateBoundaryDistances(level);
+        numDoorPairs += level.doorDistances.size() + level.boundaryDistances.size();
+    }
+    BuildOverlay();
+    LOG_INFO(
+        "ffHierarchicalRouter: {:d} doors in {:d} rooms, {:d} local distances, overlay with "
+        "{:d} transitions and {:d} targets.",
+        _doorByUID.size(),
+        _rooms.size(),
+        numDoorPairs,
+        _vertexByDoorUID.size(),
+        _targetVertices.size());
+}
+
+void HierarchicalRouter::CollectDoors()
+{
+    _rooms.clear();
+    _doorByUID.clear();
+    _roomIDsByDoorUID.clear();
+    _doorsToGoalUID.clear();
+
+    for(const auto& [roomID, _] : _building->GetAllRooms()) {
+        _rooms[roomID];
+    }
+
+    std::map<int, Transition*> exitsByUID;
+    for(const auto& [_, trans] : _building->GetAllTransitions()) {
+        const int uid = trans->GetUniqueID();
+        _doorByUID.emplace(uid, trans);
+        if(trans->IsExit()) {
+            exitsByUID.emplace(uid, trans);
+        }
+        for(Room* room : {trans->GetRoom1(), trans->GetRoom2()}) {
+            if(room != nullptr) {
+                auto& level = _rooms[room->GetID()];
+                AddUnique(level.doorUIDs, uid);
+                AddUnique(level.boundaryUIDs, uid);
+                AddUnique(_roomIDsByDoorUID[uid], room->GetID());
+            }
+        }
+    }
+
+    for(const auto& [_, cross] : _building->GetAllCrossings()) {
+        const int uid = cross->GetUniqueID();
+        _doorByUID.emplace(uid, cross);
+        if(Room* room = cross->GetRoom1(); room != nullptr) {
+            AddUnique(_rooms[room->GetID()].doorUIDs, uid);
+            AddUnique(_roomIDsByDoorUID[uid], room->GetID());
+        }
+    }
+
+    for(auto& [_, level] : _rooms) {
+        std::sort(level.doorUIDs.begin(), level.doorUIDs.end());
+        std::sort(level.boundaryUIDs.begin(), level.boundaryUIDs.end());
+    }
+
+    for(const auto& [goalID, goal] : _building->GetAllGoals()) {
+        if(auto* waitingArea = dynamic_cast<WaitingArea*>(goal); waitingArea != nullptr) {
+            // agents inside the room of the waiting area are sent there directly
+            const auto& transitions = _building->GetRoom(waitingArea->GetRoomID())
+                                          ->GetAllTransitionsIDs();
+            _doorsToGoalUID.emplace(goalID, std::set<int>(transitions.begin(), transitions.end()));
+        } else {
+            // other goals are reached through the closest exit
+            double minDist = std::numeric_limits<double>::max();
+            int minID = -1;
+            for(const auto& [exitID, exit] : exitsByUID) {
+                double dist = goal->GetDistance(exit->GetCentre());
+                if(dist < minDist) {
+                    minDist = dist;
+                    minID = exitID;
+                }
+            }
+            _doorsToGoalUID.emplace(goalID, std::set<int>{minID});
+        }
+    }
+}
+
+void HierarchicalRouter::CalculateDoorDistances(int roomID)
+{
+    // same fields as the FFRouter, both routers share them if used together
+    FloorfieldParameters parameters;
+    parameters.hx = 0.125;
+    parameters.user = DISTANCE_MEASUREMENTS_ONLY;
+    parameters.mode = CENTERPOINT;
+    parameters.speedMode = FF_HOMO_SPEED;
+    parameters.lazy = _config->useLazyFloorfields;
+    parameters.memoryBudget =
+        static_cast<std::size_t>(_config->floorfieldRoomMemoryBudget * 1024 * 1024);
+
+    auto& level = _rooms.at(roomID);
+    level.floorfield = _floorfields->Get(_building->GetRoom(roomID), parameters);
+    level.doorDistances.clear();
+
+    const auto subroomUIDs = [this](int doorUID) {
+        const Crossing* door = _doorByUID.at(doorUID);
+        return std::make_pair(
+            door->GetSubRoom1() ? door->GetSubRoom1()->GetUID() : -1,
+            door->GetSubRoom2() ? door->GetSubRoom2()->GetUID() : -2);
+    };
+
+    for(int doorUID1 : level.doorUIDs) {
+        const auto [sub1, sub2] = subroomUIDs(doorUID1);
+        for(int doorUID2 : level.doorUIDs) {
+            if(doorUID2 <= doorUID1) {
+                continue;
+            }
+            // only doors of the same subroom are connected directly
+            const auto [other1, other2] = subroomUIDs(doorUID2);
+            if(sub1 != other1 && sub1 != other2 && sub2 != other1 && sub2 != other2) {
+                continue;
+            }
+
+            const double distance =
+                level.floorfield->GetDistanceBetweenDoors(doorUID1, doorUID2);
+            if(distance < level.floorfield->GetGrid()->Gethx()) {
+                LOG_WARNING(
+                    "Ignoring distance of doors {:d} and {:d} because it is too small: {:.2f}.",
+                    doorUID1,
+                    doorUID2,
+                    distance);
+                continue;
+            }
+            level.doorDistances[std::make_pair(doorUID1, doorUID2)] = distance;
+        }
+    }
+}
+
+void HierarchicalRouter::CalculateBoundaryDistances(RoomLevel& level) const
+{
+    std::unordered_map<int, std::vector<std::pair<int, double>>> neighbors;
+    for(const auto& [key, distance] : level.doorDistances) {
+        if(_doorByUID.at(key.first)->IsClose() || _doorByUID.at(key.second)->IsClose()) {
+            continue;
+        }
+        neighbors[key.first].emplace_back(key.second, distance);
+        neighbors[key.second].emplace_back(key.first, distance);
+    }
+
+    const std::size_t numBoundary = level.boundaryUIDs.size();
+    level.boundaryDistances.assign(level.doorUIDs.size() * numBoundary, unreachable);
+    for(std::size_t i = 0; i < numBoundary; ++i) {
+        const int source = level.boundaryUIDs[i];
+        if(_doorByUID.at(source)->IsClose()) {
+            continue;
+        }
+
+        std::unordered_map<int, double> dist{{source, 0.}};
+        using QueueEntry = std::pair<double, int>;
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+        queue.emplace(0., source);
+        while(!queue.empty()) {
+            const auto [distance, door] = queue.top();
+            queue.pop();
+            if(distance > dist[door]) {
+                continue;
+            }
+            auto iter = neighbors.find(door);
+            if(iter == neighbors.end()) {
+                continue;
+            }
+            for(const auto& [next, cost] : iter->second) {
+                const double candidate = distance + cost;
+                auto distIter = dist.find(next);
+                if(distIter == dist.end() || candidate < distIter->second) {
+                    dist[next] = candidate;
+                    queue.emplace(candidate, next);
+                }
+            }
+        }
+
+        // the doors are connected symmetrically, so this is the distance from each door to source
+        for(std::size_t j = 0; j < level.doorUIDs.size(); ++j) {
+            if(auto iter = dist.find(level.doorUIDs[j]); iter != dist.end()) {
+                level.boundaryDistances[j * numBoundary + i] = iter->second;
+            }
+        }
+    }
+}
+
+void HierarchicalRouter::BuildOverlay()
+{
+    Graph::Builder builder;
+    _vertexByDoorUID.clear();
+    _vertexByGoalID.clear();
+    _targetVertices.clear();
+
+    for(const auto& [uid, door] : _doorByUID) {
+        if(door->IsTransition()) {
+            const Point& centre = door->GetCentre();
+            _vertexByDoorUID.emplace(uid, builder.AddVertex({centre.x, centre.y}));
+        }
+    }
+    _outsideVertex = builder.AddVertex({0., 0.});
+    _targetVertices.push_back(_outsideVertex);
+    for(const auto& [goalID, goal] : _building->GetAllGoals()) {
+        const Point centroid = goal->GetCentroid();
+        const auto vertex = builder.AddVertex({centroid.x, centroid.y});
+        _vertexByGoalID.emplace(goalID, vertex);
+        _targetVertices.push_back(vertex);
+    }
+
+    // one edge per pair of transitions, even if they share two rooms
+    std::set<std::pair<int, int>> connected;
+    for(const auto& [_, level] : _rooms) {
+        for(std::size_t i = 0; i < level.boundaryUIDs.size(); ++i) {
+            for(std::size_t j = i + 1; j < level.boundaryUIDs.size(); ++j) {
+                const int uid1 = level.boundaryUIDs[i];
+                const int uid2 = level.boundaryUIDs[j];
+                if(connected.emplace(uid1, uid2).second) {
+                    builder.AddEdge(
+                        _vertexByDoorUID.at(uid1),
+                        _vertexByDoorUID.at(uid2),
+                        OverlayCost(uid1, uid2));
+                }
+            }
+        }
+    }
+    for(const auto& [uid, vertex] : _vertexByDoorUID) {
+        if(_doorByUID.at(uid)->IsExit()) {
+            builder.AddEdge(vertex, _outsideVertex, ExitCost(uid));
+        }
+    }
+    for(const auto& [goalID, doorUIDs] : _doorsToGoalUID) {
+        for(int uid : doorUIDs) {
+            if(auto iter = _vertexByDoorUID.find(uid); iter != _vertexByDoorUID.end()) {
+                builder.AddEdge(iter->second, _vertexByGoalID.at(goalID), connectorCost);
+            }
+        }
+    }
+
+    _overlay = builder.Build();
+    _overlay.ComputeShortestPathsTo(_targetVertices);
+}
+
+double HierarchicalRouter::OverlayCost(int doorUID1, int doorUID2) const
+{
+    double cost = unreachable;
+    for(int roomID : _roomIDsByDoorUID.at(doorUID1)) {
+        const auto& level = _rooms.at(roomID);
+        const auto begin = level.boundaryUIDs.begin();
+        const auto end = level.boundaryUIDs.end();
+        const auto iter2 = std::lower_bound(begin, end, doorUID2);
+        if(iter2 == end || *iter2 != doorUID2) {
+            continue;
+        }
+        cost = std::min(
+            cost, BoundaryDistance(level, doorUID1, static_cast<std::size_t>(iter2 - begin)));
+    }
+    return cost;
+}
+
+double HierarchicalRouter::BoundaryDistance(
+    const RoomLevel& level,
+    int doorUID,
+    std::size_t boundaryIndex)
+{
+    const auto door = std::lower_bound(level.doorUIDs.begin(), level.doorUIDs.end(), doorUID);
+    const auto doorIndex = static_cast<std::size_t>(door - level.doorUIDs.begin());
+    return level.boundaryDistances[doorIndex * level.boundaryUIDs.size() + boundaryIndex];
+}
+
+double HierarchicalRouter::ExitCost(int doorUID) const
+{
+    const Crossing* door = _doorByUID.at(doorUID);
+    return (door->IsOpen() || door->IsTempClose()) ? connectorCost : unreachable;
+}
+
+long HierarchicalRouter::TargetVertex(int goalID) const
+{
+    if(goalID == FINAL_DEST_OUT) {
+        return _outsideVertex;
+    }
+    auto iter = _vertexByGoalID.find(goalID);
+    return iter == _vertexByGoalID.end() ? -1 : static_cast<long>(iter->second);
+}
+
+int HierarchicalRouter::FindExit(Pedestrian* p)
+{
+    const int roomID = p->GetSubRoom()->GetRoomID();
+    const int goalID = p->GetFinalDestination();
+
+    if(auto* wa = dynamic_cast<WaitingArea*>(_building->GetFinalGoal(goalID));
+       wa != nullptr && wa->GetRoomID() == roomID) {
+        auto* centre = wa->GetCentreCrossing();
+        p->SetDestination(centre->GetUniqueID());
+        p->SetExitLine(centre);
+        return centre->GetUniqueID();
+    }
+
+    const long target = TargetVertex(goalID);
+    if(target < 0) {
+        LOG_ERROR("ffHierarchicalRouter: unknown goalID: {:d} in FindExit(Ped)", goalID);
+        return -1;
+    }
+
+    // distance from each boundary door of the room to the target
+    const auto& level = _rooms.at(roomID);
+    std::vector<double> remaining;
+    remaining.reserve(level.boundaryUIDs.size());
+    for(int doorUID : level.boundaryUIDs) {
+        const double total = _overlay.DistanceTo(_vertexByDoorUID.at(doorUID), target);
+        // unreachable or only through another target
+        remaining.push_back(total >= 2 * connectorCost ? unreachable : total - connectorCost);
+    }
+
+    // the agent heads to a door of its subroom, from there it walks within the room to a
+    // boundary door, which avoids closed crossings
+    const SubRoom* subroom = p->GetSubRoom();
+    std::vector<const Crossing*> subroomDoors(
+        subroom->GetAllCrossings().begin(), subroom->GetAllCrossings().end());
+    subroomDoors.insert(
+        subroomDoors.end(),
+        subroom->GetAllTransitions().begin(),
+        subroom->GetAllTransitions().end());
+
+    int bestDoor = -1;
+    double minDist = std::numeric_limits<double>::infinity();
+    double bestRemaining = unreachable;
+    // reachable doors of the subroom with their remaining distance to the target
+    std::vector<std::pair<int, double>> candidates;
+    for(const Crossing* door : subroomDoors) {
+        const int doorUID = door->GetUniqueID();
+        if(door->IsClose() || _doorByUID.count(doorUID) == 0) {
+            continue;
+        }
+        double minRemaining = unreachable;
+        for(std::size_t i = 0; i < remaining.size(); ++i) {
+            const double distance = BoundaryDistance(level, doorUID, i);
+            if(distance != unreachable && remaining[i] != unreachable) {
+                minRemaining = std::min(minRemaining, distance + remaining[i]);
+            }
+        }
+        if(minRemaining == unreachable) {
+            continue;
+        }
+        const double distToDoor =
+            _directionManager->GetDirectionStrategy().GetDistance2Target(p, doorUID);
+        if(distToDoor < -J_EPS) {
+            // the door can not be reached from the position of the agent
+            continue;
+        }
+        candidates.emplace_back(doorUID, minRemaining);
+        if(distToDoor + minRemaining < minDist) {
+            minDist = distToDoor + minRemaining;
+            bestRemaining = minRemaining;
+            bestDoor = doorUID;
+        }
+    }
+
+    // if the route continues from the best door through another door of the subroom, e.g. for
+    // agents standing in the door they just passed, they are sent to that door directly
+    int nextDoor = bestDoor;
+    double minVia = bestRemaining + J_EPS;
+    for(const auto& [doorUID, minRemaining] : candidates) {
+        const auto key = std::minmax(bestDoor, doorUID);
+        const auto distance = level.doorDistances.find(std::make_pair(key.first, key.second));
+        if(doorUID == bestDoor || distance == level.doorDistances.end()) {
+            continue;
+        }
+        if(distance->second + minRemaining <= minVia) {
+            minVia = distance->second + minRemaining;
+            nextDoor = doorUID;
+        }
+    }
+    bestDoor = nextDoor;
+
+    if(bestDoor != -1) {
+        p->SetDestination(bestDoor);
+        p->SetExitLine(_doorByUID.at(bestDoor));
+    }
+    return bestDoor;
+}
+
+void HierarchicalRouter::Update()
+{
+    Build();
+}
+
+void HierarchicalRouter::UpdateIncremental(
+    const std::set<int>& changedDoors,
+    const std::set<int>& changedRooms)
+{
+    if(!changedRooms.empty()) {
+        Build();
+        return;
+    }
+
+    std::set<int> roomIDs;
+    for(int doorUID : changedDoors) {
+        if(auto iter = _roomIDsByDoorUID.find(doorUID); iter != _roomIDsByDoorUID.end()) {
+            roomIDs.insert(iter->second.begin(), iter->second.end());
+        }
+    }
+    for(int roomID : roomIDs) {
+        CalculateBoundaryDistances(_rooms.at(roomID));
+    }
+
+    // only the trees affected by the new weights are recomputed
+    for(int roomID : roomIDs) {
+        const auto& boundaryUIDs = _rooms.at(roomID).boundaryUIDs;
+        for(std::size_t i = 0; i < boundaryUIDs.size(); ++i) {
+            for(std::size_t j = i + 1; j < boundaryUIDs.size(); ++j) {
+                _overlay.SetEdgeWeight(
+                    _vertexByDoorUID.at(boundaryUIDs[i]),
+                    _vertexByDoorUID.at(boundaryUIDs[j]),
+                    OverlayCost(boundaryUIDs[i], boundaryUIDs[j]));
+            }
+        }
+    }
+    for(int doorUID : changedDoors) {
+        if(auto iter = _vertexByDoorUID.find(doorUID);
+           iter != _vertexByDoorUID.end() && _doorByUID.at(doorUID)->IsExit()) {
+            _overlay.SetEdgeWeight(iter->second, _outsideVertex, ExitCost(doorUID));
+        }
+    }
+    _overlay.ComputeShortestPathsTo(_targetVertices);
+
+    LOG_INFO(
+        "ffHierarchicalRouter: state of {:d} doors changed, updated {:d} rooms.",
+        changedDoors.size(),
+        roomIDs.size());
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "FloorfieldRepository.hpp"
+#include "Graph.hpp"
+#include "routing/Router.hpp"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+class Building;
+struct Configuration;
+class DirectionManager;
+class Pedestrian;
+class UnivFFviaFM;
+
+/**
+ * \class HierarchicalRouter
+ *
+ * \brief Floor field router for very large buildings, routing on a room level overlay graph.
+ *
+ * The FFRouter keeps the distances between all pairs of doors, which grows quadratically with the
+ * number of doors. This router splits the door graph into two levels:
+ *
+ * - local level: for each room, the distances between its doors (transitions and crossings) are
+ *   measured on the floor field of the room. A Dijkstra search within the room yields the
+ *   distances between the transitions of the room (boundary doors).
+ * - overlay level: a graph of all transitions, connecting the boundary doors of each room by
+ *   their local distances. An additional vertex for the outside is connected to all open exits
+ *   and one vertex per goal to the doors leading to it. Shortest path trees are only stored for
+ *   these targets.
+ *
+ * An agent is sent to the door of its subroom minimizing its floor field distance to the door,
+ * the local distance from the door to a transition of the room and the overlay distance from the
+ * transition to its target. Agents in rooms with several subrooms are thus sent to the crossings
+ * on their way, closed crossings are avoided like closed transitions. Memory and setup time grow
+ * with the number of doors per room and the number of targets, not with the square of all doors.
+ *
+ * Opening or closing doors only recomputes the local level of the rooms of these doors and
+ * re-weights the affected overlay edges. Directional escalators are treated as bidirectional.
+ */
+class HierarchicalRouter : public Router
+{
+public:
+    /**
+     * @param config configuration of simulation.
+     * @param building geometry the agents are routed in.
+     * @param directionManager provides the floor field distances of the agents to the doors.
+     * @param floorfields repository providing the floor fields of the rooms.
+     */
+    HierarchicalRouter(
+        Configuration* config,
+        Building* building,
+        DirectionManager* directionManager,
+        FloorfieldRepository* floorfields);
+
+    ~HierarchicalRouter() override = default;
+
+    int FindExit(Pedestrian* p) override;
+
+    void Update() override;
+
+    /**
+     * \brief Updates the router after the state of some doors or the geometry of some rooms
+     * changed.
+     *
+     * Door changes only update the local level of the rooms of the doors and the affected overlay
+     * edges, geometry changes rebuild the router.
+     * @param changedDoors UIDs of the doors whose state changed
+     * @param changedRooms IDs of the rooms whose geometry changed
+     */
+    void UpdateIncremental(const std::set<int>& changedDoors, const std::set<int>& changedRooms)
+        override;
+
+private:
+    /**
+     * Local level of a room.
+     */
+    struct RoomLevel {
+        /// floor field of the room
+        std::shared_ptr<UnivFFviaFM> floorfield;
+        /// UIDs of all doors of the room
+        std::vector<int> doorUIDs;
+        /// UIDs of the transitions of the room
+        std::vector<int> boundaryUIDs;
+        /// distances between doors sharing a subroom
+        std::map<std::pair<int, int>, double> doorDistances;
+        /// shortest distances from the doors to the boundary doors within the room avoiding
+        /// closed doors, entry (i, j) for doorUIDs[i] and boundaryUIDs[j] is stored at
+        /// [i * boundaryUIDs.size() + j]
+        std::vector<double> boundaryDistances;
+    };
+
+    /**
+     * Sets up both levels from scratch.
+     */
+    void Build();
+
+    /**
+     * Collects the doors of each room and the doors leading to each goal.
+     */
+    void CollectDoors();
+
+    /**
+     * Measures the distances between the doors of a room on its floor field.
+     * @param roomID ID of the room
+     */
+    void CalculateDoorDistances(int roomID);
+
+    /**
+     * Computes the distances from all doors of a room to its boundary doors with Dijkstra on its
+     * doors.
+     * @param level local level of the room
+     */
+    void CalculateBoundaryDistances(RoomLevel& level) const;
+
+    /**
+     * Builds the overlay graph from the local levels of all rooms.
+     */
+    void BuildOverlay();
+
+    /**
+     * @return cost of the overlay edge between two transitions, the shorter local distance if
+     * they share two rooms
+     */
+    double OverlayCost(int doorUID1, int doorUID2) const;
+
+    /**
+     * @return distance within the room from a door of the room to one of its boundary doors
+     */
+    static double BoundaryDistance(const RoomLevel& level, int doorUID, std::size_t boundaryIndex);
+
+    /**
+     * @return cost of the overlay edge between an exit and the outside
+     */
+    double ExitCost(int doorUID) const;
+
+    /**
+     * @return overlay vertex of the final destination, -1 if it is unknown
+     */
+    long TargetVertex(int goalID) const;
+
+    Configuration* _config{};
+    DirectionManager* _directionManager{};
+    Building* _building{};
+    FloorfieldRepository* _floorfields{};
+
+    /// local level of each room
+    std::map<int, RoomLevel> _rooms;
+    /// doors (transitions and crossings) by UID
+    std::map<int, Crossing*> _doorByUID;
+    /// IDs of the rooms of each door
+    std::map<int, std::vector<int>> _roomIDsByDoorUID;
+    /// doors leading to each goal
+    std::map<int, std::set<int>> _doorsToGoalUID;
+
+    /// overlay graph of the transitions and the targets
+    Graph _overlay;
+    /// overlay vertex of each transition
+    std::map<int, Graph::VertexId> _vertexByDoorUID;
+    /// overlay vertex of the outside
+    Graph::VertexId _outsideVertex{};
+    /// overlay vertex of each goal
+    std::map<int, Graph::VertexId> _vertexByGoalID;
+    /// overlay vertices of the outside and the goals
+    std::vector<Graph::VertexId> _targetVertices;
+};
@@ -3,6 +3,7 @@
 //
 #include "UnivFFviaFM.hpp"
 
+#include "DensitySpeedField.hpp"
 #include "general/Filesystem.hpp"
 #include "geometry/Building.hpp"
 #include "geometry/Line.hpp"
@@ -13,8 +14,12 @@
 #include "routing/ff_router/mesh/RectGrid.hpp"
 
 #include <Logger.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
 #include <stdexcept>
-#include <unordered_set>
+#include <vector>
 
 UnivFFviaFM::~UnivFFviaFM()
 {
@@ -108,6 +113,47 @@ UnivFFviaFM::UnivFFviaFM(Room* roomArg, double hx, double wallAvoid, bool useWal
     }
 }
 
+UnivFFviaFM::UnivFFviaFM(const UnivFFviaFM& base, int user, int mode, int speedMode)
+    : _room(base._room)
+    , _mode(mode)
+    , _user(user)
+    , _grid(new RectGrid(*base._grid))
+    , _nPoints(base._nPoints)
+    , _wallAvoidDistance(base._wallAvoidDistance)
+    , _useWallDistances(base._useWallDistances)
+    , _doors(base._doors)
+    , _subRoomPtrTOinsidePoint(base._subRoomPtrTOinsidePoint)
+{
+    _gridCode = new int[_nPoints];
+    std::copy(base._gridCode, base._gridCode + _nPoints, _gridCode);
+    if(base._subrooms) {
+        _subrooms = new SubRoom*[_nPoints];
+        std::copy(base._subrooms, base._subrooms + _nPoints, _subrooms);
+    }
+
+    for(const double* speed : base._speedFieldSelector) {
+        double* copy = nullptr;
+        if(speed) {
+            copy = new double[_nPoints];
+            std::copy(speed, speed + _nPoints, copy);
+        }
+        _speedFieldSelector.emplace_back(copy);
+    }
+
+    // the wall distance field (key 0) only depends on the geometry
+    std::shared_lock lock(base._fieldMutex);
+    if(auto cost = base._costFieldWithKey.find(0); cost != base._costFieldWithKey.end()) {
+        _costFieldWithKey[0] = new double[_nPoints];
+        std::copy(cost->second, cost->second + _nPoints, _costFieldWithKey[0]);
+    }
+    if(auto dir = base._directionFieldWithKey.find(0); dir != base._directionFieldWithKey.end()) {
+        _directionFieldWithKey[0] = new Point[_nPoints];
+        std::copy(dir->second, dir->second + _nPoints, _directionFieldWithKey[0]);
+    }
+
+    SetSpeedMode(speedMode);
+}
+
 void UnivFFviaFM::Create(
     std::vector<Line>& walls,
     std::map<int, Line>& doors,
@@ -278,66 +324,27 @@ void UnivFFviaFM::MarkSubroom(const Point& insidePoint, SubRoom* value)
     _subrooms[_grid->GetKeyAtPoint(insidePoint)] = value;
     _gridCode[_grid->GetKeyAtPoint(insidePoint)] = INSIDE;
 
-    std::unordered_set<long> wavefront;
-    wavefront.reserve(_nPoints);
-
-    directNeighbor _neigh = _grid->GetNeighbors(_grid->GetKeyAtPoint(insidePoint));
-    long aux = _neigh.key[0];
-    if((aux != -2) && (_gridCode[aux] == INSIDE || _gridCode[aux] == OUTSIDE)) {
-        wavefront.insert(aux);
-        _subrooms[aux] = value;
-    }
-
-    aux = _neigh.key[1];
-    if((aux != -2) && (_gridCode[aux] == INSIDE || _gridCode[aux] == OUTSIDE)) {
-        wavefront.insert(aux);
-        _subrooms[aux] = value;
-    }
+    std::vector<long int> wavefront;
 
-    aux = _neigh.key[2];
-    if((aux != -2) && (_gridCode[aux] == INSIDE || _gridCode[aux] == OUTSIDE)) {
-        wavefront.insert(aux);
-        _subrooms[aux] = value;
-    }
-
-    aux = _neigh.key[3];
-    if((aux != -2) && (_gridCode[aux] == INSIDE || _gridCode[aux] == OUTSIDE)) {
-        wavefront.insert(aux);
-        _subrooms[aux] = value;
+    for(long int aux : _grid->GetNeighbors(_grid->GetKeyAtPoint(insidePoint)).key) {
+        if((aux != -2) && (_gridCode[aux] == INSIDE || _gridCode[aux] == OUTSIDE)) {
+            wavefront.push_back(aux);
+            _subrooms[aux] = value;
+        }
     }
 
+    // grid points are marked when entering the wavefront, so each one enters it only once
     while(!wavefront.empty()) {
-        long current = *(wavefront.begin());
-        wavefront.erase(current);
+        const long int current = wavefront.back();
+        wavefront.pop_back();
         _gridCode[current] = INSIDE;
 
-        _neigh = _grid->GetNeighbors(current);
-        aux = _neigh.key[0];
-        if((aux != -2) && (_gridCode[aux] == INSIDE || _gridCode[aux] == OUTSIDE) &&
-           _subrooms[aux] == nullptr) {
-            wavefront.insert(aux);
-            _subrooms[aux] = value;
-        }
-
-        aux = _neigh.key[1];
-        if((aux != -2) && (_gridCode[aux] == INSIDE || _gridCode[aux] == OUTSIDE) &&
-           _subrooms[aux] == nullptr) {
-            wavefront.insert(aux);
-            _subrooms[aux] = value;
-        }
-
-        aux = _neigh.key[2];
-        if((aux != -2) && (_gridCode[aux] == INSIDE || _gridCode[aux] == OUTSIDE) &&
-           _subrooms[aux] == nullptr) {
-            wavefront.insert(aux);
-            _subrooms[aux] = value;
-        }
-
-        aux = _neigh.key[3];
-        if((aux != -2) && (_gridCode[aux] == INSIDE || _gridCode[aux] == OUTSIDE) &&
-           _subrooms[aux] == nullptr) {
-            wavefront.insert(aux);
-            _subrooms[aux] = value;
+        for(long int aux : _grid->GetNeighbors(current).key) {
+            if((aux != -2) && (_gridCode[aux] == INSIDE || _gridCode[aux] == OUTSIDE) &&
+               _subrooms[aux] == nullptr) {
+                wavefront.push_back(aux);
+                _subrooms[aux] = value;
+            }
         }
     }
 }
@@ -707,78 +714,32 @@ void UnivFFviaFM::CalcFF(double* costOutput, Point* directionOutput, const doubl
     // std::priority_queue<long int, std::vector<long int>, CompareCostTrips> trialfield2(comp);
     // //pass the CompareCostTrips object directly
 
-    directNeighbor local_neighbor = _grid->GetNeighbors(0);
-    long int aux = 0;
     // init trial field
-    for(long int i = 0; i < _nPoints; ++i) {
-        if(costOutput[i] == 0.0) {
+    for(long int key = 0; key < _nPoints; ++key) {
+        if(costOutput[key] == 0.0) {
             // check for negative neighbours, calc that ones and add to queue trialfield
-            local_neighbor = _grid->GetNeighbors(i);
-
-            // check for valid neigh
-            aux = local_neighbor.key[0];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                CalcCost(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                // trialfield2.emplace(aux);
-            }
-            aux = local_neighbor.key[1];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                CalcCost(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                // trialfield2.emplace(aux);
-            }
-            aux = local_neighbor.key[2];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                CalcCost(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                // trialfield2.emplace(aux);
-            }
-            aux = local_neighbor.key[3];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                CalcCost(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                // trialfield2.emplace(aux);
+            for(long int aux : _grid->GetNeighbors(key).key) {
+                // check for valid neigh
+                if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
+                   (costOutput[aux] < 0.0)) {
+                    CalcCost(aux, costOutput, directionOutput, speed);
+                    trialfield.emplace(aux);
+                }
             }
         }
     }
 
     while(!trialfield.empty()) {
-        local_neighbor = _grid->GetNeighbors(trialfield.top());
+        const directNeighbor local_neighbor = _grid->GetNeighbors(trialfield.top());
         trialfield.pop();
 
-        // check for valid neigh
-        aux = local_neighbor.key[0];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            CalcCost(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            // trialfield2.emplace(aux);
-        }
-        aux = local_neighbor.key[1];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            CalcCost(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            // trialfield2.emplace(aux);
-        }
-        aux = local_neighbor.key[2];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            CalcCost(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            // trialfield2.emplace(aux);
-        }
-        aux = local_neighbor.key[3];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            CalcCost(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            // trialfield2.emplace(aux);
+        for(long int aux : local_neighbor.key) {
+            // check for valid neigh
+            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
+               (costOutput[aux] < 0.0)) {
+                CalcCost(aux, costOutput, directionOutput, speed);
+                trialfield.emplace(aux);
+            }
         }
     }
 }
@@ -912,78 +873,32 @@ void UnivFFviaFM::CalcDF(double* costOutput, Point* directionOutput, const doubl
     // std::priority_queue<long int, std::vector<long int>, CompareCostTrips> trialfield2(comp);
     // //pass the CompareCostTrips object directly
 
-    directNeighbor local_neighbor = _grid->GetNeighbors(0);
-    long int aux = 0;
     // init trial field
-    for(long int i = 0; i < _nPoints; ++i) {
-        if(costOutput[i] == 0.0) {
+    for(long int key = 0; key < _nPoints; ++key) {
+        if(costOutput[key] == 0.0) {
             // check for negative neighbours, calc that ones and add to queue trialfield
-            local_neighbor = _grid->GetNeighbors(i);
-
-            // check for valid neigh
-            aux = local_neighbor.key[0];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                CalcDist(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                // trialfield2.emplace(aux);
-            }
-            aux = local_neighbor.key[1];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                CalcDist(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                // trialfield2.emplace(aux);
-            }
-            aux = local_neighbor.key[2];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                CalcDist(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                // trialfield2.emplace(aux);
-            }
-            aux = local_neighbor.key[3];
-            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-               (costOutput[aux] < 0.0)) {
-                CalcDist(aux, costOutput, directionOutput, speed);
-                trialfield.emplace(aux);
-                // trialfield2.emplace(aux);
+            for(long int aux : _grid->GetNeighbors(key).key) {
+                // check for valid neigh
+                if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
+                   (costOutput[aux] < 0.0)) {
+                    CalcDist(aux, costOutput, directionOutput, speed);
+                    trialfield.emplace(aux);
+                }
             }
         }
     }
 
     while(!trialfield.empty()) {
-        local_neighbor = _grid->GetNeighbors(trialfield.top());
+        const directNeighbor local_neighbor = _grid->GetNeighbors(trialfield.top());
         trialfield.pop();
 
-        // check for valid neigh
-        aux = local_neighbor.key[0];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            CalcDist(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            // trialfield2.emplace(aux);
-        }
-        aux = local_neighbor.key[1];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            CalcDist(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            // trialfield2.emplace(aux);
-        }
-        aux = local_neighbor.key[2];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            CalcDist(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            // trialfield2.emplace(aux);
-        }
-        aux = local_neighbor.key[3];
-        if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
-           (costOutput[aux] < 0.0)) {
-            CalcDist(aux, costOutput, directionOutput, speed);
-            trialfield.emplace(aux);
-            // trialfield2.emplace(aux);
+        for(long int aux : local_neighbor.key) {
+            // check for valid neigh
+            if((aux != -2) && (_gridCode[aux] != WALL) && (_gridCode[aux] != OUTSIDE) &&
+               (costOutput[aux] < 0.0)) {
+                CalcDist(aux, costOutput, directionOutput, speed);
+                trialfield.emplace(aux);
+            }
         }
     }
 }
@@ -1216,11 +1131,29 @@ void UnivFFviaFM::AddTarget(int uid, double* costarray, Point* gradarray)
             LOG_ERROR("in AddTarget: calling FinalizeTargetLine");
         }
     }
-    _uids.emplace_back(uid);
+    if(std::find(_uids.begin(), _uids.end(), uid) == _uids.end()) {
+        _uids.emplace_back(uid);
+    }
+    ++_fieldComputations;
+    _lastAccess[uid] = ++_accessCounter;
 }
 
 void UnivFFviaFM::AddAllTargetsParallel()
 {
+    if(_lazy) {
+        std::unique_lock lock(_fieldMutex);
+        std::vector<int> computed;
+        for(const auto& [uid, field] : _costFieldWithKey) {
+            if(uid != 0) {
+                computed.emplace_back(uid);
+            }
+        }
+        for(int uid : computed) {
+            FreeField(uid);
+        }
+        return;
+    }
+
     // Reason: freeing and reallocating takes time. We do not use already allocated memory, because
     // we do not know if it
     //         is shared memory. Maybe this is not neccessary - maybe reconsider. This way, it is
@@ -1299,6 +1232,11 @@ std::vector<int> UnivFFviaFM::GetKnownDoorUIDs()
     return _uids;
 }
 
+std::size_t UnivFFviaFM::GetFieldComputations() const
+{
+    return _fieldComputations;
+}
+
 void UnivFFviaFM::SetUser(int user)
 {
     _user = user;
@@ -1317,8 +1255,144 @@ void UnivFFviaFM::SetSpeedMode(int speedMode)
     }
 }
 
+void UnivFFviaFM::UpdatePedSpeed(const std::vector<Point>& positions)
+{
+    if(!_speedFieldSelector[PED_SPEED]) {
+        _speedFieldSelector[PED_SPEED] = new double[_nPoints];
+    }
+
+    if(!_densitySpeed) {
+        _densitySpeed = std::make_unique<DensitySpeedField>(*_grid);
+    }
+    _densitySpeed->UpdateDensity(positions);
+    const double* freeSpeed = _speedFieldSelector[REDU_WALL_SPEED] ?
+                                  _speedFieldSelector[REDU_WALL_SPEED] :
+                                  _speedFieldSelector[INITIAL_SPEED];
+    _densitySpeed->ApplyFundamentalDiagram(freeSpeed, _speedFieldSelector[PED_SPEED]);
+}
+
+void UnivFFviaFM::SetLazy(bool lazy)
+{
+    _lazy = lazy;
+}
+
+void UnivFFviaFM::SetMemoryBudget(std::size_t bytes)
+{
+    _memoryBudget = bytes;
+}
+
+const double* UnivFFviaFM::FindCostField(int uid)
+{
+    const auto iter = _costFieldWithKey.find(uid);
+    if(iter == _costFieldWithKey.end() || !iter->second) {
+        return nullptr;
+    }
+    if(const auto access = _lastAccess.find(uid); access != _lastAccess.end()) {
+        access->second = ++_accessCounter;
+    }
+    return iter->second;
+}
+
+const Point* UnivFFviaFM::FindDirectionField(int uid)
+{
+    const auto iter = _directionFieldWithKey.find(uid);
+    if(iter == _directionFieldWithKey.end() || !iter->second) {
+        return nullptr;
+    }
+    if(const auto access = _lastAccess.find(uid); access != _lastAccess.end()) {
+        access->second = ++_accessCounter;
+    }
+    return iter->second;
+}
+
+void UnivFFviaFM::RequireField(int uid)
+{
+    const bool needsDirections = _user == DISTANCE_AND_DIRECTIONS_USED;
+    if(FindCostField(uid) && (!needsDirections || FindDirectionField(uid))) {
+        return;
+    }
+    EvictFields(FieldMemory(), uid);
+    FreeField(uid);
+
+    auto* costarray = new double[_nPoints];
+    Point* gradarray = needsDirections ? new Point[_nPoints] : nullptr;
+    _costFieldWithKey[uid] = costarray;
+    _directionFieldWithKey[uid] = gradarray;
+    AddTarget(uid, costarray, gradarray);
+}
+
+void UnivFFviaFM::EvictFields(std::size_t bytes, int keep)
+{
+    if(_memoryBudget == 0) {
+        return;
+    }
+    std::size_t used = UsedFieldMemory();
+    while(used + bytes > _memoryBudget) {
+        int lru = 0;
+        std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+        for(const auto& [uid, field] : _costFieldWithKey) {
+            if(uid == 0 || uid == keep || !field) {
+                continue;
+            }
+            const auto access = _lastAccess.find(uid);
+            const std::uint64_t lastUse = (access != _lastAccess.end()) ? access->second.load() : 0;
+            if(lastUse < oldest) {
+                oldest = lastUse;
+                lru = uid;
+            }
+        }
+        if(lru == 0) {
+            break;
+        }
+        LOG_DEBUG("Evicting floor field of door {:d} in room {:d}", lru, _room);
+        FreeField(lru);
+        used = UsedFieldMemory();
+    }
+}
+
+void UnivFFviaFM::FreeField(int uid)
+{
+    if(uid == 0) {
+        return; // wall distance field is never freed before destruction
+    }
+    if(const auto iter = _costFieldWithKey.find(uid); iter != _costFieldWithKey.end()) {
+        delete[] iter->second;
+        _costFieldWithKey.erase(iter);
+    }
+    if(const auto iter = _directionFieldWithKey.find(uid); iter != _directionFieldWithKey.end()) {
+        delete[] iter->second;
+        _directionFieldWithKey.erase(iter);
+    }
+    _lastAccess.erase(uid);
+}
+
+std::size_t UnivFFviaFM::FieldMemory() const
+{
+    std::size_t bytes = _nPoints * sizeof(double);
+    if(_user == DISTANCE_AND_DIRECTIONS_USED) {
+        bytes += _nPoints * sizeof(Point);
+    }
+    return bytes;
+}
+
+std::size_t UnivFFviaFM::UsedFieldMemory() const
+{
+    std::size_t bytes = 0;
+    for(const auto& [uid, field] : _costFieldWithKey) {
+        if(uid != 0 && field) {
+            bytes += _nPoints * sizeof(double);
+        }
+    }
+    for(const auto& [uid, field] : _directionFieldWithKey) {
+        if(uid != 0 && field) {
+            bytes += _nPoints * sizeof(Point);
+        }
+    }
+    return bytes;
+}
+
 // mode is argument, which should not be needed, the info is stored in members like speedmode, ...
-double UnivFFviaFM::GetCostToDestination(int destID, const Point& position, int mode)
+double UnivFFviaFM::GetCostToDestination(int destID, const Point& position, int /*mode*/)
 {
     assert(_grid->IncludesPoint(position));
     long int key = _grid->GetKeyAtPoint(position);
@@ -1345,18 +1419,16 @@ double UnivFFviaFM::GetCostToDestination(int destID, const Point& position, int
             // Log->Write("ERROR:\t In GetCostToDestination(3 args)");
         }
     }
-    if(_costFieldWithKey.count(destID) == 1 && _costFieldWithKey[destID]) {
-        return _costFieldWithKey[destID][key];
-    } else if(_doors.count(destID) > 0) {
-        _costFieldWithKey[destID] = new double[_nPoints];
-        if(_user == DISTANCE_AND_DIRECTIONS_USED) {
-            _directionFieldWithKey[destID] = new Point[_nPoints];
-        } else {
-            _directionFieldWithKey[destID] = nullptr;
+    {
+        std::shared_lock lock(_fieldMutex);
+        if(const double* costfield = FindCostField(destID)) {
+            return costfield[key];
         }
-
-        AddTarget(destID, _costFieldWithKey[destID], _directionFieldWithKey[destID]);
-        return GetCostToDestination(destID, position, mode);
+    }
+    if(_doors.count(destID) > 0) {
+        std::unique_lock lock(_fieldMutex);
+        RequireField(destID);
+        return _costFieldWithKey.at(destID)[key];
     }
     return std::numeric_limits<double>::max();
 }
@@ -1388,18 +1460,16 @@ double UnivFFviaFM::GetCostToDestination(int destID, const Point& position)
             // Log->Write("ERROR:\t In GetCostToDestination(2 args)");
         }
     }
-    if(_costFieldWithKey.count(destID) == 1 && _costFieldWithKey[destID]) {
-        return _costFieldWithKey[destID][key];
-    } else if(_doors.count(destID) > 0) {
-        _costFieldWithKey[destID] = new double[_nPoints];
-        if(_user == DISTANCE_AND_DIRECTIONS_USED) {
-            _directionFieldWithKey[destID] = new Point[_nPoints];
-        } else {
-            _directionFieldWithKey[destID] = nullptr;
+    {
+        std::shared_lock lock(_fieldMutex);
+        if(const double* costfield = FindCostField(destID)) {
+            return costfield[key];
         }
-
-        AddTarget(destID, _costFieldWithKey[destID], _directionFieldWithKey[destID]);
-        return GetCostToDestination(destID, position);
+    }
+    if(_doors.count(destID) > 0) {
+        std::unique_lock lock(_fieldMutex);
+        RequireField(destID);
+        return _costFieldWithKey.at(destID)[key];
     }
     return std::numeric_limits<double>::max();
 }
@@ -1409,33 +1479,33 @@ double UnivFFviaFM::GetDistanceBetweenDoors(const int door1_ID, const int door2_
     assert(_doors.count(door1_ID) != 0);
     assert(_doors.count(door2_ID) != 0);
 
-    if(_costFieldWithKey.count(door1_ID) == 1 && _costFieldWithKey[door1_ID]) {
-        long int key = _grid->GetKeyAtPoint(_doors.at(door2_ID).GetCentre());
-        if(_gridCode[key] != door2_ID) {
-            // bresenham line (treppenstruktur) GetKeyAtPoint yields gridpoint next to edge,
-            // although position is on edge find a key that belongs to door (must be one left or
-            // right and second one below or above)
-            if(_gridCode[key + 1] == door2_ID) {
-                key = key + 1;
-            } else if(_gridCode[key - 1] == door2_ID) {
-                key = key - 1;
-            } else {
-                LOG_ERROR("In DistanceBetweenDoors.");
-            }
-        }
-        return _costFieldWithKey[door1_ID][key];
-    } else if(_doors.count(door1_ID) > 0) {
-        _costFieldWithKey[door1_ID] = new double[_nPoints];
-        if(_user == DISTANCE_AND_DIRECTIONS_USED) {
-            _directionFieldWithKey[door1_ID] = new Point[_nPoints];
+    if(_doors.count(door1_ID) == 0 || _doors.count(door2_ID) == 0) {
+        return std::numeric_limits<double>::max();
+    }
+
+    long int key = _grid->GetKeyAtPoint(_doors.at(door2_ID).GetCentre());
+    if(_gridCode[key] != door2_ID) {
+        // bresenham line (treppenstruktur) GetKeyAtPoint yields gridpoint next to edge,
+        // although position is on edge find a key that belongs to door (must be one left or
+        // right and second one below or above)
+        if(_gridCode[key + 1] == door2_ID) {
+            key = key + 1;
+        } else if(_gridCode[key - 1] == door2_ID) {
+            key = key - 1;
         } else {
-            _directionFieldWithKey[door1_ID] = nullptr;
+            LOG_ERROR("In DistanceBetweenDoors.");
         }
+    }
 
-        AddTarget(door1_ID, _costFieldWithKey[door1_ID], _directionFieldWithKey[door1_ID]);
-        return GetDistanceBetweenDoors(door1_ID, door2_ID);
+    {
+        std::shared_lock lock(_fieldMutex);
+        if(const double* costfield = FindCostField(door1_ID)) {
+            return costfield[key];
+        }
     }
-    return std::numeric_limits<double>::max();
+    std::unique_lock lock(_fieldMutex);
+    RequireField(door1_ID);
+    return _costFieldWithKey.at(door1_ID)[key];
 }
 
 RectGrid* UnivFFviaFM::GetGrid()
@@ -1443,7 +1513,7 @@ RectGrid* UnivFFviaFM::GetGrid()
     return _grid;
 }
 
-void UnivFFviaFM::GetDirectionToUID(int destID, long int key, Point& direction, int mode)
+void UnivFFviaFM::GetDirectionToUID(int destID, long int key, Point& direction, int /*mode*/)
 {
     assert(key > 0 && key < _nPoints);
     if((_gridCode[key] == OUTSIDE) || (_gridCode[key] == WALL)) {
@@ -1469,24 +1539,18 @@ void UnivFFviaFM::GetDirectionToUID(int destID, long int key, Point& direction,
             LOG_ERROR("In GetDirectionToUID (4 args)");
         }
     }
-    if(_directionFieldWithKey.count(destID) == 1 && _directionFieldWithKey[destID]) {
-        direction = _directionFieldWithKey[destID][key];
-    } else if(_doors.count(destID) > 0) {
-        // free memory if needed
-        if(_costFieldWithKey.count(destID) == 1 && _costFieldWithKey[destID]) {
-            delete[] _costFieldWithKey[destID];
-        }
-        // allocate memory
-        _costFieldWithKey[destID] = new double[_nPoints];
-        if(_user == DISTANCE_AND_DIRECTIONS_USED) {
-            _directionFieldWithKey[destID] = new Point[_nPoints];
-        } else {
-            _directionFieldWithKey[destID] = nullptr;
+    {
+        std::shared_lock lock(_fieldMutex);
+        if(const Point* directionfield = FindDirectionField(destID)) {
+            direction = directionfield[key];
+            return;
         }
-
-        // calculate destID's fields and call function
-        AddTarget(destID, _costFieldWithKey[destID], _directionFieldWithKey[destID]);
-        GetDirectionToUID(destID, key, direction, mode);
+    }
+    if(_doors.count(destID) > 0 && _user == DISTANCE_AND_DIRECTIONS_USED) {
+        // calculate destID's fields
+        std::unique_lock lock(_fieldMutex);
+        RequireField(destID);
+        direction = _directionFieldWithKey.at(destID)[key];
     }
 }
 
@@ -1521,24 +1585,18 @@ void UnivFFviaFM::GetDirectionToUID(int destID, long int key, Point& direction)
             // Log->Write("ERROR:\t In GetDirectionToUID (3 args)");
         }
     }
-    if(_directionFieldWithKey.count(destID) == 1 && _directionFieldWithKey[destID]) {
-        direction = _directionFieldWithKey[destID][key];
-    } else if(_doors.count(destID) > 0) {
-        // free memory if needed
-        if(_costFieldWithKey.count(destID) == 1 && _costFieldWithKey[destID]) {
-            delete[] _costFieldWithKey[destID];
-        }
-        // allocate memory
-        _costFieldWithKey[destID] = new double[_nPoints];
-        if(_user == DISTANCE_AND_DIRECTIONS_USED) {
-            _directionFieldWithKey[destID] = new Point[_nPoints];
-        } else {
-            _directionFieldWithKey[destID] = nullptr;
+    {
+        std::shared_lock lock(_fieldMutex);
+        if(const Point* directionfield = FindDirectionField(destID)) {
+            direction = directionfield[key];
+            return;
         }
-
-        // calculate destID's fields and call function
-        AddTarget(destID, _costFieldWithKey[destID], _directionFieldWithKey[destID]);
-        GetDirectionToUID(destID, key, direction);
+    }
+    if(_doors.count(destID) > 0 && _user == DISTANCE_AND_DIRECTIONS_USED) {
+        // calculate destID's fields
+        std::unique_lock lock(_fieldMutex);
+        RequireField(destID);
+        direction = _directionFieldWithKey.at(destID)[key];
     }
 }
 
@@ -1547,11 +1605,115 @@ void UnivFFviaFM::GetDirectionToUID(int destID, const Point& pos, Point& directi
     GetDirectionToUID(destID, _grid->GetKeyAtPoint(pos), direction);
 }
 
+void UnivFFviaFM::GetDirectionsToUIDs(
+    const std::vector<Point>& positions,
+    const std::vector<int>& destIDs,
+    std::vector<Point>& directions)
+{
+    assert(positions.size() == destIDs.size());
+    directions.assign(positions.size(), Point(0., 0.));
+
+    const auto isComputable = [this](int destID) {
+        return _doors.count(destID) > 0 && _user == DISTANCE_AND_DIRECTIONS_USED;
+    };
+
+    bool missing = false;
+    {
+        std::shared_lock lock(_fieldMutex);
+        int lastID = std::numeric_limits<int>::min();
+        for(int destID : destIDs) {
+            if(destID != lastID) {
+                lastID = destID;
+                missing = missing || (!FindDirectionField(destID) && isComputable(destID));
+            }
+        }
+    }
+    if(missing) {
+        std::unique_lock lock(_fieldMutex);
+        int lastID = std::numeric_limits<int>::min();
+        for(int destID : destIDs) {
+            if(destID != lastID) {
+                lastID = destID;
+                if(isComputable(destID)) {
+                    RequireField(destID);
+                }
+            }
+        }
+    }
+
+    // with a memory budget, fields required above may have been evicted again
+    bool evicted = false;
+    {
+        std::shared_lock lock(_fieldMutex);
+        int lastID = std::numeric_limits<int>::min();
+        const Point* field = nullptr;
+        for(std::size_t index = 0; index < positions.size(); ++index) {
+            if(destIDs[index] != lastID) {
+                lastID = destIDs[index];
+                field = FindDirectionField(lastID);
+            }
+            if(field) {
+                directions[index] = SampleDirection(field, positions[index]);
+            } else {
+                evicted = evicted || isComputable(lastID);
+            }
+        }
+    }
+    if(evicted) {
+        for(std::size_t index = 0; index < positions.size(); ++index) {
+            if(directions[index] == Point(0., 0.) && isComputable(destIDs[index])) {
+                GetDirectionToUID(destIDs[index], positions[index], directions[index]);
+            }
+        }
+    }
+}
+
+Point UnivFFviaFM::SampleDirection(const Point* field, const Point& pos) const
+{
+    const long int iMax = _grid->GetiMax();
+    const long int jMax = _grid->GetjMax();
+    const double u = (pos.x - _grid->GetxMin()) / _grid->Gethx();
+    const double v = (pos.y - _grid->GetyMin()) / _grid->Gethy();
+    const long int i0 = std::clamp(static_cast<long int>(std::floor(u)), 0L, iMax - 1);
+    const long int j0 = std::clamp(static_cast<long int>(std::floor(v)), 0L, jMax - 1);
+    const long int i1 = std::min(i0 + 1, iMax - 1);
+    const long int j1 = std::min(j0 + 1, jMax - 1);
+    const double fx = std::clamp(u - i0, 0., 1.);
+    const double fy = std::clamp(v - j0, 0., 1.);
+
+    const long int keys[4] = {j0 * iMax + i0, j0 * iMax + i1, j1 * iMax + i0, j1 * iMax + i1};
+    const double weights[4] = {
+        (1. - fx) * (1. - fy), fx * (1. - fy), (1. - fx) * fy, fx * fy};
+
+    // plain arithmetic, the operators of Point are not inlined
+    double x = 0.;
+    double y = 0.;
+    std::size_t closest = 0;
+    for(std::size_t corner = 0; corner < 4; ++corner) {
+        if(weights[corner] > weights[closest]) {
+            closest = corner;
+        }
+        const int code = _gridCode[keys[corner]];
+        if(code != WALL && code != OUTSIDE) {
+            x += field[keys[corner]].x * weights[corner];
+            y += field[keys[corner]].y * weights[corner];
+        }
+    }
+
+    const double norm = std::sqrt(x * x + y * y);
+    if(norm <= J_EPS) {
+        // no grid point around inside of the room or opposite directions cancel out
+        return field[keys[closest]];
+    }
+    return Point(x / norm, y / norm);
+}
+
 double UnivFFviaFM::GetDistance2WallAt(const Point& pos)
 {
     if(_useWallDistances || (_speedmode == FF_WALL_AVOID)) {
-        if(_costFieldWithKey[0]) {
-            return _costFieldWithKey[0][_grid->GetKeyAtPoint(pos)];
+        std::shared_lock lock(_fieldMutex);
+        if(const double* walldistance = FindCostField(0)) {
+            return walldistance[_grid->GetKeyAtPoint(pos)];
         }
     }
     return std::numeric_limits<double>::max();
@@ -1560,8 +1722,9 @@ double UnivFFviaFM::GetDistance2WallAt(const Point& pos)
 void UnivFFviaFM::GetDir2WallAt(const Point& pos, Point& p)
 {
     if(_useWallDistances || (_speedmode == FF_WALL_AVOID)) {
-        if(_directionFieldWithKey[0]) {
-            p = _directionFieldWithKey[0][_grid->GetKeyAtPoint(pos)];
+        std::shared_lock lock(_fieldMutex);
+        if(const Point* walldirection = FindDirectionField(0)) {
+            p = walldirection[_grid->GetKeyAtPoint(pos)];
         }
     } else {
         p = Point(0.0, 0.0);
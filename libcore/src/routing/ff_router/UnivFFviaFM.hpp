@@ -38,7 +38,12 @@
 #include "general/Filesystem.hpp"
 #include "general/Macros.hpp"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
@@ -46,6 +51,7 @@ class Pedestrian;
 class Room;
 class SubRoom;
 class Building;
+class DensitySpeedField;
 class Point;
 class RectGrid;
 class Line;
@@ -89,6 +95,17 @@ public:
      */
     UnivFFviaFM(Room* room, double hx, double wallAvoid, bool useWallDistances);
 
+    /**
+     * Constructs a floor field on the geometry of \p base.
+     * The grid, the marked geometry, the speed fields and the wall distance field are copied
+     * from \p base instead of being recomputed, door floor fields are not copied.
+     * @param base floor field of the same room, grid size and wall avoidance settings.
+     * @param user wanted user mode.
+     * @param mode wanted mode.
+     * @param speedMode wanted speed mode.
+     */
+    UnivFFviaFM(const UnivFFviaFM& base, int user, int mode, int speedMode);
+
     /**
      * Disable default constructor.
      */
@@ -106,6 +123,7 @@ public:
 
     /**
      * Computes floor fields for all doors.
+     * In lazy mode the existing door fields are only discarded, they get recomputed on demand.
      */
     void AddAllTargetsParallel();
 
@@ -115,6 +133,13 @@ public:
      */
     std::vector<int> GetKnownDoorUIDs();
 
+    /**
+     * Returns the number of door floor fields computed so far, recomputations of evicted fields
+     * included.
+     * @return number of computed door floor fields.
+     */
+    std::size_t GetFieldComputations() const;
+
     /**
      * Sets the usage propose.
      * @param userArg wanted user mode.
@@ -133,6 +158,30 @@ public:
      */
     void SetSpeedMode(int speedMode);
 
+    /**
+     * Enables the lazy mode. Door floor fields are then computed on their first request instead
+     * of all at once in AddAllTargetsParallel().
+     * @param lazy compute door floor fields on demand.
+     */
+    void SetLazy(bool lazy);
+
+    /**
+     * Sets the memory budget for the door floor fields. When a field is computed on demand, the
+     * least recently used fields are evicted until the new field fits into the budget. Evicted
+     * fields are recomputed when needed again. The wall distance field is never evicted. The
+     * budget only covers this floor field, and fields are only evicted when a new one is computed.
+     * @param bytes memory budget in bytes, 0 means unlimited.
+     */
+    void SetMemoryBudget(std::size_t bytes);
+
+    /**
+     * Fills the speed field used in speed mode FF_PED_SPEED. The local density of the agents at
+     * \p positions reduces the speed (see DensitySpeedField), so that jams are considered in the
+     * floor fields. Door floor fields have to be recomputed (AddAllTargetsParallel()) afterwards.
+     * @param positions positions of the agents, positions outside the grid are ignored.
+     */
+    void UpdatePedSpeed(const std::vector<Point>& positions);
+
     /**
      * Returns the cost from \p position to \p destID.
      * Using precomputed cost if available, otherwise they will get computed now.
@@ -164,6 +213,22 @@ public:
      */
     void GetDirectionToUID(int destID, const Point& pos, Point& direction);
 
+    /**
+     * \brief Gives the directions of many agents to their doors at once.
+     *
+     * Missing door fields are computed once for the whole batch. The directions are interpolated
+     * bilinearly between the four surrounding grid points, ignoring points on walls or outside
+     * of the room. Agents sorted by door reuse the field of the previous agent. Apart from
+     * \p directions, nothing is allocated.
+     * @param positions positions of the agents.
+     * @param destIDs UID of the door of each agent.
+     * @param[out] directions unit direction of each agent, (0, 0) if the door is unknown.
+     */
+    void GetDirectionsToUIDs(
+        const std::vector<Point>& positions,
+        const std::vector<int>& destIDs,
+        std::vector<Point>& directions);
+
     /**
      * Returns the distance to the closest wall of point \p pos.
      * @param pos position from which the wall distance should be returned.
@@ -226,6 +291,67 @@ private:
      */
     void GetDirectionToUID(int destID, long int key, Point& direction);
 
+    /**
+     * Interpolates the direction field \p field bilinearly at \p pos.
+     * @param field direction field of a door.
+     * @param pos position to sample.
+     * @return unit direction at \p pos, direction of the closest grid point if none of the
+     * surrounding grid points lies inside of the room.
+     */
+    Point SampleDirection(const Point* field, const Point& pos) const;
+
+    /**
+     * Returns the cost field of door \p uid if it is already computed and marks it as used.
+     * @pre \a _fieldMutex is held (shared or exclusive).
+     * @param uid UID of door.
+     * @return cost field of door \p uid, nullptr if not computed yet.
+     */
+    const double* FindCostField(int uid);
+
+    /**
+     * Returns the direction field of door \p uid if it is already computed and marks it as used.
+     * @pre \a _fieldMutex is held (shared or exclusive).
+     * @param uid UID of door.
+     * @return direction field of door \p uid, nullptr if not computed yet.
+     */
+    const Point* FindDirectionField(int uid);
+
+    /**
+     * Computes the fields of door \p uid if they are not available yet, evicting least recently
+     * used fields if the memory budget would be exceeded.
+     * @pre \a _fieldMutex is held exclusively.
+     * @param uid UID of door.
+     */
+    void RequireField(int uid);
+
+    /**
+     * Frees least recently used door fields until \p bytes additional bytes fit into the memory
+     * budget or no other field is left.
+     * @pre \a _fieldMutex is held exclusively.
+     * @param bytes number of bytes which should fit into the budget.
+     * @param keep UID of door whose fields must not be evicted.
+     */
+    void EvictFields(std::size_t bytes, int keep);
+
+    /**
+     * Frees the fields of door \p uid.
+     * @pre \a _fieldMutex is held exclusively.
+     * @param uid UID of door.
+     */
+    void FreeField(int uid);
+
+    /**
+     * Returns the memory used by the fields of a single door.
+     * @return memory used by the fields of a single door in bytes.
+     */
+    std::size_t FieldMemory() const;
+
+    /**
+     * Returns the memory currently used by all door fields (excluding the wall distance field).
+     * @return memory used by the door fields in bytes.
+     */
+    std::size_t UsedFieldMemory() const;
+
     /**
      * Set up grid for computing the floor fields.
      * @param walls walls which should be considered.
@@ -457,6 +583,17 @@ private:
      */
     std::vector<int> _uids;
 
+    /**
+     * Number of door floor fields computed so far.
+     */
+    std::size_t _fieldComputations = 0;
+
+    /**
+     * Density and speed estimation of UpdatePedSpeed, created on its first call and reused by
+     * the following ones.
+     */
+    std::unique_ptr<DensitySpeedField> _densitySpeed;
+
     /**
      * Map containing the door and the corresponding UID.
      */
@@ -466,4 +603,30 @@ private:
      * Map containing a inside point to each subroom.
      */
     std::map<SubRoom*, Point> _subRoomPtrTOinsidePoint;
+
+    /**
+     * Compute door floor fields on first request.
+     */
+    bool _lazy = false;
+
+    /**
+     * Memory budget for door floor fields in bytes, 0 means unlimited.
+     */
+    std::size_t _memoryBudget = 0;
+
+    /**
+     * Guards \a _costFieldWithKey, \a _directionFieldWithKey and \a _lastAccess. Lookups of
+     * computed fields hold it shared, computing or evicting fields holds it exclusively.
+     */
+    mutable std::shared_mutex _fieldMutex;
+
+    /**
+     * Logical time of the last access to the fields of a door, used for LRU eviction.
+     */
+    std::map<int, std::atomic<std::uint64_t>> _lastAccess;
+
+    /**
+     * Logical clock for \a _lastAccess.
+     */
+    std::atomic<std::uint64_t> _accessCounter{0};
 };
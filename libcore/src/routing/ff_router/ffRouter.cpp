@@ -46,6 +46,7 @@
  **/
 #include "ffRouter.hpp"
 
+#include "Simulation.hpp"
 #include "direction/DirectionManager.hpp"
 #include "direction/walking/DirectionStrategy.hpp"
 #include "geometry/SubRoom.hpp"
@@ -55,24 +56,34 @@
 #include "routing/ff_router/mesh/RectGrid.hpp"
 
 #include <Logger.hpp>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <queue>
 #include <stdexcept>
-
-FFRouter::FFRouter(Configuration* config, Building* building, DirectionManager* directionManager)
-    : _config(config), _directionManager(directionManager), _building(building)
+#include <unordered_map>
+
+FFRouter::FFRouter(
+    Configuration* config,
+    Building* building,
+    DirectionManager* directionManager,
+    FloorfieldRepository* floorfields)
+    : _config(config)
+    , _directionManager(directionManager)
+    , _building(building)
+    , _floorfields(floorfields)
 {
     // depending on exit_strat 8 => false, depending on exit_strat 9 => true;
     _targetWithinSubroom = (false);
+    _recalculationInterval = _config->ffQuickestInterval;
+    _quickestAsync = _config->ffQuickestAsync;
+    _quickestApplyAfterSteps = _config->ffQuickestApplyAfterSteps;
+    _timeToRecalculation = _recalculationInterval;
     CalculateFloorFields();
 }
 
-FFRouter::~FFRouter()
-{
-    // delete localffs
-    std::map<int, UnivFFviaFM*>::reverse_iterator delIter;
-    for(delIter = _floorfieldByRoomID.rbegin(); delIter != _floorfieldByRoomID.rend(); ++delIter) {
-        delete(*delIter).second;
-    }
-}
+FFRouter::~FFRouter() = default;
 
 bool FFRouter::ReInit()
 {
@@ -83,18 +94,28 @@ bool FFRouter::ReInit()
 
 void FFRouter::CalculateFloorFields()
 {
-    // cleanse maps
-    _distMatrix.clear();
-    _pathsMatrix.clear();
+    ++_geometryVersion;
+    CollectDoors();
+
+    // prepare all room-floor-fields-objects (one room = one instance)
+    _doorDistancesByRoomID.clear();
+    for(const auto& [id, _] : _building->GetAllRooms()) {
+        CalculateRoomDistances(id);
+    }
 
+    UpdateShortestPaths(true);
+}
+
+void FFRouter::CollectDoors()
+{
     // clear all maps
     _allDoorUIDs.clear();
     _exitsByUID.clear();
     _doorByUID.clear();
+    _doorUIDsByRoomID.clear();
+    _doorsToGoalUID.clear();
 
     // get all door UIDs
-    std::vector<std::pair<int, int>> roomAndCroTrVector;
-
     for(const auto& [_, trans] : _building->GetAllTransitions()) {
         _allDoorUIDs.emplace_back(trans->GetUniqueID());
         _doorByUID.insert(std::make_pair(trans->GetUniqueID(), trans));
@@ -103,11 +124,11 @@ void FFRouter::CalculateFloorFields()
         }
         Room* room1 = trans->GetRoom1();
         if(room1 != nullptr) {
-            roomAndCroTrVector.emplace_back(std::make_pair(room1->GetID(), trans->GetUniqueID()));
+            _doorUIDsByRoomID[room1->GetID()].emplace_back(trans->GetUniqueID());
         }
         Room* room2 = trans->GetRoom2();
         if(room2 != nullptr) {
-            roomAndCroTrVector.emplace_back(std::make_pair(room2->GetID(), trans->GetUniqueID()));
+            _doorUIDsByRoomID[room2->GetID()].emplace_back(trans->GetUniqueID());
         }
     }
 
@@ -116,7 +137,7 @@ void FFRouter::CalculateFloorFields()
         _doorByUID.insert(std::make_pair(cross->GetUniqueID(), cross));
         Room* room1 = cross->GetRoom1();
         if(room1 != nullptr) {
-            roomAndCroTrVector.emplace_back(std::make_pair(room1->GetID(), cross->GetUniqueID()));
+            _doorUIDsByRoomID[room1->GetID()].emplace_back(cross->GetUniqueID());
         }
     }
 
@@ -173,46 +194,29 @@ void FFRouter::CalculateFloorFields()
     // make unique
     std::sort(_allDoorUIDs.begin(), _allDoorUIDs.end());
     _allDoorUIDs.erase(std::unique(_allDoorUIDs.begin(), _allDoorUIDs.end()), _allDoorUIDs.end());
+}
 
-    // init, yet no distances, only Create map entries
-    for(auto& id1 : _allDoorUIDs) {
-        for(auto& id2 : _allDoorUIDs) {
-            std::pair<int, int> key = std::make_pair(id1, id2);
-            // distMatrix[i][j] = 0,   if i==j
-            // distMatrix[i][j] = max, else
-            double value = (id1 == id2) ? 0.0 : std::numeric_limits<double>::infinity();
-            _distMatrix.insert(std::make_pair(key, value));
-
-            // pathsMatrix[i][j] = i or j ? (follow wiki:path_reconstruction, it should be j)
-            _pathsMatrix.insert(std::make_pair(key, id2));
-        }
-    }
-
-    // prepare all room-floor-fields-objects (one room = one instance)
-    _floorfieldByRoomID.clear();
-    for(const auto& [id, room] : _building->GetAllRooms()) {
-        UnivFFviaFM* floorfield = new UnivFFviaFM{room.get(), 0.125, 0.0, false};
-
-        floorfield->SetUser(DISTANCE_MEASUREMENTS_ONLY);
-        floorfield->SetMode(CENTERPOINT);
-        floorfield->SetSpeedMode(FF_HOMO_SPEED);
-        floorfield->AddAllTargetsParallel();
-        LOG_INFO("Adding distances in Room {:d} to matrix.", id);
-        _floorfieldByRoomID.insert(std::make_pair(id, floorfield));
-    }
-
-    // nowait, because the parallel region ends directly afterwards
-    //#pragma omp for nowait
-    //@todo: @ar.graf: it would be easier to browse thru doors of each field directly after
-    //"AddAllTargetsParallel" as
-    //                 we do only want doors of same subroom anyway. BUT the router would have to
-    //                 switch from room-scope to subroom-scope. Nevertheless, we could omit the room
-    //                 info (used to access correct field), if we do it like in "ReInit()".
-    for(const auto& [roomID1, doorUID1] : roomAndCroTrVector) {
+void FFRouter::CalculateRoomDistances(int roomID)
+{
+    FloorfieldParameters parameters;
+    parameters.hx = 0.125;
+    parameters.user = DISTANCE_MEASUREMENTS_ONLY;
+    parameters.mode = CENTERPOINT;
+    parameters.speedMode = FF_HOMO_SPEED;
+    // in lazy mode the door distances below compute only the fields they need
+    parameters.lazy = _config->useLazyFloorfields;
+    parameters.memoryBudget =
+        static_cast<std::size_t>(_config->floorfieldRoomMemoryBudget * 1024 * 1024);
+    auto floorfield = _floorfields->Get(_building->GetRoom(roomID), parameters);
+    LOG_INFO("Adding distances in Room {:d} to matrix.", roomID);
+
+    auto& distances = _doorDistancesByRoomID[roomID];
+    distances.clear();
+
+    const auto& doorUIDs = _doorUIDsByRoomID[roomID];
+    for(int doorUID1 : doorUIDs) {
         // loop over upper triangular matrix (i,j) and write to (j,i) as well
-        for(const auto& [roomID2, doorUID2] : roomAndCroTrVector) {
-            if(roomID2 != roomID1)
-                continue; // we only want doors with one room in common
+        for(int doorUID2 : doorUIDs) {
             if(doorUID2 <= doorUID1)
                 continue; // calculate every path only once
             // if we exclude otherDoor.second == rctIt->second, the program loops forever
@@ -237,10 +241,9 @@ void FFRouter::CalculateFloorFields()
                 continue;
             }
 
-            UnivFFviaFM* locffptr = _floorfieldByRoomID[roomID1];
-            double tempDistance = locffptr->GetDistanceBetweenDoors(doorUID1, doorUID2);
+            double tempDistance = floorfield->GetDistanceBetweenDoors(doorUID1, doorUID2);
 
-            if(tempDistance < locffptr->GetGrid()->Gethx()) {
+            if(tempDistance < floorfield->GetGrid()->Gethx()) {
                 LOG_WARNING(
                     "Ignoring distance of doors {:d} and {:d} because it is too small: "
                     "{:.2f}.",
@@ -250,25 +253,21 @@ void FFRouter::CalculateFloorFields()
                 continue;
             }
 
-            //
-            std::pair<int, int> key_ij = std::make_pair(doorUID2, doorUID1);
-            std::pair<int, int> key_ji = std::make_pair(doorUID1, doorUID2);
-
-            if(_distMatrix.at(key_ij) > tempDistance) {
-                _distMatrix.erase(key_ij);
-                _distMatrix.erase(key_ji);
-                _distMatrix.insert(std::make_pair(key_ij, tempDistance));
-                _distMatrix.insert(std::make_pair(key_ji, tempDistance));
-            }
+            distances[std::make_pair(doorUID2, doorUID1)] = tempDistance;
+            distances[std::make_pair(doorUID1, doorUID2)] = tempDistance;
         } // otherDoor
-    } // roomAndCroTrVector
+    } // doorUIDs
 
+    _floorfieldByRoomID[roomID] = std::move(floorfield);
+}
+
+void FFRouter::CollectPenalties()
+{
     // penalize directional escalators
-    std::vector<std::pair<int, int>> penaltyList;
+    _blockedConnections.clear();
 
     if(_config->hasDirectionalEscalators) {
         _directionalEscalatorsUID.clear();
-        penaltyList.clear();
         for(const auto& room : _building->GetAllRooms()) {
             for(const auto& [_, subroom] : room.second->GetAllSubRooms()) {
                 if((subroom->GetType() == SubroomType::ESCALATOR_UP) ||
@@ -283,52 +282,204 @@ void FFRouter::CalculateFloorFields()
             assert(lineUIDs.size() == 2);
             if(escalator->IsEscalatorUp()) {
                 if(_doorByUID[lineUIDs[0]]->IsInLineSegment(escalator->GetUp())) {
-                    penaltyList.emplace_back(std::make_pair(lineUIDs[0], lineUIDs[1]));
+                    _blockedConnections.emplace(lineUIDs[0], lineUIDs[1]);
                 } else {
-                    penaltyList.emplace_back(std::make_pair(lineUIDs[1], lineUIDs[0]));
+                    _blockedConnections.emplace(lineUIDs[1], lineUIDs[0]);
                 }
             } else { // IsEscalatorDown
                 if(_doorByUID[lineUIDs[0]]->IsInLineSegment(escalator->GetUp())) {
-                    penaltyList.emplace_back(std::make_pair(lineUIDs[1], lineUIDs[0]));
+                    _blockedConnections.emplace(lineUIDs[1], lineUIDs[0]);
                 } else {
-                    penaltyList.emplace_back(std::make_pair(lineUIDs[0], lineUIDs[1]));
+                    _blockedConnections.emplace(lineUIDs[0], lineUIDs[1]);
                 }
             }
         }
     }
 
     // penalize closed doors
-    for(auto doorID : _allDoorUIDs) {
-        if(auto door = dynamic_cast<Crossing*>(_building->GetTransOrCrossByUID(doorID))) {
-            if(door->IsClose()) {
-                for(auto doorID2 : _allDoorUIDs) {
-                    if(doorID == doorID2) {
-                        continue;
-                    }
-                    std::pair<int, int> connection1 = std::make_pair(doorID, doorID2);
-                    std::pair<int, int> connection2 = std::make_pair(doorID2, doorID);
+    _closedDoorUIDs.clear();
+    for(const auto& [doorUID, door] : _doorByUID) {
+        if(door->IsClose()) {
+            _closedDoorUIDs.insert(doorUID);
+        }
+    }
+}
 
-                    if(_distMatrix.find(connection1) != _distMatrix.end()) {
-                        penaltyList.emplace_back(connection1);
-                        penaltyList.emplace_back(connection2);
-                    }
-                }
+std::map<std::pair<int, int>, double> FFRouter::BuildDoorGraph() const
+{
+    std::map<std::pair<int, int>, double> doorGraph;
+    for(const auto& [_, distances] : _doorDistancesByRoomID) {
+        for(const auto& [key, distance] : distances) {
+            if(_closedDoorUIDs.count(key.first) != 0 || _closedDoorUIDs.count(key.second) != 0 ||
+               _blockedConnections.count(key) != 0) {
+                continue;
+            }
+            // doors connecting two rooms keep the shorter distance
+            auto [iter, inserted] = doorGraph.emplace(key, distance);
+            if(!inserted) {
+                iter->second = std::min(iter->second, distance);
             }
         }
     }
+    return doorGraph;
+}
 
-    for(auto key : penaltyList) {
-        _distMatrix.erase(key);
-        _distMatrix.insert(std::make_pair(key, std::numeric_limits<double>::max()));
+void FFRouter::UpdateShortestPaths(bool rebuildAll)
+{
+    _routeCandidates.clear();
+    MarkRoutesChanged();
+    const std::set<int> previousClosedDoorUIDs = _closedDoorUIDs;
+    CollectPenalties();
+    auto doorGraph = BuildDoorGraph();
+
+    std::set<int> targets;
+    std::set<int> switchedDoorUIDs;
+    if(rebuildAll) {
+        _distMatrix.clear();
+        _pathsMatrix.clear();
+        targets.insert(_allDoorUIDs.begin(), _allDoorUIDs.end());
+    } else {
+        // opened or closed doors change the cost stored for unreachable doors
+        std::set_symmetric_difference(
+            previousClosedDoorUIDs.begin(),
+            previousClosedDoorUIDs.end(),
+            _closedDoorUIDs.begin(),
+            _closedDoorUIDs.end(),
+            std::inserter(switchedDoorUIDs, switchedDoorUIDs.end()));
+        targets = switchedDoorUIDs;
+
+        // connections with (old cost, new cost), missing connections have infinite cost
+        constexpr double inf = std::numeric_limits<double>::infinity();
+        std::map<std::pair<int, int>, std::pair<double, double>> changedConnections;
+        for(const auto& [key, cost] : _doorGraph) {
+            auto iter = doorGraph.find(key);
+            double newCost = (iter == doorGraph.end()) ? inf : iter->second;
+            if(newCost != cost) {
+                changedConnections.emplace(key, std::make_pair(cost, newCost));
+            }
+        }
+        for(const auto& [key, cost] : doorGraph) {
+            if(_doorGraph.count(key) == 0) {
+                changedConnections.emplace(key, std::make_pair(inf, cost));
+            }
+        }
+
+        for(int target : _allDoorUIDs) {
+            if(targets.count(target) == 0 && IsAffected(target, changedConnections)) {
+                targets.insert(target);
+            }
+        }
+    }
+
+    std::map<int, std::vector<std::pair<int, double>>> incoming;
+    for(const auto& [key, cost] : doorGraph) {
+        incoming[key.second].emplace_back(key.first, cost);
+    }
+    _doorGraph = std::move(doorGraph);
+
+    for(int target : targets) {
+        CalculateShortestPathsTo(target, incoming);
+    }
+
+    // doors which switched their state remain unreachable, but with a different cost
+    for(int doorUID : switchedDoorUIDs) {
+        for(int target : _allDoorUIDs) {
+            auto& distance = _distMatrix[std::make_pair(doorUID, target)];
+            if(distance >= std::numeric_limits<double>::max()) {
+                distance = UnreachableCost(doorUID, target);
+            }
+        }
+    }
+
+    LOG_INFO(
+        "ffRouter: shortest paths to {:d} of {:d} doors updated.",
+        targets.size(),
+        _allDoorUIDs.size());
+}
+
+bool FFRouter::IsAffected(
+    int target,
+    const std::map<std::pair<int, int>, std::pair<double, double>>& changedConnections) const
+{
+    for(const auto& [key, costs] : changedConnections) {
+        const auto& [from, to] = key;
+        const auto& [oldCost, newCost] = costs;
+        const double distFrom = _distMatrix.at(std::make_pair(from, target));
+        const double distTo = _distMatrix.at(std::make_pair(to, target));
+
+        if(newCost > oldCost) {
+            // a more expensive connection only matters if a shortest path uses it
+            if(distFrom < std::numeric_limits<double>::max() &&
+               _pathsMatrix.at(std::make_pair(from, target)) == to) {
+                return true;
+            }
+        } else if(distTo < std::numeric_limits<double>::max()) {
+            // a cheaper connection only matters if it shortens a path
+            if(distFrom >= std::numeric_limits<double>::max() || newCost + distTo < distFrom) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void FFRouter::CalculateShortestPathsTo(
+    int target,
+    const std::map<int, std::vector<std::pair<int, double>>>& incoming)
+{
+    // Dijkstra on the reversed door graph, next[u] is the next door on the way from u to target
+    std::unordered_map<int, double> dist{{target, 0.}};
+    std::unordered_map<int, int> next{{target, target}};
+    using QueueEntry = std::pair<double, int>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+    queue.emplace(0., target);
+
+    while(!queue.empty()) {
+        const auto [distance, door] = queue.top();
+        queue.pop();
+        if(distance > dist[door]) {
+            continue;
+        }
+        auto iter = incoming.find(door);
+        if(iter == incoming.end()) {
+            continue;
+        }
+        for(const auto& [from, cost] : iter->second) {
+            const double candidate = distance + cost;
+            auto distIter = dist.find(from);
+            if(distIter == dist.end() || candidate < distIter->second) {
+                dist[from] = candidate;
+                next[from] = door;
+                queue.emplace(candidate, from);
+            }
+        }
     }
 
-    FloydWarshall();
+    for(int door : _allDoorUIDs) {
+        std::pair<int, int> key = std::make_pair(door, target);
+        if(auto iter = dist.find(door); iter != dist.end()) {
+            _distMatrix[key] = iter->second;
+            _pathsMatrix[key] = next.at(door);
+        } else {
+            _distMatrix[key] = UnreachableCost(door, target);
+            _pathsMatrix[key] = target;
+        }
+    }
+}
+
+double FFRouter::UnreachableCost(int from, int to) const
+{
+    if(_closedDoorUIDs.count(from) != 0 || _closedDoorUIDs.count(to) != 0 ||
+       _blockedConnections.count(std::make_pair(from, to)) != 0) {
+        return std::numeric_limits<double>::max();
+    }
+    return std::numeric_limits<double>::infinity();
 }
 
 int FFRouter::FindExit(Pedestrian* p)
 {
-    auto [ped_roomid, ped_subroomid, _] = _building->GetRoomAndSubRoomIDs(p->GetPos());
-    double minDist = std::numeric_limits<double>::infinity();
+    const int ped_roomid = p->GetSubRoom()->GetRoomID();
+    const int ped_subroomid = p->GetSubRoom()->GetSubRoomID();
     int bestDoor = -1;
 
     int goalID = p->GetFinalDestination();
@@ -351,6 +502,41 @@ int FFRouter::FindExit(Pedestrian* p)
         }
     }
 
+    // among equally distant routes prefer the first final door, as candidates are ordered by
+    // door this picks the same route as iterating over all (final door, door) pairs
+    double minDist = std::numeric_limits<double>::infinity();
+    std::size_t bestFinalIndex = std::numeric_limits<std::size_t>::max();
+    for(const auto& candidate : GetRouteCandidates(ped_roomid, ped_subroomid, goalID)) {
+        double locDistToDoor =
+            _directionManager->GetDirectionStrategy().GetDistance2Target(p, candidate.doorUID);
+
+        if(locDistToDoor < -J_EPS) { // for old ff: //this can happen, if the point is not
+                                     // reachable and therefore has init val -7
+            continue;
+        }
+        const double dist = candidate.distance + locDistToDoor;
+        if(dist < minDist || (dist == minDist && candidate.finalIndex < bestFinalIndex)) {
+            minDist = dist;
+            bestFinalIndex = candidate.finalIndex;
+            bestDoor = candidate.nextDoorUID;
+        }
+    }
+
+    if(_doorByUID.count(bestDoor)) {
+        p->SetDestination(bestDoor);
+        p->SetExitLine(_doorByUID.at(bestDoor));
+    }
+    return bestDoor; //-1 if no way was found, doorUID of best, if path found
+}
+
+const std::vector<FFRouter::RouteCandidate>&
+FFRouter::GetRouteCandidates(int roomID, int subroomID, int goalID)
+{
+    const auto key = std::make_tuple(roomID, subroomID, goalID);
+    if(auto cached = _routeCandidates.find(key); cached != _routeCandidates.end()) {
+        return cached->second;
+    }
+
     std::vector<int> validFinalDoor; // UIDs of doors
 
     if(goalID == -1) {
@@ -374,111 +560,72 @@ int FFRouter::FindExit(Pedestrian* p)
     }
 
     std::vector<int> DoorUIDsOfRoom;
+    SubRoom* subroom = _building->GetRoom(roomID)->GetSubRoom(subroomID);
 
     if(!_targetWithinSubroom) {
         // candidates of current room (ID) (provided by Room)
-        for(auto transUID : _building->GetRoom(ped_roomid)->GetAllTransitionsIDs()) {
+        for(auto transUID : _building->GetRoom(roomID)->GetAllTransitionsIDs()) {
             if(_doorByUID.count(transUID) != 0) {
                 DoorUIDsOfRoom.emplace_back(transUID);
             }
         }
-        for(auto& subIPair : _building->GetRoom(ped_roomid)->GetAllSubRooms()) {
+        for(auto& subIPair : _building->GetRoom(roomID)->GetAllSubRooms()) {
             for(auto& crossI : subIPair.second->GetAllCrossings()) {
                 DoorUIDsOfRoom.emplace_back(crossI->GetUniqueID());
             }
         }
     } else {
         // candidates of current subroom only
-        for(auto& crossI :
-            _building->GetRoom(ped_roomid)->GetSubRoom(ped_subroomid)->GetAllCrossings()) {
+        for(auto& crossI : subroom->GetAllCrossings()) {
             DoorUIDsOfRoom.emplace_back(crossI->GetUniqueID());
         }
 
-        for(auto& transI :
-            _building->GetRoom(ped_roomid)->GetSubRoom(ped_subroomid)->GetAllTransitions()) {
+        for(auto& transI : subroom->GetAllTransitions()) {
             if(transI->IsOpen() || transI->IsTempClose()) {
                 DoorUIDsOfRoom.emplace_back(transI->GetUniqueID());
             }
         }
     }
 
-    int bestFinalDoor = -1; // to silence the compiler
-    for(int finalDoor : validFinalDoor) {
-        // with UIDs, we can ask for shortest path
-        for(int doorUID : DoorUIDsOfRoom) {
-            double locDistToDoor =
-                _directionManager->GetDirectionStrategy().GetDistance2Target(p, doorUID);
-
-            if(locDistToDoor < -J_EPS) { // for old ff: //this can happen, if the point is not
-                                         // reachable and therefore has init val -7
-                continue;
-            }
-            std::pair<int, int> key = std::make_pair(doorUID, finalDoor);
+    const auto subroomDoors = subroom->GetAllGoalIDs();
+    std::vector<RouteCandidate> candidates;
+    for(int doorUID : DoorUIDsOfRoom) {
+        RouteCandidate best{doorUID, std::numeric_limits<double>::infinity(), 0, -1};
+        for(std::size_t finalIndex = 0; finalIndex < validFinalDoor.size(); ++finalIndex) {
+            std::pair<int, int> key = std::make_pair(doorUID, validFinalDoor[finalIndex]);
             // only consider, if paths exists
             if(_pathsMatrix.count(key) == 0) {
                 LOG_ERROR("ffRouter: no key for {:d} {:d}", key.first, key.second);
                 continue;
             }
 
-            if((_distMatrix.count(key) != 0) &&
-               (_distMatrix.at(key) != std::numeric_limits<double>::infinity())) {
-                if((_distMatrix.at(key) + locDistToDoor) < minDist) {
-                    minDist = _distMatrix.at(key) + locDistToDoor;
-                    bestDoor = key.first; // doorUID
-                    auto subroomDoors = _building->GetSubRoom(p->GetPos())->GetAllGoalIDs();
-                    if(std::find(subroomDoors.begin(), subroomDoors.end(), _pathsMatrix[key]) !=
-                       subroomDoors.end()) {
-                        bestDoor = _pathsMatrix[key]; //@todo: @ar.graf: check this hack
-                    }
-                    bestFinalDoor = key.second;
-                }
+            if((_distMatrix.count(key) != 0) && (_distMatrix.at(key) < best.distance)) {
+                best.distance = _distMatrix.at(key);
+                best.finalIndex = finalIndex;
             }
         }
-    }
-
-    // at this point, bestDoor is either a crossing or a transition
-    if((!_targetWithinSubroom) && (_doorByUID.count(bestDoor) != 0)) {
-        while(!_doorByUID[bestDoor]->IsTransition()) {
-            std::pair<int, int> key = std::make_pair(bestDoor, bestFinalDoor);
-            bestDoor = _pathsMatrix[key];
+        if(best.distance == std::numeric_limits<double>::infinity()) {
+            continue;
         }
-    }
 
-    if(_doorByUID.count(bestDoor)) {
-        p->SetDestination(bestDoor);
-        p->SetExitLine(_doorByUID.at(bestDoor));
-    }
-    return bestDoor; //-1 if no way was found, doorUID of best, if path found
-}
+        const int bestFinalDoor = validFinalDoor[best.finalIndex];
+        std::pair<int, int> key = std::make_pair(doorUID, bestFinalDoor);
+        best.nextDoorUID = doorUID;
+        if(std::find(subroomDoors.begin(), subroomDoors.end(), _pathsMatrix[key]) !=
+           subroomDoors.end()) {
+            best.nextDoorUID = _pathsMatrix[key]; //@todo: @ar.graf: check this hack
+        }
 
-void FFRouter::FloydWarshall()
-{
-    bool change = false;
-    int totalnum = _allDoorUIDs.size();
-    for(int k = 0; k < totalnum; ++k) {
-        for(int i = 0; i < totalnum; ++i) {
-            for(int j = 0; j < totalnum; ++j) {
-                std::pair<int, int> key_ij = std::make_pair(_allDoorUIDs[i], _allDoorUIDs[j]);
-                std::pair<int, int> key_ik = std::make_pair(_allDoorUIDs[i], _allDoorUIDs[k]);
-                std::pair<int, int> key_kj = std::make_pair(_allDoorUIDs[k], _allDoorUIDs[j]);
-                if((_distMatrix[key_ik] < std::numeric_limits<double>::max()) &&
-                   (_distMatrix[key_kj] < std::numeric_limits<double>::max()) &&
-                   (_distMatrix[key_ik] + _distMatrix[key_kj] < _distMatrix[key_ij])) {
-                    _distMatrix.erase(key_ij);
-                    _distMatrix.insert(
-                        std::make_pair(key_ij, _distMatrix[key_ik] + _distMatrix[key_kj]));
-                    _pathsMatrix.erase(key_ij);
-                    _pathsMatrix.insert(std::make_pair(key_ij, _pathsMatrix[key_ik]));
-                    change = true;
-                }
+        // at this point, the next door is either a crossing or a transition
+        if((!_targetWithinSubroom) && (_doorByUID.count(best.nextDoorUID) != 0)) {
+            while(!_doorByUID[best.nextDoorUID]->IsTransition()) {
+                key = std::make_pair(best.nextDoorUID, bestFinalDoor);
+                best.nextDoorUID = _pathsMatrix[key];
             }
         }
+        candidates.emplace_back(best);
     }
-    if(change) {
-        FloydWarshall();
-    } else {
-        LOG_INFO("ffRouter: FloydWarshall done!");
-    }
+    return _routeCandidates.emplace(key, std::move(candidates)).first->second;
 }
 
 bool FFRouter::MustReInit()
@@ -495,3 +642,139 @@ void FFRouter::Update()
 {
     CalculateFloorFields();
 }
+
+void FFRouter::UpdateIncremental(
+    const std::set<int>& changedDoors,
+    const std::set<int>& changedRooms)
+{
+    if(changedRooms.empty()) {
+        LOG_INFO("ffRouter: state of {:d} doors changed.", changedDoors.size());
+        UpdateShortestPaths(false);
+        return;
+    }
+
+    // changed rooms may have gained or lost doors (e.g. train doors)
+    ++_geometryVersion;
+    const std::vector<int> previousDoorUIDs = _allDoorUIDs;
+    CollectDoors();
+    for(int roomID : changedRooms) {
+        if(_building->GetRoom(roomID) != nullptr) {
+            CalculateRoomDistances(roomID);
+        }
+    }
+    UpdateShortestPaths(previousDoorUIDs != _allDoorUIDs);
+}
+
+void FFRouter::UpdateTime(double time)
+{
+    Router::UpdateTime(time);
+    if(_recalculationInterval <= 0.) {
+        return;
+    }
+    ++_step;
+
+    if(_quickestJob.valid()) {
+        const bool ready =
+            _quickestJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        const bool due = (_quickestApplyAfterSteps > 0) ?
+                             _step >= _quickestSnapshotStep + _quickestApplyAfterSteps :
+                             ready;
+        if(due) {
+            ApplyQuickestDistances(_quickestJob.get(), _quickestSnapshotVersion);
+        }
+    }
+
+    _needsRecalculation = time >= _timeToRecalculation;
+    if(!MustReInit() || _quickestJob.valid()) {
+        return;
+    }
+    SetRecalc(time);
+    _needsRecalculation = false;
+
+    if(_quickestAsync) {
+        _quickestJob = std::async(
+            std::launch::async, &FFRouter::CalculateQuickestDistances, PrepareQuickestRooms());
+        _quickestSnapshotStep = _step;
+        _quickestSnapshotVersion = _geometryVersion;
+    } else {
+        ApplyQuickestDistances(
+            CalculateQuickestDistances(PrepareQuickestRooms()), _geometryVersion);
+    }
+}
+
+std::vector<FFRouter::QuickestRoom> FFRouter::PrepareQuickestRooms()
+{
+    for(auto iter = _quickestFieldByRoomID.begin(); iter != _quickestFieldByRoomID.end();) {
+        iter = (_doorDistancesByRoomID.count(iter->first) == 0) ?
+                   _quickestFieldByRoomID.erase(iter) :
+                   std::next(iter);
+    }
+
+    std::vector<QuickestRoom> rooms;
+    for(const auto& [roomID, distances] : _doorDistancesByRoomID) {
+        const auto& base = _floorfieldByRoomID.at(roomID);
+        auto& quickest = _quickestFieldByRoomID[roomID];
+        // the geometry of the room changed since the field was copied
+        if(quickest.base.lock() != base) {
+            quickest.base = base;
+            quickest.floorfield = std::make_shared<UnivFFviaFM>(
+                *base, DISTANCE_MEASUREMENTS_ONLY, CENTERPOINT, FF_PED_SPEED);
+        }
+        QuickestRoom room{roomID, quickest.floorfield, {}, {}};
+        for(const auto& [doors, _] : distances) {
+            if(doors.first < doors.second) {
+                room.doorPairs.emplace_back(doors);
+            }
+        }
+        rooms.emplace_back(std::move(room));
+    }
+
+    // each agent only slows down the field of its own room
+    if(_simulation != nullptr) {
+        std::map<int, std::size_t> indexByRoomID;
+        for(std::size_t index = 0; index < rooms.size(); ++index) {
+            indexByRoomID.emplace(rooms[index].roomID, index);
+        }
+        for(const auto& agent : _simulation->Agents()) {
+            const SubRoom* subroom = agent->GetSubRoom();
+            if(subroom == nullptr) {
+                continue;
+            }
+            if(auto iter = indexByRoomID.find(subroom->GetRoomID()); iter != indexByRoomID.end()) {
+                rooms[iter->second].positions.emplace_back(agent->GetPos());
+            }
+        }
+    }
+    return rooms;
+}
+
+FFRouter::DoorDistances FFRouter::CalculateQuickestDistances(std::vector<QuickestRoom> rooms)
+{
+    DoorDistances result;
+    for(const auto& room : rooms) {
+        auto& floorfield = *room.floorfield;
+        floorfield.UpdatePedSpeed(room.positions);
+        floorfield.AddAllTargetsParallel();
+
+        auto& distances = result[room.roomID];
+        for(const auto& [doorUID1, doorUID2] : room.doorPairs) {
+            const double cost = floorfield.GetDistanceBetweenDoors(doorUID1, doorUID2);
+            distances[std::make_pair(doorUID1, doorUID2)] = cost;
+            distances[std::make_pair(doorUID2, doorUID1)] = cost;
+        }
+    }
+    return result;
+}
+
+void FFRouter::ApplyQuickestDistances(DoorDistances distances, std::size_t geometryVersion)
+{
+    if(geometryVersion != _geometryVersion) {
+        LOG_INFO("ffRouter: discarding quickest paths computed on outdated geometry.");
+        return;
+    }
+    for(auto& [roomID, roomDistances] : distances) {
+        _doorDistancesByRoomID[roomID] = std::move(roomDistances);
+    }
+    LOG_INFO("ffRouter: applying quickest paths at t={:.2f}.", _currentTime);
+    UpdateShortestPaths(false);
+}
@@ -57,12 +57,21 @@
  **/
 #pragma once
 
+#include "FloorfieldRepository.hpp"
 #include "UnivFFviaFM.hpp"
 #include "general/Macros.hpp"
 #include "geometry/Building.hpp"
 #include "math/OperationalModel.hpp"
 #include "routing/Router.hpp"
 
+#include <future>
+#include <map>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 class Building;
 class Pedestrian;
 class OutputHandler;
@@ -108,8 +117,13 @@ public:
      * @param hasSpecificGoals specifies if the peds have specific goals (true) or head to the
      * outside (false).
      * @param config configuration of simulation.
+     * @param floorfields repository providing the floor fields of the rooms.
      */
-    FFRouter(Configuration* config, Building* building, DirectionManager* directionManager);
+    FFRouter(
+        Configuration* config,
+        Building* building,
+        DirectionManager* directionManager,
+        FloorfieldRepository* floorfields);
 
     /**
      * Destructor for FFRouter.
@@ -118,14 +132,38 @@ public:
 
     int FindExit(Pedestrian* p) override;
 
+    /**
+     * \brief Recomputes the door distances weighted by the agent density if quickest paths are
+     * enabled.
+     *
+     * Every \a _recalculationInterval seconds the agent positions are captured and the door
+     * distances are recomputed on floor fields slowed down by the local density. In async mode
+     * this runs in a background thread and the result is applied at the beginning of a later step,
+     * either as soon as it is ready or after a fixed number of steps (deterministic).
+     * @param time current time in simulation.
+     */
+    void UpdateTime(double time) override;
+
     void Update() override;
 
+    /**
+     * \brief Updates the router after the state of some doors or the geometry of some rooms
+     * changed.
+     *
+     * Only the floor fields and door distances of \p changedRooms are recomputed. Shortest paths
+     * are only recomputed towards doors whose paths are affected by the changed costs.
+     * @param changedDoors UIDs of the doors whose state changed
+     * @param changedRooms IDs of the rooms whose geometry changed
+     */
+    void UpdateIncremental(const std::set<int>& changedDoors, const std::set<int>& changedRooms)
+        override;
+
     /**
      * \brief ReInit the router if quickest router is used. Current position of agents is
      * considered.
      *
      * ReInit() will reconstruct the graph (nodes = doors, edges = costs) and
-     * find shortest paths via Floyd-Warshall. It will reconstruct the floorfield to
+     * find shortest paths via Dijkstra. It will reconstruct the floorfield to
      * evaluate the best doors to certain goals as they could change.
      * Will call CalculateFloorFields.
      */
@@ -147,22 +185,148 @@ public:
 
 private:
     /**
-     * \brief Performs the Floyd-Warshall algorithm.
+     * Distances between doors of the same subroom for each room.
+     */
+    using DoorDistances = std::map<int, std::map<std::pair<int, int>, double>>;
+
+    /**
+     * Door an agent may head to, independent of the position of the agent.
+     */
+    struct RouteCandidate {
+        /// UID of the door the distance of the agent is measured to
+        int doorUID;
+        /// shortest distance from the door to the nearest valid final door
+        double distance;
+        /// index of that final door, used to break ties
+        std::size_t finalIndex;
+        /// door the agent is sent to when choosing this candidate
+        int nextDoorUID;
+    };
+
+    /**
+     * \brief Returns the doors agents in a subroom heading to a goal may choose from.
      *
-     * Computes the distances depending on the costs and the corresponding paths with the
-     * Floyd-Warshall algoritm.
-     * @post \a _distMatrix contains the actual distance (cost dependent), _pathMatrix contains the
-     * corresponding paths.
+     * The candidates only depend on the subroom and the goal, they are cached until the
+     * shortest paths change.
+     * @param roomID ID of the room of the agent
+     * @param subroomID ID of the subroom of the agent
+     * @param goalID final destination of the agent, -1 for any exit
+     * @return candidate doors with reachable final door
+     */
+    const std::vector<RouteCandidate>& GetRouteCandidates(int roomID, int subroomID, int goalID);
+
+    /**
+     * Input of the density weighted distance computation for a single room.
+     */
+    struct QuickestRoom {
+        /// ID of the room
+        int roomID;
+        /// floor field slowed down by the agents, kept between the computations of the room
+        std::shared_ptr<UnivFFviaFM> floorfield;
+        /// door pairs (first < second) whose distance is needed
+        std::vector<std::pair<int, int>> doorPairs;
+        /// positions of the agents in the room
+        std::vector<Point> positions;
+    };
+
+    /**
+     * \brief Computes door distances on floor fields slowed down by the agent density.
+     *
+     * Only uses its arguments and updates the speed and targets of their floor fields, so it can
+     * run in a background thread while no other computation uses the same fields.
+     * @param rooms rooms, door pairs to compute and agent positions
+     * @return density weighted distances between doors
+     */
+    static DoorDistances CalculateQuickestDistances(std::vector<QuickestRoom> rooms);
+
+    /**
+     * Captures the input of CalculateQuickestDistances() from the current state.
+     * The density weighted floor field of a room is copied from its floor field on the first call
+     * and after the floor field changed, later calls reuse it.
+     * @return rooms, door pairs to compute and positions of the agents in each room
+     */
+    std::vector<QuickestRoom> PrepareQuickestRooms();
+
+    /**
+     * Replaces the door distances by density weighted ones and updates the shortest paths.
+     * Results computed on an outdated geometry are discarded.
+     * @param distances density weighted distances between doors
+     * @param geometryVersion \a _geometryVersion the distances were computed on
      */
-    void FloydWarshall();
+    void ApplyQuickestDistances(DoorDistances distances, std::size_t geometryVersion);
 
     /**
      * \brief Computes the needed floor fields and distances.
      *
-     * Sets up the needed maps and computes distances via FloydWarshall().
+     * Sets up the needed maps and computes all distances via UpdateShortestPaths().
      */
     void CalculateFloorFields();
 
+    /**
+     * Collects all doors, exits and the doors leading to each goal from \a _building.
+     */
+    void CollectDoors();
+
+    /**
+     * Collects the closed doors and the blocked directions of directional escalators.
+     */
+    void CollectPenalties();
+
+    /**
+     * \brief Recomputes the floor field of a room and the distances between its doors.
+     *
+     * @param roomID ID of the room
+     * @post \a _doorDistancesByRoomID[roomID] contains the distances of all door pairs sharing a
+     * subroom in this room.
+     */
+    void CalculateRoomDistances(int roomID);
+
+    /**
+     * Combines the door distances of all rooms into the door graph, omitting connections blocked
+     * by closed doors or escalators.
+     * @return costs of all passable connections between doors
+     */
+    std::map<std::pair<int, int>, double> BuildDoorGraph() const;
+
+    /**
+     * \brief Updates \a _distMatrix and \a _pathsMatrix to the current door graph.
+     *
+     * If \p rebuildAll is false, only the shortest paths towards doors which are affected by
+     * changed connections in the door graph are recomputed.
+     * @param rebuildAll recompute the shortest paths towards all doors
+     */
+    void UpdateShortestPaths(bool rebuildAll);
+
+    /**
+     * Checks if the shortest paths towards \p target may change with the new connection costs.
+     * @param target UID of the target door
+     * @param changedConnections changed connections (from, to) with (old cost, new cost)
+     * @return shortest paths towards \p target need to be recomputed
+     */
+    bool IsAffected(
+        int target,
+        const std::map<std::pair<int, int>, std::pair<double, double>>& changedConnections) const;
+
+    /**
+     * \brief Computes the shortest paths from all doors towards \p target with Dijkstra.
+     *
+     * @param target UID of the target door
+     * @param incoming incoming[v] contains all connections (u, cost) leading to door v
+     * @post \a _distMatrix and \a _pathsMatrix contain the distances and next doors towards
+     * \p target
+     */
+    void CalculateShortestPathsTo(
+        int target,
+        const std::map<int, std::vector<std::pair<int, double>>>& incoming);
+
+    /**
+     * Returns the cost stored in \a _distMatrix if \p to cannot be reached from \p from.
+     * @param from UID of the start door
+     * @param to UID of the target door
+     * @return max if the direct connection is blocked, infinity otherwise
+     */
+    double UnreachableCost(int from, int to) const;
+
 protected:
     /**
      * Configuration used during simulation.
@@ -200,7 +364,37 @@ protected:
     /**
      * Map of the underlying floorfields. _locffviafm[id] gives the floorfield in room with ID==id.
      */
-    std::map<int, UnivFFviaFM*> _floorfieldByRoomID;
+    std::map<int, std::shared_ptr<UnivFFviaFM>> _floorfieldByRoomID;
+
+    /**
+     * Repository the floor fields are shared with other floor field users.
+     */
+    FloorfieldRepository* _floorfields{};
+
+    /**
+     * UIDs of the doors (transitions and crossings) of each room.
+     */
+    std::map<int, std::vector<int>> _doorUIDsByRoomID;
+
+    /**
+     * Distances between doors of the same subroom, computed on the floor field of each room.
+     */
+    std::map<int, std::map<std::pair<int, int>, double>> _doorDistancesByRoomID;
+
+    /**
+     * Costs of the passable connections between doors the shortest paths are based on.
+     */
+    std::map<std::pair<int, int>, double> _doorGraph;
+
+    /**
+     * UIDs of all closed doors.
+     */
+    std::set<int> _closedDoorUIDs;
+
+    /**
+     * Connections (from, to) blocked by directional escalators.
+     */
+    std::set<std::pair<int, int>> _blockedConnections;
 
     /**
      * Map containing all the exits from the geometry.
@@ -227,6 +421,62 @@ protected:
      */
     bool _needsRecalculation = false;
 
+    /**
+     * Cached route candidates for (room ID, subroom ID, goal ID), cleared whenever the shortest
+     * paths are updated.
+     */
+    std::map<std::tuple<int, int, int>, std::vector<RouteCandidate>> _routeCandidates;
+
+    /**
+     * Density weighted floor field of a room and the floor field it was copied from.
+     */
+    struct QuickestField {
+        std::weak_ptr<const UnivFFviaFM> base;
+        std::shared_ptr<UnivFFviaFM> floorfield;
+    };
+
+    /**
+     * Density weighted floor fields by room ID. Their grids, wall distances and density buffers
+     * are kept between the computations of the density weighted distances. Only one computation
+     * runs at a time, so a field is never used by two threads.
+     */
+    std::map<int, QuickestField> _quickestFieldByRoomID;
+
+    /**
+     * Compute the density weighted distances in a background thread.
+     */
+    bool _quickestAsync{false};
+
+    /**
+     * Steps after which a background result is applied, 0 applies it as soon as it is ready.
+     */
+    int _quickestApplyAfterSteps{0};
+
+    /**
+     * Running background computation of density weighted distances.
+     */
+    std::future<DoorDistances> _quickestJob;
+
+    /**
+     * Step in which \a _quickestJob captured the agent positions.
+     */
+    std::size_t _quickestSnapshotStep{0};
+
+    /**
+     * \a _geometryVersion \a _quickestJob was started on.
+     */
+    std::size_t _quickestSnapshotVersion{0};
+
+    /**
+     * Number of steps seen by UpdateTime().
+     */
+    std::size_t _step{0};
+
+    /**
+     * Incremented whenever floor fields are rebuilt because of geometry changes.
+     */
+    std::size_t _geometryVersion{0};
+
     /**
      * Defines if the router is used room or subroom wise.
      */
@@ -30,6 +30,7 @@
 #include "geometry/Point.hpp"
 
 #include <Logger.hpp>
+#include <array>
 #include <cmath>
 
 // geometric interpretation of index in "directNeighbor"
@@ -66,6 +67,7 @@ public:
         _cellsizeY = other._cellsizeY;
         _iMax = other._iMax;
         _jMax = other._jMax;
+        _neighborOffsets = other._neighborOffsets;
         _initialized = other._initialized;
     }
 
@@ -103,6 +105,7 @@ public:
         _cellsizeY = hyArg;
         _iMax = iMaxArg;
         _jMax = jMaxArg;
+        _neighborOffsets = {1, _iMax, -1, -_iMax};
         _initialized = isInitializedArg;
     }
 
@@ -152,7 +155,7 @@ public:
      */
     [[nodiscard]] double GetXFromKey(long int key) const
     {
-        return std::fmod(key, _iMax) * _cellsizeX + _xMin;
+        return static_cast<double>(GetIFromKey(key)) * _cellsizeX + _xMin;
     }
 
     /**
@@ -162,7 +165,7 @@ public:
      */
     [[nodiscard]] double GetYFromKey(long int key) const
     {
-        return (static_cast<double>(key) / _iMax) * _cellsizeY + _yMin;
+        return static_cast<double>(GetJFromKey(key)) * _cellsizeY + _yMin;
     }
 
     /**
@@ -170,17 +173,14 @@ public:
      * @param key Index of cell in grid.
      * @return Index in x direction of cell \p key.
      */
-    [[nodiscard]] long int GetIFromKey(long int key) const { return std::fmod(key, _iMax); }
+    [[nodiscard]] long int GetIFromKey(long int key) const { return key % _iMax; }
 
     /**
      * Returns the index in y direction of cell \p key in grid.
      * @param key Index of cell in grid.
      * @return Index in y direction of cell \p key.
      */
-    [[nodiscard]] long int GetJFromKey(long int key) const
-    {
-        return static_cast<long int>(key / _iMax);
-    }
+    [[nodiscard]] long int GetJFromKey(long int key) const { return key / _iMax; }
 
     /**
      * Returns the key to a x- and y-coordinate.
@@ -193,7 +193,7 @@ public:
         long int i = std::lround((x - _xMin) / _cellsizeX);
         long int j = std::lround((y - _yMin) / _cellsizeY);
 
-        if(IncludesPoint(Point(x, y))) {
+        if(IncludesXY(x, y)) {
             return (j * _iMax + i); // 0-based; index of (closest gridpoint)}
         } else {
             if(x < _xMin) {
@@ -265,6 +265,7 @@ public:
                     2; // check plus 2 (one for ceil, one for starting point)
             _jMax = (long int) ((_yMax - _yMin) / _cellsizeY) + 2;
             _nPoints = _iMax * _jMax;
+            _neighborOffsets = {1, _iMax, -1, -_iMax};
             //@todo: see if necessary to align _xMax/_yMax
             _xMax = _xMin + _iMax * _cellsizeX;
             _yMax = _yMin + _jMax * _cellsizeY;
@@ -303,8 +304,8 @@ public:
      */
     [[nodiscard]] Point GetPointFromKey(const long int key) const
     {
-        long int i = key % _iMax;
-        long int j = key / _iMax; // integer division
+        const long int j = key / _iMax; // integer division
+        const long int i = key - j * _iMax;
 
         return Point(i * _cellsizeX + _xMin, j * _cellsizeY + _yMin);
     }
@@ -312,22 +313,19 @@ public:
     /**
      * Returns the indices of the neighboring cells of cell with key \p key.
      * @param key Key of cell which neighbors should be returned.
-     * @return the indices of the direct neighbors of cells \p key.
+     * @return the indices of the direct neighbors of cells \p key, -2 marks invalid neighbors.
      */
     [[nodiscard]] directNeighbor GetNeighbors(const long int key) const
     {
-        directNeighbor neighbors = {{-1, -1, -1, -1}}; // curleybrackets for struct, then for int[4]
-        long int i = GetIFromKey(key);
-        long int j = GetJFromKey(key);
-
-        // right                       //-2 marks invalid neighbor
-        neighbors.key[0] = (i == (_iMax - 1)) ? -2 : (j * _iMax + i + 1);
-        // upper
-        neighbors.key[1] = (j == (_jMax - 1)) ? -2 : ((j + 1) * _iMax + i);
-        // left
-        neighbors.key[2] = (i == 0) ? -2 : (j * _iMax + i - 1);
-        // lower
-        neighbors.key[3] = (j == 0) ? -2 : ((j - 1) * _iMax + i);
+        // one integer division, the column follows from the row
+        const long int j = key / _iMax;
+        const long int i = key - j * _iMax;
+
+        directNeighbor neighbors{};
+        neighbors.key[0] = (i == (_iMax - 1)) ? -2 : key + _neighborOffsets[0];
+        neighbors.key[1] = (j == (_jMax - 1)) ? -2 : key + _neighborOffsets[1];
+        neighbors.key[2] = (i == 0) ? -2 : key + _neighborOffsets[2];
+        neighbors.key[3] = (j == 0) ? -2 : key + _neighborOffsets[3];
 
         return neighbors;
     }
@@ -338,10 +336,21 @@ public:
      * @return \p point is included in grid.
      */
     [[nodiscard]] bool IncludesPoint(const Point& point) const
+    {
+        return IncludesXY(point.x, point.y);
+    }
+
+    /**
+     * Checks if the point (\p x, \p y) is included in grid.
+     * @param x x-coordinate.
+     * @param y y-coordinate.
+     * @return (\p x, \p y) is included in grid.
+     */
+    [[nodiscard]] bool IncludesXY(const double x, const double y) const
     {
         return !(
-            (point.x < (_xMin - _cellsizeX / 2)) || (point.x > (_xMax + _cellsizeX / 2)) ||
-            (point.y < (_yMin - _cellsizeY / 2)) || (point.y > (_yMax + _cellsizeY / 2)));
+            (x < (_xMin - _cellsizeX / 2)) || (x > (_xMax + _cellsizeX / 2)) ||
+            (y < (_yMin - _cellsizeY / 2)) || (y > (_yMax + _cellsizeY / 2)));
     }
 
 private:
@@ -390,6 +399,11 @@ private:
      */
     long int _jMax{};
 
+    /**
+     * Offsets of the keys of the direct neighbors, in the order of directNeighbor.
+     */
+    std::array<long int, 4> _neighborOffsets{};
+
     /**
      * Grid is initialized.
      */
@@ -29,11 +29,16 @@
 #include "AccessPoint.hpp"
 #include "geometry/DTriangulation.hpp"
 #include "geometry/Line.hpp"
+#include "geometry/SegmentIndex.hpp"
 #include "geometry/SubRoom.hpp"
 #include "geometry/Wall.hpp"
 #include "pedestrian/Pedestrian.hpp"
 
 #include <Logger.hpp>
+#include <algorithm>
+#include <fmt/format.h>
+#include <functional>
+#include <queue>
 #include <tinyxml.h>
 
 GlobalRouter::GlobalRouter(Building* building, const GlobalRouterParameters& parameters)
@@ -46,10 +51,7 @@ GlobalRouter::GlobalRouter(Building* building, const GlobalRouterParameters& par
     _accessPoints = std::map<int, AccessPoint*>();
     _map_id_to_index = std::map<int, int>();
     _map_index_to_id = std::map<int, int>();
-    _distMatrix = nullptr;
-    _pathsMatrix = nullptr;
     _edgeCost = 100;
-    _exitsCnt = -1;
     if(const auto success = init(); !success) {
         throw std::runtime_error("Error creating GlobalRouter");
     }
@@ -57,16 +59,6 @@ GlobalRouter::GlobalRouter(Building* building, const GlobalRouterParameters& par
 
 GlobalRouter::~GlobalRouter()
 {
-    if(_distMatrix && _pathsMatrix) {
-        for(int p = 0; p < _exitsCnt; ++p) {
-            delete[] _distMatrix[p];
-            delete[] _pathsMatrix[p];
-        }
-
-        delete[] _distMatrix;
-        delete[] _pathsMatrix;
-    }
-
     std::map<int, AccessPoint*>::const_iterator itr;
     for(itr = _accessPoints.begin(); itr != _accessPoints.end(); ++itr) {
         delete itr->second;
@@ -84,26 +76,6 @@ bool GlobalRouter::init()
         TriangulateGeometry();
     }
 
-    // initialize the distances matrix for the floydwahrshall
-    _exitsCnt = _building->GetNumberOfGoals() + _building->GetAllGoals().size();
-
-    _distMatrix = new double*[_exitsCnt];
-    _pathsMatrix = new int*[_exitsCnt];
-
-    for(int i = 0; i < _exitsCnt; ++i) {
-        _distMatrix[i] = new double[_exitsCnt];
-        _pathsMatrix[i] = new int[_exitsCnt];
-    }
-
-    // Initializing the values
-    // all nodes are disconnected
-    for(int p = 0; p < _exitsCnt; ++p) {
-        for(int r = 0; r < _exitsCnt; ++r) {
-            _distMatrix[p][r] = (r == p) ? 0.0 : FLT_MAX; /*0.0*/
-            _pathsMatrix[p][r] = p; /*0.0*/
-        }
-    }
-
     // init the access points
     int index = 0;
     for(const auto& itr : _building->GetAllHlines()) {
@@ -115,14 +87,11 @@ bool GlobalRouter::init()
 
         AccessPoint* ap = new AccessPoint(door, center);
         ap->SetNavLine(cross);
-        char friendlyName[1024];
-        sprintf(
-            friendlyName,
-            "hline_%d_room_%d_subroom_%d",
+        ap->SetFriendlyName(fmt::format(
+            "hline_{}_room_{}_subroom_{}",
             cross->GetID(),
             cross->GetRoom1()->GetID(),
-            cross->GetSubRoom1()->GetSubRoomID());
-        ap->SetFriendlyName(friendlyName);
+            cross->GetSubRoom1()->GetSubRoomID()));
 
         // save the connecting sub/rooms IDs
         int id1 = -1;
@@ -147,14 +116,11 @@ bool GlobalRouter::init()
 
         AccessPoint* ap = new AccessPoint(door, center);
         ap->SetNavLine(cross);
-        char friendlyName[1024];
-        sprintf(
-            friendlyName,
-            "cross_%d_room_%d_subroom_%d",
+        ap->SetFriendlyName(fmt::format(
+            "cross_{}_room_{}_subroom_{}",
             cross->GetID(),
             cross->GetRoom1()->GetID(),
-            cross->GetSubRoom1()->GetSubRoomID());
-        ap->SetFriendlyName(friendlyName);
+            cross->GetSubRoom1()->GetSubRoomID()));
 
         //          ap->SetClosed(cross->IsClose());
         ap->SetState(cross->GetState());
@@ -186,14 +152,11 @@ bool GlobalRouter::init()
 
         AccessPoint* ap = new AccessPoint(door, center);
         ap->SetNavLine(cross);
-        char friendlyName[1024];
-        sprintf(
-            friendlyName,
-            "trans_%d_room_%d_subroom_%d",
+        ap->SetFriendlyName(fmt::format(
+            "trans_{}_room_{}_subroom_{}",
             cross->GetID(),
             cross->GetRoom1()->GetID(),
-            cross->GetSubRoom1()->GetSubRoomID());
-        ap->SetFriendlyName(friendlyName);
+            cross->GetSubRoom1()->GetSubRoomID()));
 
         //          ap->SetClosed(cross->IsClose());
         ap->SetState(cross->GetState());
@@ -237,10 +200,41 @@ bool GlobalRouter::init()
             //  because using a double as key to map is not exact
             // double elevation =  ceilf(sub->GetMaxElevation() * 100) / 100;
             //_subroomsAtElevation[elevation].push_back(sub.get());
-            _subroomsAtElevation[sub->GetElevation(sub->GetCentroid())].push_back(sub.get());
+            Point min{FLT_MAX, FLT_MAX};
+            Point max{-FLT_MAX, -FLT_MAX};
+            const auto extend = [&min, &max](const Line& line) {
+                for(const Point& p : {line.GetPoint1(), line.GetPoint2()}) {
+                    min = Point{std::min(min.x, p.x), std::min(min.y, p.y)};
+                    max = Point{std::max(max.x, p.x), std::max(max.y, p.y)};
+                }
+            };
+            for(const auto& wall : sub->GetAllWalls()) {
+                extend(wall);
+            }
+            for(const auto& obstacle : sub->GetAllObstacles()) {
+                for(const auto& wall : obstacle->GetAllWalls()) {
+                    extend(wall);
+                }
+            }
+            for(const auto& hline : sub->GetAllHlines()) {
+                extend(*hline);
+            }
+            _subroomsAtElevation[sub->GetElevation(sub->GetCentroid())].push_back(
+                {sub.get(), min, max});
+
+            for(const auto* crossing : sub->GetAllCrossings()) {
+                _doorsOfSubRooms.emplace(crossing->GetUniqueID(), sub->GetUID());
+            }
+            for(const auto* transition : sub->GetAllTransitions()) {
+                _doorsOfSubRooms.emplace(transition->GetUniqueID(), sub->GetUID());
+            }
         }
     }
 
+    // connections between the access points, a connection found in several subrooms keeps the
+    // cost of the last one
+    std::map<std::pair<int, int>, double> edges;
+
     // loop over the rooms
     // loop over the subrooms
     // get the transitions in the subrooms
@@ -268,6 +262,8 @@ bool GlobalRouter::init()
             // process the hlines
             // process the crossings
             // process the transitions
+            // visibility is symmetric, each pair is only tested once
+            const double elevation = sub->GetElevation(sub->GetCentroid());
             for(unsigned int n1 = 0; n1 < allGoals.size(); n1++) {
                 Hline* nav1 = allGoals[n1];
                 AccessPoint* from_AP = _accessPoints[nav1->GetUniqueID()];
@@ -275,29 +271,24 @@ bool GlobalRouter::init()
                 if(from_AP->IsClosed())
                     continue;
 
-                for(unsigned int n2 = 0; n2 < allGoals.size(); n2++) {
+                for(unsigned int n2 = n1 + 1; n2 < allGoals.size(); n2++) {
                     Hline* nav2 = allGoals[n2];
                     AccessPoint* to_AP = _accessPoints[nav2->GetUniqueID()];
                     if(to_AP->IsClosed())
                         continue;
 
-                    if(n1 == n2)
-                        continue;
                     if(nav1->operator==(*nav2))
                         continue;
 
-                    double elevation = sub->GetElevation(sub->GetCentroid());
                     // special case for stairs and for convex rooms
-
-                    if(_building->IsVisible(
-                           nav1->GetCentre(),
-                           nav2->GetCentre(),
-                           _subroomsAtElevation[elevation],
-                           true)) {
+                    if(IsVisible(nav1->GetCentre(), nav2->GetCentre(), elevation)) {
                         int to_door = _map_id_to_index[nav2->GetUniqueID()];
-                        _distMatrix[from_door][to_door] =
+                        const double cost =
                             penalty * (nav1->GetCentre() - nav2->GetCentre()).Norm();
-                        from_AP->AddConnectingAP(_accessPoints[nav2->GetUniqueID()]);
+                        edges[std::make_pair(from_door, to_door)] = cost;
+                        edges[std::make_pair(to_door, from_door)] = cost;
+                        from_AP->AddConnectingAP(to_AP);
+                        to_AP->AddConnectingAP(from_AP);
                     }
                 }
             }
@@ -316,9 +307,7 @@ bool GlobalRouter::init()
         Line tmpline(line);
         to_AP->SetNavLine(&tmpline);
 
-        char friendlyName[1024];
-        sprintf(friendlyName, "finalGoal_%d_located_outside", goal->GetId());
-        to_AP->SetFriendlyName(friendlyName);
+        to_AP->SetFriendlyName(fmt::format("finalGoal_{}_located_outside", goal->GetId()));
         to_AP->AddFinalDestination(FINAL_DEST_OUT, 0.0);
         to_AP->AddFinalDestination(goal->GetId(), 0.0);
         _accessPoints[to_AP->GetID()] = to_AP;
@@ -340,18 +329,38 @@ bool GlobalRouter::init()
             int to_door = _map_id_to_index[to_AP->GetID()];
             // I assume a direct line connection between every exit connected to the outside and
             // any final goal also located outside
-            _distMatrix[from_door][to_door] =
-                _edgeCost * from_AP->GetNavLine()->DistTo(goal->GetCentroid());
+            double cost = _edgeCost * from_AP->GetNavLine()->DistTo(goal->GetCentroid());
 
             // add a penalty for goals outside due to the direct line assumption while computing the
             // distances
-            if(_distMatrix[from_door][to_door] > 10.0)
-                _distMatrix[from_door][to_door] *= 100;
+            if(cost > 10.0)
+                cost *= 100;
+            edges[std::make_pair(from_door, to_door)] = cost;
         }
     }
 
-    // run the floyd warshall algorithm
-    FloydWarshall();
+    BuildGraph(edges);
+    edges.clear();
+
+    // shortest paths to the nearest exit to the outside, the exits are visited in the order of
+    // their IDs and the first one wins on equal distances
+    const std::size_t numAPs = _accessPoints.size();
+    std::vector<double> dist;
+    std::vector<int> next;
+    std::vector<double> exitDist(numAPs, FLT_MAX);
+    std::vector<int> exitNext(numAPs, -1);
+    for(const auto& [exitID, exit_AP] : _accessPoints) {
+        if(!exit_AP->GetFinalExitToOutside())
+            continue;
+        const int exit_door = _map_id_to_index[exitID];
+        ShortestPathsTo(exit_door, dist, next);
+        for(std::size_t door = 0; door < numAPs; ++door) {
+            if(static_cast<int>(door) != exit_door && dist[door] < exitDist[door]) {
+                exitDist[door] = dist[door];
+                exitNext[door] = next[door];
+            }
+        }
+    }
 
     // set the configuration for reaching the outside
     // set the distances to all final APs
@@ -366,34 +375,9 @@ bool GlobalRouter::init()
         if(from_AP->IsClosed())
             continue;
 
-        double tmpMinDist = FLT_MAX;
-        int tmpFinalGlobalNearestID = from_door;
-
-        for(const auto& itr1 : _accessPoints) {
-            AccessPoint* to_AP = itr1.second;
-            if(from_AP->GetID() == to_AP->GetID())
-                continue;
-            if(from_AP->GetFinalExitToOutside())
-                continue;
-            // if(from_AP->GetFinalGoalOutside()) continue;
-
-            if(to_AP->GetFinalExitToOutside()) {
-                int to_door = _map_id_to_index[itr1.first];
-                if(from_door == to_door)
-                    continue;
-
-                // cout <<" checking final destination: "<< pAccessPoints[j]->GetID()<<endl;
-                double dist = _distMatrix[from_door][to_door];
-                if(dist < tmpMinDist) {
-                    tmpFinalGlobalNearestID = to_door;
-                    tmpMinDist = dist;
-                }
-            }
-        }
-
         // in the case it is the final APs
-        if(tmpFinalGlobalNearestID == from_door)
-            tmpMinDist = 0.0;
+        const bool isFinalExit = from_AP->GetFinalExitToOutside();
+        const double tmpMinDist = isFinalExit ? 0.0 : exitDist[from_door];
 
         if(tmpMinDist == FLT_MAX) {
             LOG_ERROR(
@@ -407,21 +391,10 @@ bool GlobalRouter::init()
         from_AP->AddFinalDestination(FINAL_DEST_OUT, tmpMinDist);
 
         // set the intermediate path to global final destination
-        GetPath(from_door, tmpFinalGlobalNearestID);
-
-        if(_tmpPedPath.size() >= 2) {
+        if(!isFinalExit) {
             from_AP->AddTransitAPsTo(
-                FINAL_DEST_OUT, _accessPoints[_map_index_to_id[_tmpPedPath[1]]]);
-        } else {
-            if((!from_AP->GetFinalExitToOutside()) && (!from_AP->IsClosed())) {
-                LOG_ERROR(
-                    "GlobalRouter: There is no visibility path from {} to the outside. You can "
-                    "solve this by enabling triangulation.",
-                    from_AP->GetFriendlyName());
-                return false;
-            }
+                FINAL_DEST_OUT, _accessPoints[_map_index_to_id[exitNext[from_door]]]);
         }
-        _tmpPedPath.clear();
     }
 
     // set the configuration to reach the goals specified in the ini file
@@ -438,6 +411,7 @@ bool GlobalRouter::init()
         }
 
         int to_door_matrix_index = _map_id_to_index[to_door_uid];
+        ShortestPathsTo(to_door_matrix_index, dist, next);
 
         for(const auto& itr : _accessPoints) {
             AccessPoint* from_AP = itr.second;
@@ -448,14 +422,12 @@ bool GlobalRouter::init()
             int from_door_matrix_index = _map_id_to_index[itr.first];
 
             // comment this if you want infinite as distance to unreachable destinations
-            double dist = _distMatrix[from_door_matrix_index][to_door_matrix_index];
-            from_AP->AddFinalDestination(id, dist);
+            from_AP->AddFinalDestination(id, dist[from_door_matrix_index]);
 
             // set the intermediate path
             // set the intermediate path to global final destination
-            GetPath(from_door_matrix_index, to_door_matrix_index);
-            if(_tmpPedPath.size() >= 2) {
-                from_AP->AddTransitAPsTo(id, _accessPoints[_map_index_to_id[_tmpPedPath[1]]]);
+            if(const int next_door = next[from_door_matrix_index]; next_door != -1) {
+                from_AP->AddTransitAPsTo(id, _accessPoints[_map_index_to_id[next_door]]);
             } else {
                 if(((!from_AP->IsClosed()))) {
                     LOG_ERROR(
@@ -466,7 +438,6 @@ bool GlobalRouter::init()
                     return false;
                 }
             }
-            _tmpPedPath.clear();
         }
     }
 
@@ -476,51 +447,121 @@ bool GlobalRouter::init()
 
 void GlobalRouter::Reset()
 { // clean all allocated spaces
-    if(_distMatrix && _pathsMatrix) {
-        for(int p = 0; p < _exitsCnt; ++p) {
-            delete[] _distMatrix[p];
-            delete[] _pathsMatrix[p];
-        }
-
-        delete[] _distMatrix;
-        delete[] _pathsMatrix;
-    }
-
     for(auto itr = _accessPoints.begin(); itr != _accessPoints.end(); ++itr) {
         delete itr->second;
     }
 
     _accessPoints.clear();
-    _tmpPedPath.clear();
     _map_id_to_index.clear();
     _map_index_to_id.clear();
     _mapIdToFinalDestination.clear();
+    _subroomsAtElevation.clear();
+    _doorsOfSubRooms.clear();
+    _paths.clear();
+    _incomingOffsets.clear();
+    _incomingEdges.clear();
 }
 
-void GlobalRouter::GetPath(int i, int j)
+void GlobalRouter::BuildGraph(const std::map<std::pair<int, int>, double>& edges)
 {
-    if(_distMatrix[i][j] == FLT_MAX)
-        return;
-    if(i != j)
-        GetPath(i, _pathsMatrix[i][j]);
-    _tmpPedPath.push_back(j);
+    const std::size_t numAPs = _accessPoints.size();
+    _incomingOffsets.assign(numAPs + 1, 0);
+    for(const auto& [key, _] : edges) {
+        ++_incomingOffsets[key.second + 1];
+    }
+    for(std::size_t door = 0; door < numAPs; ++door) {
+        _incomingOffsets[door + 1] += _incomingOffsets[door];
+    }
+
+    _incomingEdges.resize(edges.size());
+    std::vector<std::size_t> fill(_incomingOffsets.begin(), _incomingOffsets.end() - 1);
+    for(const auto& [key, cost] : edges) {
+        _incomingEdges[fill[key.second]++] = std::make_pair(key.first, cost);
+    }
+    LOG_DEBUG(
+        "GlobalRouter: visibility graph with {:d} access points and {:d} connections.",
+        numAPs,
+        edges.size());
 }
 
-bool GlobalRouter::GetPath(Pedestrian* ped, std::vector<Line*>& path)
+void GlobalRouter::ShortestPathsTo(int target, std::vector<double>& dist, std::vector<int>& next)
+    const
 {
-    std::vector<AccessPoint*> aps_path;
+    dist.assign(_incomingOffsets.size() - 1, FLT_MAX);
+    next.assign(_incomingOffsets.size() - 1, -1);
+    dist[target] = 0.;
+
+    using QueueEntry = std::pair<double, int>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+    queue.emplace(0., target);
+    while(!queue.empty()) {
+        const auto [distance, door] = queue.top();
+        queue.pop();
+        if(distance > dist[door]) {
+            continue;
+        }
+        for(std::size_t k = _incomingOffsets[door]; k < _incomingOffsets[door + 1]; ++k) {
+            const auto& [from, cost] = _incomingEdges[k];
+            const double candidate = distance + cost;
+            if(candidate < dist[from]) {
+                dist[from] = candidate;
+                next[from] = door;
+                queue.emplace(candidate, from);
+            }
+        }
+    }
+}
 
-    bool done = false;
+bool GlobalRouter::IsVisible(const Point& p1, const Point& p2, double elevation) const
+{
+    auto iter = _subroomsAtElevation.find(elevation);
+    if(iter == _subroomsAtElevation.end()) {
+        return _building->IsVisible(p1, p2, {}, true);
+    }
+    const Point min{std::min(p1.x, p2.x), std::min(p1.y, p2.y)};
+    const Point max{std::max(p1.x, p2.x), std::max(p1.y, p2.y)};
+    for(const auto& bounds : iter->second) {
+        // bounding box prefilter: lines outside of the bounding box of the segment can not
+        // intersect it
+        if(bounds.min.x > max.x + J_EPS || bounds.max.x < min.x - J_EPS ||
+           bounds.min.y > max.y + J_EPS || bounds.max.y < min.y - J_EPS) {
+            continue;
+        }
+        if(!bounds.subroom->IsVisible(p1, p2, true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GlobalRouter::GetPath(Pedestrian* ped, std::vector<Line*>& path)
+{
     int currentNavLine = ped->GetDestination();
     if(currentNavLine == -1) {
         currentNavLine = GetBestDefaultRandomExit(ped);
     }
-    aps_path.push_back(_accessPoints[currentNavLine]);
+    const auto& cachedPath = PathTo(currentNavLine, ped->GetFinalDestination());
+    path.insert(path.end(), cachedPath.begin(), cachedPath.end());
+    return !cachedPath.empty();
+}
+
+const std::vector<Line*>& GlobalRouter::PathTo(int apID, int finalDestination)
+{
+    const auto key = std::make_pair(apID, finalDestination);
+    if(auto iter = _paths.find(key); iter != _paths.end()) {
+        return iter->second;
+    }
+
+    auto& path = _paths[key];
+    std::vector<AccessPoint*> aps_path;
+
+    bool done = false;
+    aps_path.push_back(_accessPoints[apID]);
 
     int loop_count = 1;
     do {
         const auto& ap = aps_path.back();
-        int next_dest = ap->GetNearestTransitAPTO(ped->GetFinalDestination());
+        int next_dest = ap->GetNearestTransitAPTO(finalDestination);
 
         if(next_dest == -1)
             break; // we are done
@@ -540,62 +581,50 @@ bool GlobalRouter::GetPath(Pedestrian* ped, std::vector<Line*>& path)
         // work arround to detect a potential infinte loop.
         if(loop_count++ > 1000) {
             LOG_ERROR(
-                "A path could not be found for pedestrian [{}] going to destination [{:d}]. "
-                "Stuck in an infinite loop [{:d}]",
-                ped->GetUID(),
-                ped->GetFinalDestination(),
+                "A path could not be found from [{:d}] to destination [{:d}]. Stuck in an "
+                "infinite loop [{:d}]",
+                apID,
+                finalDestination,
                 loop_count);
-            return false;
+            return path;
         }
 
     } while(!done);
 
+    path.reserve(aps_path.size());
     for(const auto& aps : aps_path)
         path.push_back(aps->GetNavLine());
 
-    return true;
+    return path;
 }
 
-/*
- floyd_warshall()
- after calling this function dist[i][j] will the the minimum distance
- between i and j if it exists (i.e. if there's a path between i and j)
- or 0, otherwise
- */
-void GlobalRouter::FloydWarshall()
+bool GlobalRouter::IsDoorOf(const Line& line, const SubRoom& sub) const
 {
-    const int n = _building->GetNumberOfGoals() + _building->GetAllGoals().size();
-    for(int k = 0; k < n; k++) {
-        for(int i = 0; i < n; i++) {
-            for(int j = 0; j < n; j++) {
-                if(_distMatrix[i][k] + _distMatrix[k][j] < _distMatrix[i][j]) {
-                    _distMatrix[i][j] = _distMatrix[i][k] + _distMatrix[k][j];
-                    _pathsMatrix[i][j] = _pathsMatrix[k][j];
-                }
-            }
-        }
-    }
+    return _doorsOfSubRooms.count(std::make_pair(line.GetUniqueID(), sub.GetUID())) != 0;
 }
 
 int GlobalRouter::FindExit(Pedestrian* ped)
 {
     if(!_useMeshForLocalNavigation) {
-        std::vector<Line*> path;
-        GetPath(ped, path);
-        SubRoom* sub = _building->GetSubRoom(ped->GetPos());
+        int currentNavLine = ped->GetDestination();
+        if(currentNavLine == -1) {
+            currentNavLine = GetBestDefaultRandomExit(ped);
+        }
+        SubRoom* sub = ped->GetSubRoom();
 
         // return the next path which is an exit
-        for(const auto& navLine : path) {
+        for(const auto& navLine : PathTo(currentNavLine, ped->GetFinalDestination())) {
             // TODO: only set if the pedestrian is already in the subroom.
             //  cuz all lines are returned
-            if(IsCrossing(*navLine, {sub}) || IsTransition(*navLine, {sub})) {
+            if(IsDoorOf(*navLine, *sub)) {
                 int nav_id = navLine->GetUniqueID();
                 ped->SetDestination(nav_id);
                 ped->SetExitLine(navLine);
                 return nav_id;
             }
         }
-        auto [room_id, subroom_id, _] = _building->GetRoomAndSubRoomIDs(ped->GetPos());
+        const int room_id = sub->GetRoomID();
+        const int subroom_id = sub->GetSubRoomID();
         // something bad happens
         LOG_ERROR(
             "Cannot find a valid destination for ped {} located in room {:d} subroom {:d} going "
@@ -613,7 +642,7 @@ int GlobalRouter::FindExit(Pedestrian* ped)
         return GetBestDefaultRandomExit(ped);
 
     } else {
-        SubRoom* sub = _building->GetSubRoom(ped->GetPos());
+        SubRoom* sub = ped->GetSubRoom();
 
         for(const auto& apID : sub->GetAllGoalIDs()) {
             AccessPoint* ap = _accessPoints[apID];
@@ -681,7 +710,7 @@ int GlobalRouter::GetBestDefaultRandomExit(Pedestrian* ped)
     // double minDistLocal = FLT_MAX;
 
     // get the opened exits
-    SubRoom* sub = _building->GetSubRoom(ped->GetPos());
+    SubRoom* sub = ped->GetSubRoom();
 
     for(unsigned int g = 0; g < relevantAPs.size(); g++) {
         AccessPoint* ap = relevantAPs[g];
@@ -701,8 +730,7 @@ int GlobalRouter::GetBestDefaultRandomExit(Pedestrian* ped)
         // check if visible
         // only if the room is convex
         // otherwise check all rooms at that level
-        if(!_building->IsVisible(
-               posA, posC, _subroomsAtElevation[sub->GetElevation(sub->GetCentroid())], true)) {
+        if(!IsVisible(posA, posC, sub->GetElevation(sub->GetCentroid()))) {
             continue;
         }
         double dist1 = ap->GetDistanceTo(ped->GetFinalDestination());
@@ -721,7 +749,7 @@ int GlobalRouter::GetBestDefaultRandomExit(Pedestrian* ped)
         ped->SetExitLine(_accessPoints[bestAPsID]->GetNavLine());
         return bestAPsID;
     } else {
-        if(_building->GetRoom(ped->GetPos())->GetCaption() != "outside" && relevantAPs.size() > 0) {
+        if(ped->GetRoom()->GetCaption() != "outside" && relevantAPs.size() > 0) {
             // FIXME: assign the nearest and not only a random one
             //{
 
@@ -738,7 +766,7 @@ void GlobalRouter::GetRelevantRoutesTofinalDestination(
     Pedestrian* ped,
     std::vector<AccessPoint*>& relevantAPS)
 {
-    auto [room, sub] = _building->GetRoomAndSubRoom(ped->GetPos());
+    SubRoom* sub = ped->GetSubRoom();
 
     // This is best implemented by closing one door and checking if there is still a path to outside
     // and itereating over the others.
@@ -782,8 +810,7 @@ void GlobalRouter::GetRelevantRoutesTofinalDestination(
             const Point& posC = (posB - posA).Normalized() * ((posA - posB).Norm() - J_EPS) + posA;
 
             // check if visible
-            if(!_building->IsVisible(
-                   posA, posC, _subroomsAtElevation[sub->GetElevation(sub->GetCentroid())], true))
+            if(!IsVisible(posA, posC, sub->GetElevation(sub->GetCentroid())))
             // if (sub->IsVisible(posA, posC, true) == false)
             {
                 continue;
@@ -804,11 +831,7 @@ void GlobalRouter::GetRelevantRoutesTofinalDestination(
                         (posB_ - posA_).Normalized() * ((posA_ - posB_).Norm() - J_EPS) + posA_;
 
                     // it points to a destination that I can see anyway
-                    if(_building->IsVisible(
-                           posA_,
-                           posC_,
-                           _subroomsAtElevation[sub->GetElevation(sub->GetCentroid())],
-                           true))
+                    if(IsVisible(posA_, posC_, sub->GetElevation(sub->GetCentroid())))
                     // if (sub->IsVisible(posA_, posC_, true) == true)
                     {
                         relevant = false;
@@ -850,6 +873,26 @@ void GlobalRouter::TriangulateGeometry()
             if((obstacles.size() > 0) || !subroom->IsConvex()) {
                 std::vector<p2t::Triangle*> triangles = subroom->GetTriangles();
 
+                // all lines of the subroom, including the navigation lines added below
+                SegmentIndex lines;
+                for(const auto& wall : subroom->GetAllWalls()) {
+                    lines.Insert(wall);
+                }
+                for(const auto* obstacle : obstacles) {
+                    for(const auto& wall : obstacle->GetAllWalls()) {
+                        lines.Insert(wall);
+                    }
+                }
+                for(const auto* crossing : subroom->GetAllCrossings()) {
+                    lines.Insert(*crossing);
+                }
+                for(const auto* transition : subroom->GetAllTransitions()) {
+                    lines.Insert(*transition);
+                }
+                for(const auto* hline : subroom->GetAllHlines()) {
+                    lines.Insert(*hline);
+                }
+
                 for(const auto& tr : triangles) {
                     Point P0 = Point(tr->GetPoint(0)->x, tr->GetPoint(0)->y);
                     Point P1 = Point(tr->GetPoint(1)->x, tr->GetPoint(1)->y);
@@ -861,17 +904,14 @@ void GlobalRouter::TriangulateGeometry()
 
                     for(const auto& line : edges) {
                         // reduce edge that are too close 50 cm is assumed
-                        if(MinDistanceToHlines(line.GetCentre(), *subroom) <
-                           _minDistanceBetweenTriangleEdges)
+                        if(lines.IsCloserThan(line.GetCentre(), _minDistanceBetweenTriangleEdges))
                             continue;
 
                         if(MinAngle(P0, P1, P2) < _minAngleInTriangles)
                             continue;
 
-                        if((IsWall(line, {subroom.get()}) == false) &&
-                           (IsCrossing(line, {subroom.get()}) == false) &&
-                           (IsTransition(line, {subroom.get()}) == false) &&
-                           (IsHline(line, {subroom.get()}) == false)) {
+                        // no wall, crossing, transition or navigation line
+                        if(!lines.Contains(line)) {
                             // add as a Hline
                             int id = _building->GetAllHlines().size();
                             Hline* h = new Hline();
@@ -882,6 +922,7 @@ void GlobalRouter::TriangulateGeometry()
                             h->SetSubRoom1(subroom.get());
                             subroom->AddHline(h);
                             _building->AddHline(h);
+                            lines.Insert(*h);
                         }
                     }
                 }
@@ -891,92 +932,6 @@ void GlobalRouter::TriangulateGeometry()
     LOG_INFO("INFO:\tDone...");
 }
 
-bool GlobalRouter::IsWall(const Line& line, const std::vector<SubRoom*>& subrooms) const
-{
-    for(auto&& subroom : subrooms) {
-        for(auto&& obst : subroom->GetAllObstacles()) {
-            for(auto&& wall : obst->GetAllWalls()) {
-                if(line.operator==(wall))
-                    return true;
-            }
-        }
-        for(auto&& wall : subroom->GetAllWalls()) {
-            if(line.operator==(wall))
-                return true;
-        }
-    }
-
-    return false;
-}
-
-bool GlobalRouter::IsCrossing(const Line& line, const std::vector<SubRoom*>& subrooms) const
-{
-    for(auto&& subroom : subrooms) {
-        for(const auto& crossing : subroom->GetAllCrossings()) {
-            if(crossing->operator==(line))
-                return true;
-        }
-    }
-    return false;
-}
-
-bool GlobalRouter::IsTransition(const Line& line, const std::vector<SubRoom*>& subrooms) const
-{
-    for(auto&& subroom : subrooms) {
-        for(const auto& transition : subroom->GetAllTransitions()) {
-            if(transition->operator==(line))
-                return true;
-        }
-    }
-    return false;
-}
-
-bool GlobalRouter::IsHline(const Line& line, const std::vector<SubRoom*>& subrooms) const
-{
-    for(auto&& subroom : subrooms) {
-        for(const auto& hline : subroom->GetAllHlines()) {
-            if(hline->operator==(line))
-                return true;
-        }
-    }
-    return false;
-}
-
-double GlobalRouter::MinDistanceToHlines(const Point& point, const SubRoom& sub)
-{
-    double minDist = FLT_MAX;
-    for(const auto& hline : sub.GetAllHlines()) {
-        double dist = hline->DistTo(point);
-        if(dist < minDist)
-            minDist = dist;
-    }
-    for(const auto& cross : sub.GetAllCrossings()) {
-        double dist = cross->DistTo(point);
-        if(dist < minDist)
-            minDist = dist;
-    }
-    for(const auto& trans : sub.GetAllTransitions()) {
-        double dist = trans->DistTo(point);
-        if(dist < minDist)
-            minDist = dist;
-    }
-    for(const auto& wall : sub.GetAllWalls()) {
-        double dist = wall.DistTo(point);
-        if(dist < minDist)
-            minDist = dist;
-    }
-    // also to the obstacles
-    for(const auto& obst : sub.GetAllObstacles()) {
-        for(const auto& wall : obst->GetAllWalls()) {
-            double dist = wall.DistTo(point);
-            if(dist < minDist)
-                minDist = dist;
-        }
-    }
-
-    return minDist;
-}
-
 double GlobalRouter::MinAngle(const Point& p1, const Point& p2, const Point& p3)
 {
     double a = (p1 - p2).NormSquare();
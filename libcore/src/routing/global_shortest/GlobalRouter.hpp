@@ -32,7 +32,10 @@
 #include "routing/Router.hpp"
 
 #include <cfloat>
+#include <map>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 // forwarded classes
@@ -83,41 +86,43 @@ public:
 
 private:
     bool init();
-    /**
-     * Compute the intermediate paths between the two given transitions IDs
-     */
-    void GetPath(int transID1, int transID2);
-
-    /**
-     * Perform the FloydWahrshal algorithm
-     */
-    void FloydWarshall();
 
     /**
-     * @return true if the supplied line is a wall.
+     * Builds the visibility graph from the connections between the access points.
+     * @param edges cost of each connection (from index, to index)
      */
-    bool IsWall(const Line& line, const std::vector<SubRoom*>& subrooms) const;
+    void BuildGraph(const std::map<std::pair<int, int>, double>& edges);
 
     /**
-     * @return true if the supplied line is a Crossing.
+     * Computes the shortest paths from all access points to \p target with Dijkstra's algorithm
+     * on the reversed visibility graph.
+     * @param target index of the target access point
+     * @param dist distance of each access point to the target, FLT_MAX if unreachable
+     * @param next index of the next access point on the way to the target, -1 if there is none
      */
-    bool IsCrossing(const Line& line, const std::vector<SubRoom*>& subrooms) const;
+    void ShortestPathsTo(int target, std::vector<double>& dist, std::vector<int>& next) const;
 
     /**
-     * @return true if the supplied line is a Transition.
+     * Scans the subrooms at \p elevation linearly. The bounding box of their lines is only a
+     * prefilter, the exact test runs for the subrooms whose box overlaps the segment.
+     * @return true if no wall, obstacle or navigation line of the subrooms at \p elevation
+     * intersects the line between \p p1 and \p p2.
      */
-    bool IsTransition(const Line& line, const std::vector<SubRoom*>& subrooms) const;
+    bool IsVisible(const Point& p1, const Point& p2, double elevation) const;
 
     /**
-     * @return true if the supplied line is a navigation line.
+     * Returns the navigation lines from an access point to a final destination, the path is
+     * computed on the first request and cached afterwards.
+     * @param apID ID of the first access point
+     * @param finalDestination ID of the final destination
+     * @return navigation lines to cross, empty if no path was found
      */
-    bool IsHline(const Line& line, const std::vector<SubRoom*>& subrooms) const;
+    const std::vector<Line*>& PathTo(int apID, int finalDestination);
 
     /**
-     * @return the minimum distance between the point and any line in the subroom.
-     * This include walls,hline,crossings,transitions,obstacles
+     * @return true if \p line is a crossing or a transition of \p sub.
      */
-    double MinDistanceToHlines(const Point& point, const SubRoom& sub);
+    bool IsDoorOf(const Line& line, const SubRoom& sub) const;
 
     /**
      * @return the minimal angle in the the triangle formed by the three points
@@ -125,10 +130,17 @@ private:
     double MinAngle(const Point& p1, const Point& p2, const Point& p3);
 
 private:
-    int** _pathsMatrix;
-    double** _distMatrix;
+    struct SubRoomBounds {
+        SubRoom* subroom;
+        Point min;
+        Point max;
+    };
+
+    /// reversed visibility graph in compressed sparse row format, the incoming connections of
+    /// access point i are stored at [_incomingOffsets[i], _incomingOffsets[i + 1])
+    std::vector<std::size_t> _incomingOffsets;
+    std::vector<std::pair<int, double>> _incomingEdges;
     double _edgeCost;
-    int _exitsCnt;
     // if false, the router will only return the exits and not the navigations line created through
     // the mesh or inserted via the routing file. The mesh will only be used for computing the
     // distance.
@@ -137,15 +149,20 @@ private:
     // used to filter skinny edges in triangulation
     double _minDistanceBetweenTriangleEdges = -FLT_MAX;
     double _minAngleInTriangles = -FLT_MAX;
-    std::vector<int> _tmpPedPath;
     std::map<int, int> _map_id_to_index;
     std::map<int, int> _map_index_to_id;
     /// map the internal crossings/transition id to
     /// the global ID (description) for that final destination
     std::map<int, int> _mapIdToFinalDestination;
 
-    // store all subrooms at the same elevation
-    std::map<double, std::vector<SubRoom*>> _subroomsAtElevation;
+    // store all subrooms at the same elevation with the bounding box of their lines. The boxes
+    // are a linear prefilter, not a spatial index: every visibility test scans all subrooms at
+    // the elevation and only skips the exact test of those whose box misses the line.
+    std::map<double, std::vector<SubRoomBounds>> _subroomsAtElevation;
     std::map<int, AccessPoint*> _accessPoints;
+    /// (line UID, subroom UID) of the crossings and transitions of each subroom
+    std::set<std::pair<int, int>> _doorsOfSubRooms;
+    /// navigation lines from an access point to a final destination (AP ID, destination ID)
+    std::map<std::pair<int, int>, std::vector<Line*>> _paths;
     Building* _building;
 };
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace jps
+{
+/// ObjectPool hands out uninitialized storage for single objects of type T.
+///
+/// Storage is allocated in chunks of ChunkSize objects. Released storage is kept in a free list
+/// and handed out again, so creating and destroying objects does not call the global allocator
+/// for every object and objects created one after another lie next to each other in memory. The
+/// storage is only freed with the pool.
+///
+/// To use it for all objects of a class overload its operator new and operator delete:
+/// ```
+/// void* MyClass::operator new(std::size_t) { return pool.Allocate(); }
+/// void MyClass::operator delete(void* ptr) { pool.Deallocate(ptr); }
+/// ```
+/// Thread Safety: Allocate and Deallocate can be called from several threads.
+template <typename T, std::size_t ChunkSize = 1024>
+class ObjectPool
+{
+    union Slot {
+        Slot* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Slot[]>> m_chunks;
+    /// slots of the last chunk which were handed out at least once
+    std::size_t m_usedInChunk{ChunkSize};
+    Slot* m_free{nullptr};
+
+public:
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+    ~ObjectPool() = default;
+
+    /// @return storage for one object of type T
+    void* Allocate()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_free != nullptr) {
+            Slot* slot = m_free;
+            m_free = slot->next;
+            return slot->storage;
+        }
+        if(m_usedInChunk == ChunkSize) {
+            m_chunks.emplace_back(new Slot[ChunkSize]);
+            m_usedInChunk = 0;
+        }
+        return m_chunks.back()[m_usedInChunk++].storage;
+    }
+
+    /// Gives storage returned by Allocate back to the pool, the object must be destroyed.
+    void Deallocate(void* ptr)
+    {
+        if(ptr == nullptr) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto* slot = reinterpret_cast<Slot*>(ptr);
+        slot->next = m_free;
+        m_free = slot;
+    }
+
+    /// @return number of objects the allocated chunks can hold
+    std::size_t Capacity() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_chunks.size() * ChunkSize;
+    }
+};
+} // namespace jps
@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <fmt/format.h>
+#include <functional>
 #include <type_traits>
 
 namespace jps
@@ -78,3 +79,15 @@ struct formatter<::jps::UniqueID<Tag>> {
     }
 };
 } // namespace fmt
+
+namespace std
+{
+/// UniqueIDs can be used as keys of unordered containers.
+template <typename Tag, typename Integer>
+struct hash<::jps::UniqueID<Tag, Integer>> {
+    size_t operator()(::jps::UniqueID<Tag, Integer> const& p_id) const noexcept
+    {
+        return hash<Integer>{}(p_id.getID());
+    }
+};
+} // namespace std
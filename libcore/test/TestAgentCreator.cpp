@@ -0,0 +1,183 @@
+#include "IO/IniFileParser.hpp"
+#include "TwoRoomBuilding.hpp"
+#include "agent-creation/AgentCreator.hpp"
+#include "pedestrian/AgentsSource.hpp"
+#include "pedestrian/PedDistributor.hpp"
+
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+/**
+ * Project file with a group of 3 agents in room 0 and a source in room 0. Every 0.125 s step is
+ * exact in binary, so the source creates half of its 4 agents at 1 s and the other half at 3 s.
+ */
+std::string Project(int agentsMax)
+{
+    return R"(
+<header>
+  <seed>1234</seed>
+  <geometry>geometry.xml</geometry>
+  <max_sim_time>100</max_sim_time>
+</header>
+<agents operational_model_id="3">
+  <agents_distribution>
+    <group group_id="0" room_id="0" subroom_id="0" number="0" router_id="1"
+           agent_parameter_id="1"/>
+    <group group_id="1" room_id="0" subroom_id="0" number="3" router_id="1"
+           agent_parameter_id="1" x_min="6" x_max="9" y_min="1" y_max="9"/>
+  </agents_distribution>
+  <agents_sources>
+    <source id="10" caption="source" time_min="1" time_max="30" frequency="5" N_create="4"
+            agents_max=")" +
+           std::to_string(agentsMax) + R"(" group_id="0" x_min="1" x_max="5" y_min="1"
+            y_max="9" percent="0.5" rate="2" greedy="true" placement="best_candidate"/>
+  </agents_sources>
+</agents>
+<operational_models>
+  <model operational_model_id="3" description="Tordeux2015">
+    <model_parameters>
+      <stepsize>0.125</stepsize>
+      <exit_crossing_strategy>2</exit_crossing_strategy>
+      <linkedcells enabled="true" cell_size="2.2"/>
+      <force_ped a="5" D="0.1"/>
+      <force_wall a="5" D="0.02"/>
+    </model_parameters>
+    <agent_parameters agent_parameter_id="1">
+      <v0 mu="1.0" sigma="0.1"/>
+      <bmax mu="0.15" sigma="0.0"/>
+      <bmin mu="0.15" sigma="0.0"/>
+      <amin mu="0.15" sigma="0.0"/>
+      <tau mu="0.5" sigma="0.001"/>
+      <atau mu="0.0" sigma="0.0"/>
+      <T mu="1" sigma="0.001"/>
+    </agent_parameters>
+  </model>
+</operational_models>
+<route_choice_models>
+  <router router_id="1" description="global_shortest"/>
+</route_choice_models>
+)";
+}
+
+/// Two room building with the configuration read from the project file.
+struct SourceProject {
+    explicit SourceProject(int agentsMax)
+        : geometry(Project(agentsMax))
+        , config(ParseIniFile(geometry.config.iniFile))
+        , building(&config)
+    {
+    }
+
+    TwoRoomBuilding geometry;
+    Configuration config;
+    Building building;
+};
+
+/// @return number of agents by the iteration they enter
+std::map<size_t, size_t>
+Counts(const std::multimap<size_t, std::unique_ptr<Pedestrian>>& agents)
+{
+    std::map<size_t, size_t> counts;
+    for(const auto& [iteration, agent] : agents) {
+        ++counts[iteration];
+    }
+    return counts;
+}
+} // namespace
+
+TEST(AgentCreator, CreateUntilReturnsTheAgentsOfEachSourceCycle)
+{
+    SourceProject project{10};
+    AgentCreator creator(&project.config, &project.building, 100., true);
+    EXPECT_EQ(creator.MaxAgentNumber(), 13);
+
+    EXPECT_EQ(Counts(creator.CreateUntil(8)), (std::map<size_t, size_t>{{0, 3}}));
+    EXPECT_FALSE(creator.IsCompleted());
+    EXPECT_EQ(Counts(creator.CreateUntil(9)), (std::map<size_t, size_t>{{8, 2}}));
+    EXPECT_TRUE(creator.CreateUntil(24).empty());
+    EXPECT_EQ(creator.AgentsCreated(), 5);
+    EXPECT_FALSE(creator.IsCompleted());
+
+    EXPECT_EQ(Counts(creator.CreateUntil(100)), (std::map<size_t, size_t>{{24, 2}}));
+    EXPECT_TRUE(creator.IsCompleted());
+    EXPECT_EQ(creator.AgentsCreated(), 7);
+    EXPECT_EQ(creator.MaxAgentNumber(), 7);
+}
+
+TEST(AgentCreator, SourcesStopAtTheirMaximumNumberOfAgents)
+{
+    SourceProject project{3};
+    AgentCreator creator(&project.config, &project.building, 100., true);
+
+    EXPECT_EQ(
+        Counts(creator.CreateUntil(std::numeric_limits<size_t>::max())),
+        (std::map<size_t, size_t>{{0, 3}, {8, 2}, {24, 1}}));
+    EXPECT_TRUE(creator.IsCompleted());
+    EXPECT_EQ(creator.AgentsCreated(), 6);
+}
+
+TEST(AgentsSource, FillPoolRefillsUpToTheMaximumNumberOfAgents)
+{
+    SourceProject project{3};
+    std::vector<std::unique_ptr<Pedestrian>> agents;
+    PedDistributor distributor(&project.config, &agents);
+    distributor.Distribute(&project.building);
+    ASSERT_EQ(distributor.GetAgentsSources().size(), 1);
+    auto& source = *distributor.GetAgentsSources().front();
+    EXPECT_EQ(source.GetPoolSize(), 0);
+
+    source.FillPool(2, &project.building);
+    EXPECT_EQ(source.GetPoolSize(), 2);
+    source.FillPool(2, &project.building);
+    EXPECT_EQ(source.GetPoolSize(), 2);
+    EXPECT_EQ(source.GetAgentsGenerated(), 2);
+
+    std::vector<Pedestrian*> taken;
+    source.RemoveAgentsFromPool(taken, 2);
+    for(auto* ped : taken) {
+        agents.emplace_back(ped);
+    }
+    EXPECT_EQ(source.GetPoolSize(), 0);
+
+    source.FillPool(2, &project.building);
+    EXPECT_EQ(source.GetPoolSize(), 1);
+    EXPECT_EQ(source.GetAgentsGenerated(), 3);
+
+    taken.clear();
+    source.RemoveAgentsFromPool(taken, 2);
+    for(auto* ped : taken) {
+        agents.emplace_back(ped);
+    }
+    source.FillPool(2, &project.building);
+    EXPECT_EQ(source.GetPoolSize(), 0);
+    EXPECT_EQ(source.GetAgentsGenerated(), 3);
+}
+
+TEST(AgentCreator, StreamedAndUpfrontCreationCreateTheSameAgents)
+{
+    SourceProject upfrontProject{10};
+    auto upfront = CreateAllPedestrians(&upfrontProject.config, &upfrontProject.building, 100.);
+
+    SourceProject streamedProject{10};
+    AgentCreator creator(&streamedProject.config, &streamedProject.building, 100., true);
+    std::multimap<size_t, std::unique_ptr<Pedestrian>> streamed;
+    for(size_t iteration = 1; !creator.IsCompleted(); ++iteration) {
+        streamed.merge(creator.CreateUntil(iteration));
+    }
+
+    ASSERT_EQ(streamed.size(), 7);
+    ASSERT_EQ(upfront.size(), streamed.size());
+    for(auto a = upfront.begin(), b = streamed.begin(); a != upfront.end(); ++a, ++b) {
+        EXPECT_EQ(a->first, b->first);
+        EXPECT_EQ(a->second->GetPos(), b->second->GetPos());
+        EXPECT_EQ(a->second->GetGroup(), b->second->GetGroup());
+        EXPECT_DOUBLE_EQ(a->second->GetEllipse().GetV0(), b->second->GetEllipse().GetV0());
+    }
+}
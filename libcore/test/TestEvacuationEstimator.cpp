@@ -0,0 +1,104 @@
+#include <EvacuationEstimator.hpp>
+#include <gtest/gtest.h>
+
+namespace
+{
+/// room 1 of 10 m x 10 m with exit 1 at its right and exit 2 at its left wall
+FlowNetwork TwoExits(int maxUsage = std::numeric_limits<int>::max())
+{
+    FlowNetwork network;
+    network.rooms.push_back({1, 100.});
+    FlowNetwork::Door right{1, 1, -1, {10., 5.}, 1.};
+    right.maxUsage = maxUsage;
+    network.doors.push_back(right);
+    network.doors.push_back({2, 1, -1, {0., 5.}, 1.});
+    return network;
+}
+
+std::vector<EstimatorAgent> Agents(std::size_t count, const Point& position, int exitID = -1)
+{
+    return std::vector<EstimatorAgent>(count, {1, position, exitID, 0., 1.});
+}
+
+double Cumulative(const EvacuationEstimate& estimate, int doorID)
+{
+    for(const auto& exit : estimate.exits) {
+        if(exit.doorID == doorID) {
+            return exit.cumulative.back();
+        }
+    }
+    return -1.;
+}
+} // namespace
+
+TEST(EvacuationEstimator, ClearanceFollowsDoorCapacity)
+{
+    FlowNetwork network;
+    network.rooms.push_back({1, 100.});
+    network.doors.push_back({1, 1, -1, {10., 5.}, 1.});
+    const EvacuationEstimator estimator{network};
+
+    // 1 s walk to the door, then 13 agents through a door of 1.3 agents per second
+    const auto estimate = estimator.Estimate(Agents(13, {9., 5.}));
+    ASSERT_NEAR(estimate.clearanceTime, 11., 0.2);
+    ASSERT_NEAR(estimate.evacuated, 13., 1e-9);
+    ASSERT_DOUBLE_EQ(estimate.remaining, 0.);
+    ASSERT_NEAR(Cumulative(estimate, 1), 13., 1e-9);
+}
+
+TEST(EvacuationEstimator, AgentsWalkThroughRooms)
+{
+    // room 1 - door 1 - room 2 - exit 2, the exit is 10 m from door 1
+    FlowNetwork network;
+    network.rooms.push_back({1, 100.});
+    network.rooms.push_back({2, 100.});
+    network.doors.push_back({1, 1, 2, {10., 5.}, 2.});
+    network.doors.push_back({2, 2, -1, {20., 5.}, 2.});
+    const EvacuationEstimator estimator{network};
+
+    // 11 m walk, the agent passes each door of 2.6 agents per second in 0.4 s
+    const auto estimate = estimator.Estimate(Agents(1, {9., 5.}));
+    ASSERT_NEAR(estimate.clearanceTime, 11.8, 0.2);
+    ASSERT_NEAR(estimate.evacuated, 1., 1e-9);
+}
+
+TEST(EvacuationEstimator, AgentsLeaveThroughTheirExit)
+{
+    const EvacuationEstimator estimator{TwoExits()};
+
+    const auto nearest = estimator.Estimate(Agents(10, {9., 5.}));
+    ASSERT_NEAR(Cumulative(nearest, 1), 10., 1e-9);
+    ASSERT_NEAR(Cumulative(nearest, 2), 0., 1e-9);
+
+    const auto chosen = estimator.Estimate(Agents(10, {9., 5.}, 2));
+    ASSERT_NEAR(Cumulative(chosen, 1), 0., 1e-9);
+    ASSERT_NEAR(Cumulative(chosen, 2), 10., 1e-9);
+    ASSERT_GT(chosen.clearanceTime, nearest.clearanceTime + 7.);
+}
+
+TEST(EvacuationEstimator, ClosedDoorsRerouteAgents)
+{
+    const EvacuationEstimator estimator{TwoExits(5)};
+
+    const auto estimate = estimator.Estimate(Agents(10, {9., 5.}));
+    ASSERT_DOUBLE_EQ(estimate.remaining, 0.);
+    ASSERT_NEAR(Cumulative(estimate, 1), 5., 1e-9);
+    ASSERT_NEAR(Cumulative(estimate, 2), 5., 1e-9);
+    // the rerouted agents walk 10 m to exit 2
+    ASSERT_GT(estimate.clearanceTime, 10.);
+}
+
+TEST(EvacuationEstimator, TrappedAgentsRemain)
+{
+    FlowNetwork network = TwoExits(2);
+    network.doors.pop_back();
+    EvacuationEstimatorParameters parameters;
+    parameters.maxTime = 30.;
+    const EvacuationEstimator estimator{network, parameters};
+
+    // exit 1 closes after two agents, the others cannot leave and the estimate ends early
+    const auto estimate = estimator.Estimate(Agents(5, {9., 5.}));
+    ASSERT_NEAR(estimate.evacuated, 2., 1e-9);
+    ASSERT_NEAR(estimate.remaining, 3., 1e-9);
+    ASSERT_LT(estimate.clearanceTime, parameters.maxTime);
+}
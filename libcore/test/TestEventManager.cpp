@@ -0,0 +1,91 @@
+#include "SimulationClock.hpp"
+#include "events/EventManager.hpp"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+DoorEvent Door(double seconds, int doorId)
+{
+    return {
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::duration<double>(seconds)),
+        DoorEvent::Type::OPEN,
+        doorId};
+}
+
+/// @return door IDs of the events processed at each iteration up to \p iterations
+std::vector<std::vector<int>>
+ProcessAll(EventManager& manager, SimulationClock& clock, std::size_t iterations)
+{
+    std::vector<std::vector<int>> processed(iterations);
+    for(std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        manager.ProcessNextEvents(clock, [&processed, iteration](const auto& event) {
+            if constexpr(std::is_same_v<std::decay_t<decltype(event)>, DoorEvent>) {
+                processed[iteration].push_back(event.doorId);
+            }
+        });
+        clock.Advance();
+    }
+    return processed;
+}
+} // namespace
+
+TEST(EventManager, ProcessesEventsAtTheirIteration)
+{
+    SimulationClock clock{0.5};
+    EventManager manager{clock.dT()};
+    manager.AddEvent(Door(1.2, 3));
+    manager.AddEvent(Door(0., 1));
+    manager.AddEvent(Door(1., 2));
+    manager.AddEvent(Door(1.1, 4));
+    manager.AddEvent(Door(1., 5));
+    ASSERT_EQ(manager.Size(), 5);
+
+    const auto processed = ProcessAll(manager, clock, 4);
+    ASSERT_EQ(processed[0], std::vector<int>{1});
+    ASSERT_TRUE(processed[1].empty());
+    // equal times keep the order they were added in
+    ASSERT_EQ(processed[2], (std::vector<int>{2, 5}));
+    ASSERT_EQ(processed[3], (std::vector<int>{4, 3}));
+    ASSERT_FALSE(manager.HasEvents());
+}
+
+TEST(EventManager, ManyEventsAcrossTheCalendar)
+{
+    SimulationClock clock{0.01};
+    EventManager manager{clock.dT()};
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<std::size_t> iterations{0, 9999};
+    std::vector<std::size_t> expected(5000);
+    for(std::size_t id = 0; id < expected.size(); ++id) {
+        expected[id] = iterations(rng);
+        manager.AddEvent(Door(expected[id] * clock.dT(), static_cast<int>(id)));
+    }
+
+    const auto processed = ProcessAll(manager, clock, 10000);
+    std::size_t count = 0;
+    for(std::size_t iteration = 0; iteration < processed.size(); ++iteration) {
+        for(int id : processed[iteration]) {
+            ASSERT_EQ(expected[id], iteration);
+            ++count;
+        }
+    }
+    ASSERT_EQ(count, expected.size());
+    ASSERT_FALSE(manager.HasEvents());
+}
+
+TEST(EventManager, DropsEventsInThePast)
+{
+    SimulationClock clock{0.1};
+    EventManager manager{clock.dT()};
+    ProcessAll(manager, clock, 10);
+
+    manager.AddEvent(Door(0.5, 1));
+    ASSERT_FALSE(manager.HasEvents());
+    manager.AddEvent(Door(1., 2));
+    ASSERT_EQ(ProcessAll(manager, clock, 1)[0], std::vector<int>{2});
+}
@@ -0,0 +1,57 @@
+#include "IO/OutputHandler.hpp"
+#include "geometry/FlowRecorder.hpp"
+#include "pedestrian/Pedestrian.hpp"
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+class StringHandler : public OutputHandler
+{
+public:
+    std::vector<std::string> lines;
+
+    void Write(const std::string& str) override { lines.push_back(str); }
+};
+} // namespace
+
+TEST(FlowRecorder, FlushWritesPendingPassagesOnce)
+{
+    FlowRecorder recorder;
+    recorder.SetKeepRecords(true);
+    const Pedestrian::UID first;
+    const Pedestrian::UID second;
+    recorder.Record(0.5, 1, first);
+    recorder.Record(1.25, 2, second);
+    ASSERT_EQ(recorder.PendingRecords().size(), 2);
+
+    StringHandler sink;
+    recorder.Flush(sink);
+    ASSERT_TRUE(recorder.PendingRecords().empty());
+    ASSERT_EQ(sink.lines.size(), 1);
+    ASSERT_EQ(
+        sink.lines[0], fmt::format("0.5 1 {}\n1.25 2 {}", first.getID(), second.getID()));
+
+    recorder.Flush(sink);
+    ASSERT_EQ(sink.lines.size(), 1);
+    ASSERT_EQ(recorder.Passages(), 2);
+}
+
+TEST(FlowRecorder, AggregatesPassagesPerBin)
+{
+    FlowRecorder recorder{2.};
+    for(int i = 0; i < 10; ++i) {
+        recorder.Record(0.5 * i, i + 1, Pedestrian::UID{});
+    }
+    ASSERT_TRUE(recorder.PendingRecords().empty());
+    ASSERT_EQ(recorder.Passages(), 10);
+    ASSERT_EQ(recorder.PassagesPerBin(), (std::vector<std::uint32_t>{4, 4, 2}));
+    ASSERT_EQ(recorder.Passages(0., 4.), 8);
+    ASSERT_EQ(recorder.Passages(3., 4.5), 6);
+    ASSERT_EQ(recorder.Passages(10., 20.), 0);
+    ASSERT_DOUBLE_EQ(recorder.Flow(0., 4.), 2.);
+    ASSERT_DOUBLE_EQ(recorder.Flow(4., 4.), 0.);
+}
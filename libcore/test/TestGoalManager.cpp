@@ -0,0 +1,198 @@
+#include "IO/GeoFileParser.hpp"
+#include "IO/IniFileParser.hpp"
+#include "Simulation.hpp"
+#include "TwoRoomBuilding.hpp"
+#include "geometry/GoalManager.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+namespace
+{
+/**
+ * Agents released by waiting area 1 in room 0 go on to waiting area 2 or 3 in room 1 subroom 0.
+ * Waiting area 4 in room 1 subroom 1 leads to waiting area 3 or to the final goal 5. Waiting
+ * area 2 closes with its first agent, waiting areas 1 and 4 release their agents after 1 s.
+ */
+constexpr const char* PROJECT = R"(
+<header>
+  <seed>1234</seed>
+  <geometry>geometry.xml</geometry>
+  <max_sim_time>100</max_sim_time>
+</header>
+<agents operational_model_id="3">
+  <agents_distribution>
+    <group group_id="0" room_id="0" number="0" router_id="1" agent_parameter_id="1"/>
+  </agents_distribution>
+</agents>
+<operational_models>
+  <model operational_model_id="3" description="Tordeux2015">
+    <model_parameters>
+      <stepsize>0.125</stepsize>
+      <exit_crossing_strategy>2</exit_crossing_strategy>
+      <linkedcells enabled="true" cell_size="2.2"/>
+      <force_ped a="5" D="0.1"/>
+      <force_wall a="5" D="0.02"/>
+    </model_parameters>
+    <agent_parameters agent_parameter_id="1">
+      <v0 mu="1.0" sigma="0.1"/>
+      <bmax mu="0.15" sigma="0.0"/>
+      <bmin mu="0.15" sigma="0.0"/>
+      <amin mu="0.15" sigma="0.0"/>
+      <tau mu="0.5" sigma="0.001"/>
+      <atau mu="0.0" sigma="0.0"/>
+      <T mu="1" sigma="0.001"/>
+    </agent_parameters>
+  </model>
+</operational_models>
+<route_choice_models>
+  <router router_id="1" description="global_shortest"/>
+</route_choice_models>
+<routing>
+  <goals>
+    <goal id="5" final="true" caption="goal">
+      <polygon>
+        <vertex px="22" py="4"/><vertex px="24" py="4"/><vertex px="24" py="6"/>
+        <vertex px="22" py="6"/><vertex px="22" py="4"/>
+      </polygon>
+    </goal>
+    <waiting_area id="1" caption="left" min_peds="1" max_peds="30" waiting_time="1"
+                  is_open="true" room_id="0" subroom_id="0">
+      <polygon>
+        <vertex px="2" py="2"/><vertex px="8" py="2"/><vertex px="8" py="8"/>
+        <vertex px="2" py="8"/><vertex px="2" py="2"/>
+      </polygon>
+      <next_wa id="2" p="0.5"/>
+      <next_wa id="3" p="0.5"/>
+    </waiting_area>
+    <waiting_area id="2" caption="lower" min_peds="1" max_peds="1" waiting_time="100"
+                  is_open="true" room_id="1" subroom_id="0">
+      <polygon>
+        <vertex px="11" py="1"/><vertex px="14" py="1"/><vertex px="14" py="3"/>
+        <vertex px="11" py="3"/><vertex px="11" py="1"/>
+      </polygon>
+      <next_wa id="5" p="1"/>
+    </waiting_area>
+    <waiting_area id="3" caption="upper" min_peds="1" max_peds="30" waiting_time="100"
+                  is_open="true" room_id="1" subroom_id="0">
+      <polygon>
+        <vertex px="11" py="7"/><vertex px="14" py="7"/><vertex px="14" py="9"/>
+        <vertex px="11" py="9"/><vertex px="11" py="7"/>
+      </polygon>
+      <next_wa id="5" p="1"/>
+    </waiting_area>
+    <waiting_area id="4" caption="right" min_peds="1" max_peds="30" waiting_time="1"
+                  is_open="true" room_id="1" subroom_id="1">
+      <polygon>
+        <vertex px="16" py="1"/><vertex px="19" py="1"/><vertex px="19" py="9"/>
+        <vertex px="16" py="9"/><vertex px="16" py="1"/>
+      </polygon>
+      <next_wa id="3" p="0.5"/>
+      <next_wa id="5" p="0.5"/>
+    </waiting_area>
+  </goals>
+</routing>
+)";
+
+/// Simulation of the two room building with the waiting areas of the project file.
+struct WaitingAreaProject {
+    WaitingAreaProject()
+        : geometry(PROJECT)
+        , config(ParseIniFile(geometry.config.iniFile))
+        , simulation(
+              &config,
+              MakeBuilding(),
+              ParseGeometryXml(config.projectRootDir / config.geometryFile))
+    {
+    }
+
+    /// @return building of the simulation, kept in #building
+    std::unique_ptr<Building> MakeBuilding()
+    {
+        auto result = std::make_unique<Building>(&config);
+        building = result.get();
+        return result;
+    }
+
+    /// Adds agents heading to waiting area \p goal on a grid from \p min to \p max.
+    std::vector<Pedestrian::UID> AddAgents(int goal, const Point& min, const Point& max)
+    {
+        std::vector<Pedestrian::UID> ids;
+        for(double x = min.x; x <= max.x; x += 1.) {
+            for(double y = min.y; y <= max.y; y += 1.) {
+                auto agent = geometry.Agent({x, y});
+                agent->SetRouterId(1);
+                agent->SetFinalDestination(goal);
+                ids.push_back(agent->GetUID());
+                simulation.AddAgent(std::move(agent));
+            }
+        }
+        return ids;
+    }
+
+    /// @return final destinations of the agents \p ids
+    std::vector<int> Destinations(const std::vector<Pedestrian::UID>& ids) const
+    {
+        std::vector<int> destinations;
+        for(auto id : ids) {
+            destinations.push_back(simulation.Agent(id).GetFinalDestination());
+        }
+        return destinations;
+    }
+
+    TwoRoomBuilding geometry;
+    Configuration config;
+    Building* building = nullptr;
+    Simulation simulation;
+};
+
+/// @return next goals chosen for the agents leaving waiting area 1 with the seed \p seed
+std::vector<int> NextGoals(unsigned int seed)
+{
+    WaitingAreaProject project;
+    const auto ids = project.AddAgents(1, {3, 3}, {7, 6});
+    GoalManager goalManager(project.building, &project.simulation, seed);
+    goalManager.update(0.);
+    EXPECT_EQ(project.Destinations(ids), std::vector<int>(ids.size(), 1));
+    goalManager.update(2.);
+    return project.Destinations(ids);
+}
+} // namespace
+
+TEST(GoalManager, SameSeedChoosesTheSameNextGoals)
+{
+    const auto nextGoals = NextGoals(42);
+    ASSERT_EQ(nextGoals.size(), 20);
+    EXPECT_GT(std::count(nextGoals.begin(), nextGoals.end(), 2), 0);
+    EXPECT_GT(std::count(nextGoals.begin(), nextGoals.end(), 3), 0);
+    EXPECT_EQ(std::count(nextGoals.begin(), nextGoals.end(), 2) +
+                  std::count(nextGoals.begin(), nextGoals.end(), 3),
+              nextGoals.size());
+
+    EXPECT_EQ(NextGoals(42), nextGoals);
+    EXPECT_NE(NextGoals(43), nextGoals);
+}
+
+TEST(GoalManager, ClosedGoalIsOnlyAvoidedByTheWaitingAreasLeadingToIt)
+{
+    WaitingAreaProject project;
+    const auto full = project.AddAgents(2, {12, 2}, {12, 2});
+    const auto left = project.AddAgents(1, {3, 3}, {7, 6});
+    const auto right = project.AddAgents(4, {17, 2}, {18, 8});
+    GoalManager goalManager(project.building, &project.simulation, 42);
+
+    // waiting area 2 is full and closes, waiting areas 1 and 4 release their agents afterwards
+    goalManager.update(0.);
+    goalManager.update(2.);
+
+    EXPECT_EQ(project.Destinations(full), std::vector<int>{2});
+    EXPECT_EQ(project.Destinations(left), std::vector<int>(left.size(), 3));
+    const auto nextGoals = project.Destinations(right);
+    EXPECT_GT(std::count(nextGoals.begin(), nextGoals.end(), 3), 0);
+    EXPECT_GT(std::count(nextGoals.begin(), nextGoals.end(), 5), 0);
+    EXPECT_EQ(std::count(nextGoals.begin(), nextGoals.end(), 3) +
+                  std::count(nextGoals.begin(), nextGoals.end(), 5),
+              nextGoals.size());
+}
@@ -37,3 +37,80 @@ TEST(Graph, CanComuteShortestPath)
     ASSERT_EQ(g.NextVertexTo(vt2, vt4), vt4);
     ASSERT_EQ(g.NextVertexTo(vt4, vt4), vt4);
 }
+
+TEST(Graph, UsesFractionalWeights)
+{
+    Graph::Builder b{};
+    const auto vt1 = b.AddVertex({0, 0});
+    const auto vt2 = b.AddVertex({1, 0});
+    const auto vt3 = b.AddVertex({2, 0});
+    b.AddEdge(vt1, vt2, 0.4);
+    b.AddEdge(vt2, vt3, 0.4);
+    b.AddEdge(vt1, vt3, 0.9);
+
+    auto g = b.Build();
+    ASSERT_EQ(g.NextVertexTo(vt1, vt3), vt2);
+    ASSERT_DOUBLE_EQ(g.DistanceTo(vt1, vt3), 0.8);
+}
+
+TEST(Graph, BatchComputationMatchesSingleQueries)
+{
+    // grid of 10 x 10 vertices with varying weights
+    Graph::Builder b{};
+    const int n = 10;
+    for(int i = 0; i < n * n; ++i) {
+        b.AddVertex({i % n, i / n});
+    }
+    for(int i = 0; i < n * n; ++i) {
+        if(i % n != n - 1) {
+            b.AddEdge(i, i + 1, 1. + 0.1 * (i % 7));
+        }
+        if(i / n != n - 1) {
+            b.AddEdge(i, i + n, 1. + 0.1 * (i % 5));
+        }
+    }
+    const Graph reference = b.Build();
+
+    std::vector<Graph::VertexId> targets{0, 9, 42, 99};
+    auto batch = reference;
+    batch.ComputeShortestPathsTo(targets, 3);
+    auto single = reference;
+    for(auto to : targets) {
+        for(Graph::VertexId from = 0; from < n * n; ++from) {
+            ASSERT_EQ(batch.NextVertexTo(from, to), single.NextVertexTo(from, to));
+            ASSERT_DOUBLE_EQ(batch.DistanceTo(from, to), single.DistanceTo(from, to));
+        }
+    }
+}
+
+TEST(Graph, RecomputesPathsAfterWeightChanges)
+{
+    Graph::Builder b{};
+    const auto vt1 = b.AddVertex({0, 0});
+    const auto vt2 = b.AddVertex({1, 1});
+    const auto vt3 = b.AddVertex({1, -1});
+    const auto vt4 = b.AddVertex({2, 0});
+    b.AddEdge(vt1, vt2, 1);
+    b.AddEdge(vt2, vt4, 1);
+    b.AddEdge(vt1, vt3, 1.5);
+    b.AddEdge(vt3, vt4, 1);
+
+    auto g = b.Build();
+    g.ComputeShortestPathsTo({vt1, vt4});
+    ASSERT_EQ(g.NextVertexTo(vt1, vt4), vt2);
+    ASSERT_DOUBLE_EQ(g.DistanceTo(vt1, vt4), 2.);
+
+    // the shortest path gets more expensive
+    g.SetEdgeWeight(vt4, vt2, 3);
+    ASSERT_EQ(g.NextVertexTo(vt1, vt4), vt3);
+    ASSERT_DOUBLE_EQ(g.DistanceTo(vt1, vt4), 2.5);
+    ASSERT_EQ(g.NextVertexTo(vt2, vt1), vt1);
+
+    // an unused edge becomes cheap enough
+    g.SetEdgeWeight(vt2, vt4, 0.25);
+    ASSERT_EQ(g.NextVertexTo(vt1, vt4), vt2);
+    ASSERT_DOUBLE_EQ(g.DistanceTo(vt1, vt4), 1.25);
+    ASSERT_DOUBLE_EQ(g.DistanceTo(vt4, vt1), 1.25);
+
+    ASSERT_THROW(g.SetEdgeWeight(vt1, vt4, 1), std::invalid_argument);
+}
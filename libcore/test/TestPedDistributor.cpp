@@ -0,0 +1,162 @@
+#include "IO/IniFileParser.hpp"
+#include "TwoRoomBuilding.hpp"
+#include "geometry/Obstacle.hpp"
+#include "geometry/SubRoom.hpp"
+#include "geometry/Transition.hpp"
+#include "geometry/Wall.hpp"
+#include "pedestrian/PedDistributor.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+/// Agents with a = 0.2 m and b = 0.25 m, positions are 0.5 m apart and 0.25 m clear of walls.
+constexpr const char* PROJECT = R"(
+<header>
+  <seed>1234</seed>
+  <geometry>geometry.xml</geometry>
+  <max_sim_time>100</max_sim_time>
+</header>
+<agents operational_model_id="3">
+  <agents_distribution>
+    <group group_id="0" room_id="0" number="40" router_id="1" agent_parameter_id="1"/>
+    <group group_id="1" room_id="1" number="60" router_id="1" agent_parameter_id="1"/>
+    <group group_id="2" room_id="1" subroom_id="1" number="20" router_id="1"
+           agent_parameter_id="1"/>
+  </agents_distribution>
+</agents>
+<operational_models>
+  <model operational_model_id="3" description="Tordeux2015">
+    <model_parameters>
+      <stepsize>0.125</stepsize>
+      <exit_crossing_strategy>2</exit_crossing_strategy>
+      <linkedcells enabled="true" cell_size="2.2"/>
+      <force_ped a="5" D="0.1"/>
+      <force_wall a="5" D="0.02"/>
+    </model_parameters>
+    <agent_parameters agent_parameter_id="1">
+      <v0 mu="1.0" sigma="0.1"/>
+      <bmax mu="0.25" sigma="0.0"/>
+      <bmin mu="0.15" sigma="0.0"/>
+      <amin mu="0.2" sigma="0.0"/>
+      <tau mu="0.5" sigma="0.001"/>
+      <atau mu="0.0" sigma="0.0"/>
+      <T mu="1" sigma="0.001"/>
+    </agent_parameters>
+  </model>
+</operational_models>
+<route_choice_models>
+  <router router_id="1" description="global_shortest"/>
+</route_choice_models>
+)";
+
+constexpr double BUFFER = 0.25;
+constexpr double SPACING = 0.5;
+
+/**
+ * Positions of the grid which lie in the subroom and are clear of its walls, doors and
+ * obstacles, checked one by one against every barrier.
+ */
+std::vector<Point> ClearPositions(const SubRoom& sub)
+{
+    const auto& poly = sub.GetPolygon();
+    const auto [minX, maxX] = std::minmax_element(
+        poly.begin(), poly.end(), [](const auto& a, const auto& b) { return a.x < b.x; });
+    const auto [minY, maxY] = std::minmax_element(
+        poly.begin(), poly.end(), [](const auto& a, const auto& b) { return a.y < b.y; });
+
+    std::vector<Line> barriers(sub.GetAllWalls().begin(), sub.GetAllWalls().end());
+    for(const auto* door : sub.GetAllTransitions()) {
+        barriers.push_back(*door);
+    }
+    for(const auto* obstacle : sub.GetAllObstacles()) {
+        barriers.insert(
+            barriers.end(), obstacle->GetAllWalls().begin(), obstacle->GetAllWalls().end());
+    }
+
+    std::vector<Point> positions;
+    for(double x = minX->x; x < maxX->x; x += SPACING) {
+        for(double y = minY->y; y < maxY->y;) {
+            y += SPACING;
+            const Point pos{x, y};
+            const bool clear =
+                sub.IsInSubRoom(pos) &&
+                std::none_of(
+                    barriers.begin(),
+                    barriers.end(),
+                    [&pos](const auto& line) { return line.DistTo(pos) < BUFFER; }) &&
+                std::none_of(
+                    sub.GetAllObstacles().begin(),
+                    sub.GetAllObstacles().end(),
+                    [&pos](const auto* obstacle) { return obstacle->Contains(pos); });
+            if(clear) {
+                positions.push_back(pos);
+            }
+        }
+    }
+    return positions;
+}
+} // namespace
+
+TEST(PedDistributor, PossiblePositionsAreClearOfWallsDoorsAndObstacles)
+{
+    TwoRoomBuilding geometry{PROJECT};
+    Configuration config = ParseIniFile(geometry.config.iniFile);
+    std::vector<std::unique_ptr<Pedestrian>> agents;
+    PedDistributor distributor(&config, &agents);
+
+    // L-shaped subroom with a slanted wall, a door on the right and a box in the lower arm
+    NormalSubRoom sub;
+    const std::vector<Point> corners{
+        {0, 0}, {10, 0}, {10, 1}, {10, 3}, {10, 4}, {4, 4}, {3, 10}, {0, 10}};
+    for(std::size_t i = 0; i < corners.size(); ++i) {
+        if(i != 2) {
+            sub.AddWall(Wall(corners[i], corners[(i + 1) % corners.size()]));
+        }
+    }
+    Transition door;
+    door.SetPoint1({10, 1});
+    door.SetPoint2({10, 3});
+    door.SetSubRoom1(&sub);
+    sub.AddTransition(&door);
+    std::vector<Line*> doors{&door};
+    ASSERT_TRUE(sub.ConvertLineToPoly(doors));
+
+    auto* box = new Obstacle();
+    const std::vector<Point> boxCorners{{6, 1}, {7.3, 1}, {7.3, 2.6}, {6, 2.6}};
+    for(std::size_t i = 0; i < boxCorners.size(); ++i) {
+        box->AddWall(Wall(boxCorners[i], boxCorners[(i + 1) % boxCorners.size()]));
+    }
+    ASSERT_TRUE(box->ConvertLineToPoly());
+    sub.AddObstacle(box);
+    ASSERT_TRUE(sub.CreateBoostPoly());
+
+    const auto expected = ClearPositions(sub);
+    ASSERT_GT(expected.size(), 100);
+    ASSERT_EQ(distributor.PossiblePositions(sub), expected);
+}
+
+TEST(PedDistributor, DistributionDoesNotDependOnTheThreads)
+{
+    TwoRoomBuilding geometry{PROJECT};
+    Configuration config = ParseIniFile(geometry.config.iniFile);
+    Building building{&config};
+
+    std::vector<std::unique_ptr<Pedestrian>> serial;
+    ASSERT_TRUE(PedDistributor(&config, &serial).Distribute(&building, 1));
+    std::vector<std::unique_ptr<Pedestrian>> threaded;
+    ASSERT_TRUE(PedDistributor(&config, &threaded).Distribute(&building, 4));
+
+    ASSERT_EQ(serial.size(), 120);
+    ASSERT_EQ(threaded.size(), serial.size());
+    for(std::size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(threaded[i]->GetPos(), serial[i]->GetPos());
+        EXPECT_EQ(threaded[i]->GetGroup(), serial[i]->GetGroup());
+        EXPECT_EQ(threaded[i]->GetSubRoom(), serial[i]->GetSubRoom());
+    }
+}
@@ -0,0 +1,121 @@
+#include "IO/GeoFileParser.hpp"
+#include "IO/IniFileParser.hpp"
+#include "Simulation.hpp"
+#include "TwoRoomBuilding.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+/// Project file without agents, the tests add them to the simulation.
+constexpr const char* PROJECT = R"(
+<header>
+  <seed>1234</seed>
+  <geometry>geometry.xml</geometry>
+  <max_sim_time>100</max_sim_time>
+</header>
+<agents operational_model_id="3">
+  <agents_distribution>
+    <group group_id="0" room_id="0" number="0" router_id="1" agent_parameter_id="1"/>
+  </agents_distribution>
+</agents>
+<operational_models>
+  <model operational_model_id="3" description="Tordeux2015">
+    <model_parameters>
+      <stepsize>0.125</stepsize>
+      <exit_crossing_strategy>2</exit_crossing_strategy>
+      <linkedcells enabled="true" cell_size="2.2"/>
+      <force_ped a="5" D="0.1"/>
+      <force_wall a="5" D="0.02"/>
+    </model_parameters>
+    <agent_parameters agent_parameter_id="1">
+      <v0 mu="1.0" sigma="0.1"/>
+      <bmax mu="0.15" sigma="0.0"/>
+      <bmin mu="0.15" sigma="0.0"/>
+      <amin mu="0.15" sigma="0.0"/>
+      <tau mu="0.5" sigma="0.001"/>
+      <atau mu="0.0" sigma="0.0"/>
+      <T mu="1" sigma="0.001"/>
+    </agent_parameters>
+  </model>
+</operational_models>
+<route_choice_models>
+  <router router_id="1" description="global_shortest"/>
+</route_choice_models>
+)";
+
+/// Simulation of the two room building with \p count agents in room 0.
+struct SimulationProject {
+    explicit SimulationProject(int count)
+        : geometry(PROJECT)
+        , config(ParseIniFile(geometry.config.iniFile))
+        , simulation(
+              &config,
+              std::make_unique<Building>(&config),
+              ParseGeometryXml(config.projectRootDir / config.geometryFile))
+    {
+        for(int i = 0; i < count; ++i) {
+            auto agent = geometry.Agent({2. + i % 4, 2. + i / 4});
+            agent->SetRouterId(1);
+            ids.push_back(agent->GetUID());
+            simulation.AddAgent(std::move(agent));
+        }
+    }
+
+    /// @return IDs of the agents of the simulation in their order
+    std::vector<Pedestrian::UID> AgentIDs() const
+    {
+        std::vector<Pedestrian::UID> result;
+        for(const auto& agent : simulation.Agents()) {
+            result.push_back(agent->GetUID());
+        }
+        return result;
+    }
+
+    TwoRoomBuilding geometry;
+    Configuration config;
+    Simulation simulation;
+    /// IDs of the agents in the order they were added
+    std::vector<Pedestrian::UID> ids;
+};
+} // namespace
+
+TEST(Simulation, RemovedAgentsAreGoneAndTheOthersKeepTheirOrder)
+{
+    SimulationProject project{8};
+    const auto& ids = project.ids;
+    ASSERT_EQ(project.AgentIDs(), ids);
+
+    const Pedestrian::UID unknown{};
+    project.simulation.RemoveAgents({ids[6], ids[1], unknown, ids[4], ids[1]});
+
+    const std::vector<Pedestrian::UID> survivors{ids[0], ids[2], ids[3], ids[5], ids[7]};
+    ASSERT_EQ(project.AgentIDs(), survivors);
+    for(const auto& id : survivors) {
+        EXPECT_EQ(project.simulation.Agent(id).GetUID(), id);
+    }
+    for(const auto& id : {ids[1], ids[4], ids[6], unknown}) {
+        EXPECT_THROW(project.simulation.Agent(id), std::logic_error);
+    }
+
+    project.simulation.RemoveAgents({ids[7], ids[0]});
+    ASSERT_EQ(project.AgentIDs(), (std::vector<Pedestrian::UID>{ids[2], ids[3], ids[5]}));
+    for(const auto& id : {ids[2], ids[3], ids[5]}) {
+        EXPECT_EQ(project.simulation.Agent(id).GetUID(), id);
+    }
+}
+
+TEST(Simulation, RemovingNoKnownAgentsKeepsAllAgents)
+{
+    SimulationProject project{3};
+    project.simulation.RemoveAgents({});
+    project.simulation.RemoveAgents({Pedestrian::UID{}});
+
+    ASSERT_EQ(project.AgentIDs(), project.ids);
+    for(const auto& id : project.ids) {
+        EXPECT_EQ(project.simulation.Agent(id).GetUID(), id);
+    }
+}
@@ -0,0 +1,309 @@
+#include "SimulationHelper.hpp"
+#include "TwoRoomBuilding.hpp"
+#include "geometry/SubRoom.hpp"
+#include "geometry/TrainGeometryInterface.hpp"
+#include "geometry/Transition.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+/// Pedestrian located at \p from which has moved to \p to in the last step.
+std::unique_ptr<Pedestrian> Moved(Building& building, const Point& from, const Point& to)
+{
+    auto ped = std::make_unique<Pedestrian>();
+    ped->SetPos(from);
+    const auto [room, subroom] = building.LocateSubRoom(from, nullptr);
+    ped->UpdateRoom(room, subroom);
+    ped->SetPos(to);
+    return ped;
+}
+
+/// Pedestrians spread over both rooms taking random steps, and pedestrians crossing each door.
+std::vector<std::unique_ptr<Pedestrian>> Crowd(Building& building)
+{
+    std::vector<std::unique_ptr<Pedestrian>> peds;
+    std::mt19937 generator{42};
+    std::uniform_real_distribution<double> step{-0.3, 0.3};
+    for(double x = 0.125; x < 20; x += 0.25) {
+        for(double y = 0.125; y < 10; y += 0.25) {
+            peds.push_back(Moved(building, {x, y}, {x + step(generator), y + step(generator)}));
+        }
+    }
+    for(double door : {0., 10., 15., 20.}) {
+        for(double y = 4.1; y < 6; y += 0.1) {
+            if(door > 0) {
+                peds.push_back(Moved(building, {door - 0.2, y}, {door + 0.2, y}));
+            }
+            if(door < 20) {
+                peds.push_back(Moved(building, {door + 0.2, y}, {door - 0.2, y}));
+            }
+        }
+    }
+    return peds;
+}
+
+/// @return room and subroom IDs of each pedestrian, -1 outside of the geometry
+std::vector<std::tuple<int, int>>
+Locations(const std::vector<std::unique_ptr<Pedestrian>>& peds)
+{
+    std::vector<std::tuple<int, int>> locations;
+    for(const auto& ped : peds) {
+        const SubRoom* subroom = ped->GetSubRoom();
+        locations.emplace_back(
+            subroom ? subroom->GetRoomID() : -1, subroom ? subroom->GetSubRoomID() : -1);
+    }
+    return locations;
+}
+
+/// @return index of the pedestrians in \p peds whose UIDs are in \p uids, in the order of uids
+std::vector<std::size_t> Indices(
+    const std::vector<std::unique_ptr<Pedestrian>>& peds,
+    const std::vector<Pedestrian::UID>& uids)
+{
+    std::map<Pedestrian::UID, std::size_t> index;
+    for(std::size_t i = 0; i < peds.size(); ++i) {
+        index.emplace(peds[i]->GetUID(), i);
+    }
+    std::vector<std::size_t> result;
+    for(const auto& uid : uids) {
+        result.push_back(index.at(uid));
+    }
+    return result;
+}
+
+/// @return passing times, usage and passing pedestrian of each door, by door ID
+std::map<int, std::vector<std::tuple<double, int, std::size_t>>>
+Passages(Building& building, const std::vector<std::unique_ptr<Pedestrian>>& peds)
+{
+    std::map<int, std::vector<std::tuple<double, int, std::size_t>>> passages;
+    for(const auto& [id, door] : building.GetAllTransitions()) {
+        for(const auto& record : door->GetFlowRecorder().PendingRecords()) {
+            passages[id].emplace_back(
+                record.time, record.usage, Indices(peds, {record.pedId}).front());
+        }
+    }
+    return passages;
+}
+
+/// Router which sends every pedestrian to the same door and counts how often it was asked.
+class CountingRouter : public Router
+{
+public:
+    int FindExit(Pedestrian* ped) override
+    {
+        ++calls[ped];
+        return 1;
+    }
+
+    void Update() override {}
+
+    std::map<const Pedestrian*, int> calls;
+};
+
+/// @return number of route decisions per pedestrian
+std::vector<int> Decisions(
+    const CountingRouter& router,
+    const std::vector<std::unique_ptr<Pedestrian>>& peds)
+{
+    std::vector<int> decisions;
+    for(const auto& ped : peds) {
+        const auto calls = router.calls.find(ped.get());
+        decisions.push_back(calls == router.calls.end() ? 0 : calls->second);
+    }
+    return decisions;
+}
+
+void KeepFlowRecords(Building& building)
+{
+    for(const auto& [id, door] : building.GetAllTransitions()) {
+        door->GetFlowRecorder().SetKeepRecords(true);
+    }
+}
+} // namespace
+
+TEST(SimulationHelper, UpdateLocationsCountsPassagesAndCollectsOutside)
+{
+    TwoRoomBuilding geometry;
+    Building& building = *geometry.building;
+    KeepFlowRecords(building);
+
+    std::vector<std::unique_ptr<Pedestrian>> peds;
+    // stays in room 0
+    peds.push_back(Moved(building, {5, 5}, {5.2, 5}));
+    // through exit 2 to outside, the door is searched in the subroom the agent left
+    peds.push_back(Moved(building, {0.2, 5}, {-0.2, 5}));
+    // through transition 1 into room 1
+    peds.push_back(Moved(building, {9.8, 5}, {10.2, 5}));
+    // through crossing 0, crossings are not counted
+    peds.push_back(Moved(building, {14.8, 5}, {15.2, 5}));
+    // through transition 1 while heading for exit 3, passing other doors is not counted
+    peds.push_back(Moved(building, {9.8, 4.5}, {10.2, 4.5}));
+    peds.back()->SetDestination(building.GetTransition(3)->GetUniqueID());
+
+    const auto outside = SimulationHelper::UpdateLocations(building, peds, 2.5);
+    ASSERT_EQ(outside, std::vector<Pedestrian::UID>{peds[1]->GetUID()});
+    ASSERT_EQ(
+        Locations(peds),
+        (std::vector<std::tuple<int, int>>{{0, 0}, {-1, -1}, {1, 0}, {1, 1}, {1, 0}}));
+    ASSERT_EQ(building.GetTransition(1)->GetDoorUsage(), 1);
+    ASSERT_EQ(building.GetTransition(2)->GetDoorUsage(), 1);
+    ASSERT_EQ(building.GetTransition(3)->GetDoorUsage(), 0);
+    ASSERT_EQ(
+        Passages(building, peds)[1],
+        (std::vector<std::tuple<double, int, std::size_t>>{{2.5, 1, 2}}));
+}
+
+TEST(SimulationHelper, UpdateLocationsWithThreadsMatchesSerial)
+{
+    TwoRoomBuilding serialGeometry;
+    TwoRoomBuilding threadedGeometry;
+    Building& serialBuilding = *serialGeometry.building;
+    Building& threadedBuilding = *threadedGeometry.building;
+    KeepFlowRecords(serialBuilding);
+    KeepFlowRecords(threadedBuilding);
+
+    const auto serialPeds = Crowd(serialBuilding);
+    const auto threadedPeds = Crowd(threadedBuilding);
+    ASSERT_GE(serialPeds.size(), 3000);
+
+    const auto serialOutside =
+        SimulationHelper::UpdateLocations(serialBuilding, serialPeds, 1., 1);
+    const auto threadedOutside =
+        SimulationHelper::UpdateLocations(threadedBuilding, threadedPeds, 1., 4);
+
+    ASSERT_EQ(Locations(serialPeds), Locations(threadedPeds));
+    const auto outside = Indices(serialPeds, serialOutside);
+    ASSERT_FALSE(outside.empty());
+    ASSERT_EQ(outside, Indices(threadedPeds, threadedOutside));
+
+    const auto passages = Passages(serialBuilding, serialPeds);
+    ASSERT_EQ(passages.size(), 3);
+    ASSERT_EQ(passages, Passages(threadedBuilding, threadedPeds));
+}
+
+TEST(SimulationHelper, TrainDoorsCloseWhenTheTrainIsFull)
+{
+    TwoRoomBuilding geometry;
+    Building& building = *geometry.building;
+    const int trainID = 7;
+    building.AddTrainType(trainID, TrainType{"RE", 2, 10., {}});
+
+    std::vector<Transition*> doors;
+    for(int id : {100, 101}) {
+        auto* door = new Transition();
+        door->SetID(id);
+        door->SetType("Train_7");
+        building.AddTransition(door);
+        building.AddTrainDoorAdded(trainID, door);
+        doors.push_back(door);
+    }
+    const auto usage = [&building, trainID]() {
+        return building.GetTrainDoorUsage().at(trainID)._usage;
+    };
+
+    // passages through doors of no train are not counted
+    building.IncreaseTrainDoorUsage(building.GetTransition(1)->GetUniqueID(), 5);
+    ASSERT_EQ(usage(), 0);
+
+    building.IncreaseTrainDoorUsage(doors[0]->GetUniqueID(), 1);
+    building.IncreaseTrainDoorUsage(doors[1]->GetUniqueID(), 1);
+    ASSERT_EQ(usage(), 2);
+    ASSERT_TRUE(SimulationHelper::UpdateTrainFlowRegulation(building, 1.).empty());
+    ASSERT_FALSE(doors[0]->IsClose());
+
+    building.IncreaseTrainDoorUsage(doors[1]->GetUniqueID(), 1);
+    ASSERT_EQ(
+        SimulationHelper::UpdateTrainFlowRegulation(building, 2.),
+        (std::vector<int>{doors[0]->GetUniqueID(), doors[1]->GetUniqueID()}));
+    ASSERT_TRUE(doors[0]->IsClose());
+    ASSERT_TRUE(doors[1]->IsClose());
+    // closed doors are only reported once
+    ASSERT_TRUE(SimulationHelper::UpdateTrainFlowRegulation(building, 3.).empty());
+
+    // the train departs, its doors are no longer counted
+    building.ClearTrainDoorsAdded(trainID);
+    ASSERT_TRUE(building.GetTrainDoorUsage().empty());
+    building.IncreaseTrainDoorUsage(doors[0]->GetUniqueID(), 1);
+    ASSERT_TRUE(building.GetTrainDoorUsage().empty());
+}
+
+TEST(SimulationHelper, FindExitStaggersRouteDecisions)
+{
+    TwoRoomBuilding geometry;
+    const int period = 4;
+    std::vector<std::unique_ptr<Pedestrian>> peds;
+    for(int i = 0; i < 100; ++i) {
+        peds.push_back(geometry.Agent({0.5 + 0.5 * (i % 10), 0.5 + 0.5 * (i / 10)}));
+    }
+    CountingRouter router;
+    const auto step = [&router, &peds, period](std::uint64_t iteration) {
+        for(const auto& ped : peds) {
+            ASSERT_EQ(SimulationHelper::FindExit(router, *ped, iteration, period), 1);
+        }
+    };
+
+    // without a route all pedestrians decide at once
+    step(0);
+    ASSERT_EQ(Decisions(router, peds), std::vector<int>(peds.size(), 1));
+
+    // afterwards a quarter of them re-decides in each step, each one once per period
+    for(std::uint64_t iteration = 1; iteration <= period; ++iteration) {
+        router.calls.clear();
+        step(iteration);
+        const auto decisions = Decisions(router, peds);
+        ASSERT_EQ(
+            static_cast<std::size_t>(std::count(decisions.begin(), decisions.end(), 1)),
+            peds.size() / period);
+    }
+    router.calls.clear();
+    for(std::uint64_t iteration = 1; iteration <= period; ++iteration) {
+        step(iteration);
+    }
+    ASSERT_EQ(Decisions(router, peds), std::vector<int>(peds.size(), 1));
+
+    // a period of 1 routes every pedestrian in every step
+    router.calls.clear();
+    for(const auto& ped : peds) {
+        SimulationHelper::FindExit(router, *ped, 7, 1);
+    }
+    ASSERT_EQ(Decisions(router, peds), std::vector<int>(peds.size(), 1));
+}
+
+TEST(SimulationHelper, FindExitDecidesAgainWhenTheRouteIsOutdated)
+{
+    TwoRoomBuilding geometry;
+    const int period = 1000;
+    auto ped = geometry.Agent({5, 5});
+    CountingRouter router;
+    // it is not the turn of the pedestrian in the next steps
+    std::uint64_t iteration = period - ped->GetUID().getID() % period + 1;
+    const auto decisions = [&router, &ped, &iteration, period]() {
+        SimulationHelper::FindExit(router, *ped, iteration++, period);
+        return router.calls[ped.get()];
+    };
+    ASSERT_EQ(decisions(), 1);
+    ASSERT_EQ(decisions(), 1);
+
+    // the routes changed, e.g. quickest paths computed in the background were applied
+    router.MarkRoutesChanged();
+    ASSERT_EQ(decisions(), 2);
+    ASSERT_EQ(decisions(), 2);
+
+    // the pedestrian entered another subroom
+    auto moved = geometry.Agent({12, 5});
+    ped->UpdateRoom(moved->GetRoom(), moved->GetSubRoom());
+    ASSERT_EQ(decisions(), 3);
+
+    // the goal of the pedestrian changed
+    ped->SetFinalDestination(3);
+    ASSERT_EQ(decisions(), 4);
+    ASSERT_EQ(decisions(), 4);
+}
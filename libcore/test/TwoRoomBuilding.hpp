@@ -0,0 +1,131 @@
+#pragma once
+
+#include "general/Configuration.hpp"
+#include "general/Filesystem.hpp"
+#include "geometry/Building.hpp"
+#include "pedestrian/Pedestrian.hpp"
+
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+
+/**
+ * Building of two rooms of 10 m x 10 m loaded from a geometry file, for tests which need a
+ * complete Building.
+ *
+ * Room 0 spans x from 0 to 10 and has exit 2 at x = 0. Transition 1 at x = 10 leads to room 1,
+ * which spans x from 10 to 20. Room 1 is split at x = 15 into subroom 0 and subroom 1 by
+ * crossing 0, exit 3 is at x = 20 in subroom 1. All doors span y from 4 to 6.
+ *
+ * The files are written to a temporary directory which is removed with the object.
+ */
+class TwoRoomBuilding
+{
+public:
+    /**
+     * @param iniNodes nodes added to the root of the inifile, e.g. routing or traffic constraints,
+     * or header, models and agents for a project file read with ParseIniFile
+     */
+    explicit TwoRoomBuilding(const std::string& iniNodes = "")
+    {
+        std::random_device device;
+        _directory = fs::temp_directory_path() / ("jps-test-" + std::to_string(device()));
+        fs::create_directories(_directory);
+        std::ofstream(_directory / "geometry.xml") << GEOMETRY;
+        std::ofstream(_directory / "ini.xml") << "<JuPedSim version=\"0.8\">" << iniNodes
+                                                 << "</JuPedSim>";
+
+        config.projectRootDir = _directory;
+        config.geometryFile = "geometry.xml";
+        config.iniFile = _directory / "ini.xml";
+        config.outputPath = _directory / "results";
+        building = std::make_unique<Building>(&config);
+    }
+
+    ~TwoRoomBuilding()
+    {
+        building.reset();
+        std::error_code error;
+        fs::remove_all(_directory, error);
+    }
+
+    /// @return pedestrian at \p position, located in its room and subroom
+    std::unique_ptr<Pedestrian> Agent(const Point& position) const
+    {
+        auto ped = std::make_unique<Pedestrian>();
+        ped->SetPos(position);
+        const auto [room, subroom] = building->LocateSubRoom(position, nullptr);
+        ped->UpdateRoom(room, subroom);
+        return ped;
+    }
+
+    TwoRoomBuilding(const TwoRoomBuilding&) = delete;
+    TwoRoomBuilding& operator=(const TwoRoomBuilding&) = delete;
+
+    Configuration config;
+    std::unique_ptr<Building> building;
+
+private:
+    static constexpr const char* GEOMETRY = R"(<?xml version="1.0" encoding="UTF-8"?>
+<geometry version="0.8" caption="two rooms" unit="m">
+  <rooms>
+    <room id="0" caption="left">
+      <subroom id="0" closed="0" class="subroom">
+        <polygon caption="wall">
+          <vertex px="0" py="4"/><vertex px="0" py="0"/>
+          <vertex px="10" py="0"/><vertex px="10" py="4"/>
+        </polygon>
+        <polygon caption="wall">
+          <vertex px="10" py="6"/><vertex px="10" py="10"/>
+          <vertex px="0" py="10"/><vertex px="0" py="6"/>
+        </polygon>
+      </subroom>
+    </room>
+    <room id="1" caption="right">
+      <subroom id="0" closed="0" class="subroom">
+        <polygon caption="wall">
+          <vertex px="10" py="4"/><vertex px="10" py="0"/>
+          <vertex px="15" py="0"/><vertex px="15" py="4"/>
+        </polygon>
+        <polygon caption="wall">
+          <vertex px="15" py="6"/><vertex px="15" py="10"/>
+          <vertex px="10" py="10"/><vertex px="10" py="6"/>
+        </polygon>
+      </subroom>
+      <subroom id="1" closed="0" class="subroom">
+        <polygon caption="wall">
+          <vertex px="15" py="4"/><vertex px="15" py="0"/>
+          <vertex px="20" py="0"/><vertex px="20" py="4"/>
+        </polygon>
+        <polygon caption="wall">
+          <vertex px="20" py="6"/><vertex px="20" py="10"/>
+          <vertex px="15" py="10"/><vertex px="15" py="6"/>
+        </polygon>
+      </subroom>
+      <crossings>
+        <crossing id="0" subroom1_id="0" subroom2_id="1">
+          <vertex px="15" py="4"/><vertex px="15" py="6"/>
+        </crossing>
+      </crossings>
+    </room>
+  </rooms>
+  <transitions>
+    <transition id="1" caption="inner" type="emergency"
+                room1_id="0" subroom1_id="0" room2_id="1" subroom2_id="0">
+      <vertex px="10" py="4"/><vertex px="10" py="6"/>
+    </transition>
+    <transition id="2" caption="left exit" type="emergency"
+                room1_id="0" subroom1_id="0" room2_id="-1" subroom2_id="-1">
+      <vertex px="0" py="4"/><vertex px="0" py="6"/>
+    </transition>
+    <transition id="3" caption="right exit" type="emergency"
+                room1_id="1" subroom1_id="1" room2_id="-1" subroom2_id="-1">
+      <vertex px="20" py="4"/><vertex px="20" py="6"/>
+    </transition>
+  </transitions>
+</geometry>
+)";
+
+    fs::path _directory;
+};
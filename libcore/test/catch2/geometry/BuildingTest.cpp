@@ -0,0 +1,74 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "geometry/Building.hpp"
+
+#include "../../TwoRoomBuilding.hpp"
+#include "geometry/Room.hpp"
+#include "geometry/SubRoom.hpp"
+
+#include <catch2/catch.hpp>
+#include <tuple>
+
+TEST_CASE("geometry/Building/LocateSubRoom", "[geometry][Building]")
+{
+    TwoRoomBuilding geometry;
+    const Building& building = *geometry.building;
+    Room* left = building.GetRoom(0);
+    Room* right = building.GetRoom(1);
+    SubRoom* leftSub = left->GetSubRoom(0);
+    SubRoom* rightSub0 = right->GetSubRoom(0);
+    SubRoom* rightSub1 = right->GetSubRoom(1);
+
+    SECTION("Positions on a door do not depend on the previous subroom")
+    {
+        for(const Point& door : {Point{10, 5}, Point{15, 5}}) {
+            const auto expected = building.LocateSubRoom(door, nullptr);
+            REQUIRE(std::get<1>(expected) != nullptr);
+            for(SubRoom* previous : {leftSub, rightSub0, rightSub1}) {
+                REQUIRE(building.LocateSubRoom(door, previous) == expected);
+            }
+        }
+    }
+
+    SECTION("Positions in the previous subroom stay there")
+    {
+        REQUIRE(building.LocateSubRoom({5, 5}, leftSub) == std::make_tuple(left, leftSub));
+        REQUIRE(building.LocateSubRoom({12, 1}, rightSub0) == std::make_tuple(right, rightSub0));
+    }
+
+    SECTION("Moves into a neighboring subroom")
+    {
+        REQUIRE(building.LocateSubRoom({10.1, 5}, leftSub) == std::make_tuple(right, rightSub0));
+        REQUIRE(building.LocateSubRoom({9.9, 5}, rightSub0) == std::make_tuple(left, leftSub));
+        REQUIRE(building.LocateSubRoom({15.1, 5}, rightSub0) == std::make_tuple(right, rightSub1));
+    }
+
+    SECTION("Moves beyond the neighbors fall back to the lookup grid")
+    {
+        REQUIRE(building.LocateSubRoom({18, 8}, leftSub) == std::make_tuple(right, rightSub1));
+    }
+
+    SECTION("Moves out of the geometry")
+    {
+        const std::tuple<Room*, SubRoom*> outside{nullptr, nullptr};
+        REQUIRE(building.LocateSubRoom({-0.1, 5}, leftSub) == outside);
+        REQUIRE(building.LocateSubRoom({20.1, 5}, rightSub1) == outside);
+        REQUIRE(building.LocateSubRoom({5, 10.5}, nullptr) == outside);
+    }
+}
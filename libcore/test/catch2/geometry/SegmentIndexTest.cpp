@@ -0,0 +1,75 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "geometry/SegmentIndex.hpp"
+
+#include "geometry/Line.hpp"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("geometry/SegmentIndex", "[geometry][SegmentIndex]")
+{
+    SegmentIndex index(1.);
+    index.Insert(Line({0, 0}, {10, 0}));
+    index.Insert(Line({-3.5, -2}, {-3.5, 7}));
+    index.Insert(Line({20, 20}, {22, 21}));
+    REQUIRE(index.Size() == 3);
+
+    SECTION("Contains")
+    {
+        REQUIRE(index.Contains(Line({0, 0}, {10, 0})));
+        REQUIRE(index.Contains(Line({10, 0}, {0, 0})));
+        REQUIRE(index.Contains(Line({-3.5, 7}, {-3.5 + J_EPS / 2, -2})));
+        REQUIRE(index.Contains(Line({22, 21}, {20, 20})));
+
+        REQUIRE_FALSE(index.Contains(Line({0, 0}, {5, 0})));
+        REQUIRE_FALSE(index.Contains(Line({0, 0}, {10, 0.1})));
+        REQUIRE_FALSE(index.Contains(Line({100, 100}, {101, 100})));
+    }
+
+    SECTION("IsCloserThan")
+    {
+        REQUIRE(index.IsCloserThan({5, 0.4}, 0.5));
+        REQUIRE_FALSE(index.IsCloserThan({5, 0.6}, 0.5));
+        REQUIRE(index.IsCloserThan({-3, 3}, 0.6));
+        REQUIRE_FALSE(index.IsCloserThan({-3, 3}, 0.4));
+        REQUIRE(index.IsCloserThan({21, 22}, 2.));
+        REQUIRE_FALSE(index.IsCloserThan({50, 50}, 10.));
+        REQUIRE(index.IsCloserThan({50, 50}, 1000.));
+        REQUIRE_FALSE(index.IsCloserThan({0, 0}, -1.));
+    }
+
+    SECTION("Lines below the origin are only found in their own cells")
+    {
+        index.Insert(Line({-5.5, -7.5}, {-5.4, -7.5}));
+        REQUIRE(index.Contains(Line({-5.4, -7.5}, {-5.5, -7.5})));
+        REQUIRE(index.IsCloserThan({-5.45, -7.45}, 0.1));
+        for(const Point& other : {Point{5.45, 7.45}, Point{-5.45, 7.45}, Point{5.45, -7.45}}) {
+            REQUIRE_FALSE(index.IsCloserThan(other, 0.1));
+        }
+        REQUIRE_FALSE(index.Contains(Line({5.4, 7.5}, {5.5, 7.5})));
+        REQUIRE_FALSE(index.Contains(Line({-5.4, 7.5}, {-5.5, 7.5})));
+    }
+
+    SECTION("Lines added later are found")
+    {
+        index.Insert(Line({50, 50}, {51, 50}));
+        REQUIRE(index.Contains(Line({51, 50}, {50, 50})));
+        REQUIRE(index.IsCloserThan({50.5, 50.2}, 0.3));
+    }
+}
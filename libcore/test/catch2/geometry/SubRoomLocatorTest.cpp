@@ -0,0 +1,107 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "geometry/SubRoomLocator.hpp"
+
+#include "geometry/Crossing.hpp"
+#include "geometry/Room.hpp"
+#include "geometry/SubRoom.hpp"
+#include "geometry/Wall.hpp"
+
+#include <catch2/catch.hpp>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace
+{
+// Rectangular subroom from x0 to x1 with height 4, open towards the crossing at x = 5.
+SubRoom* CreateSubRoom(int id, double x0, double x1, Crossing* crossing)
+{
+    auto* sub = new NormalSubRoom();
+    sub->SetSubRoomID(id);
+    sub->SetRoomID(0);
+    const double outer = x0 == 5. ? x1 : x0;
+    sub->AddWall(Wall({5, 0}, {outer, 0}));
+    sub->AddWall(Wall({outer, 0}, {outer, 4}));
+    sub->AddWall(Wall({outer, 4}, {5, 4}));
+    sub->AddCrossing(crossing);
+    std::vector<Line*> goals{crossing};
+    REQUIRE(sub->ConvertLineToPoly(goals));
+    REQUIRE(sub->CreateBoostPoly());
+    return sub;
+}
+} // namespace
+
+TEST_CASE("geometry/SubRoomLocator", "[geometry][SubRoomLocator]")
+{
+    Crossing crossing;
+    crossing.SetPoint1({5, 0});
+    crossing.SetPoint2({5, 4});
+
+    auto room = std::make_shared<Room>();
+    room->SetID(0);
+    room->AddSubRoom(CreateSubRoom(0, 0, 5, &crossing));
+    room->AddSubRoom(CreateSubRoom(1, 5, 10, &crossing));
+    std::map<int, std::shared_ptr<Room>> rooms{{0, room}};
+
+    SubRoomLocator locator;
+    locator.Build(rooms, 0.5);
+
+    SECTION("Points inside a subroom")
+    {
+        for(const Point& p : {Point{0.2, 0.2}, Point{2.5, 2}, Point{4.9, 3.9}}) {
+            auto [r, sub] = locator.Locate(p);
+            REQUIRE(r == room.get());
+            REQUIRE(sub == room->GetSubRoom(0));
+        }
+        for(const Point& p : {Point{5.1, 0.2}, Point{7.5, 2}, Point{9.9, 3.9}}) {
+            REQUIRE(std::get<1>(locator.Locate(p)) == room->GetSubRoom(1));
+        }
+    }
+
+    SECTION("Points on the crossing belong to the first subroom")
+    {
+        REQUIRE(std::get<1>(locator.Locate({5, 2})) == room->GetSubRoom(0));
+    }
+
+    SECTION("Points outside of all subrooms")
+    {
+        for(const Point& p : {Point{-1, 2}, Point{5, 4.5}, Point{11, 2}, Point{1000, 1000}}) {
+            auto [r, sub] = locator.Locate(p);
+            REQUIRE(r == nullptr);
+            REQUIRE(sub == nullptr);
+        }
+    }
+
+    SECTION("Locate matches a linear search")
+    {
+        for(double x = -0.5; x < 10.5; x += 0.13) {
+            for(double y = -0.5; y < 4.5; y += 0.13) {
+                SubRoom* expected = nullptr;
+                for(const auto& [_, sub] : room->GetAllSubRooms()) {
+                    if(sub->IsInSubRoom(Point{x, y})) {
+                        expected = sub.get();
+                        break;
+                    }
+                }
+                REQUIRE(std::get<1>(locator.Locate({x, y})) == expected);
+            }
+        }
+    }
+}
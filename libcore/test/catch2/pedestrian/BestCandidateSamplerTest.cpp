@@ -0,0 +1,128 @@
+/*
+ * This file is part of JuPedSim.
+ *
+ * JuPedSim is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * JuPedSim is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with JuPedSim. If not, see <http://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "pedestrian/BestCandidateSampler.hpp"
+
+#include "geometry/SubRoom.hpp"
+#include "geometry/Wall.hpp"
+
+#include <catch2/catch.hpp>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace
+{
+// Closed rectangular subroom from origin to origin + (width, height).
+void CreateSubRoom(NormalSubRoom& sub, double width, double height, const Point& origin = {0, 0})
+{
+    const double x0 = origin.x;
+    const double y0 = origin.y;
+    const double x1 = x0 + width;
+    const double y1 = y0 + height;
+    sub.SetSubRoomID(0);
+    sub.SetRoomID(0);
+    sub.AddWall(Wall({x0, y0}, {x1, y0}));
+    sub.AddWall(Wall({x1, y0}, {x1, y1}));
+    sub.AddWall(Wall({x1, y1}, {x0, y1}));
+    sub.AddWall(Wall({x0, y1}, {x0, y0}));
+    std::vector<Line*> goals;
+    REQUIRE(sub.ConvertLineToPoly(goals));
+    REQUIRE(sub.CreateBoostPoly());
+}
+
+std::vector<Point> PlaceAll(const SubRoom& sub, unsigned int seed, double radius, bool greedy)
+{
+    std::mt19937 generator{seed};
+    BestCandidateSampler sampler(sub, {-100, 100, -100, 100}, generator);
+    std::vector<Point> positions;
+    while(auto position = sampler.Place(radius, greedy)) {
+        positions.push_back(*position);
+    }
+    return positions;
+}
+} // namespace
+
+TEST_CASE("pedestrian/BestCandidateSampler", "[pedestrian][BestCandidateSampler]")
+{
+    NormalSubRoom sub;
+    CreateSubRoom(sub, 10, 4);
+    const double radius = 0.2;
+
+    SECTION("Agents are placed inside the subroom without overlap")
+    {
+        for(bool greedy : {true, false}) {
+            const auto positions = PlaceAll(sub, 42, radius, greedy);
+            REQUIRE(positions.size() > 10);
+            for(std::size_t i = 0; i < positions.size(); ++i) {
+                const Point& p = positions[i];
+                REQUIRE(sub.IsInSubRoom(p));
+                REQUIRE(p.x >= radius);
+                REQUIRE(p.x <= 10 - radius);
+                REQUIRE(p.y >= radius);
+                REQUIRE(p.y <= 4 - radius);
+                for(std::size_t j = 0; j < i; ++j) {
+                    REQUIRE(Distance(p, positions[j]) > 2 * radius);
+                }
+            }
+        }
+    }
+
+    SECTION("Agents are placed without overlap below the origin")
+    {
+        NormalSubRoom negative;
+        CreateSubRoom(negative, 10, 4, {-5, -3});
+        const auto positions = PlaceAll(negative, 11, radius, true);
+        REQUIRE(positions.size() > 10);
+        for(std::size_t i = 0; i < positions.size(); ++i) {
+            REQUIRE(negative.IsInSubRoom(positions[i]));
+            for(std::size_t j = 0; j < i; ++j) {
+                REQUIRE(Distance(positions[i], positions[j]) > 2 * radius);
+            }
+        }
+    }
+
+    SECTION("Same seed gives the same positions")
+    {
+        const auto first = PlaceAll(sub, 7, radius, false);
+        const auto second = PlaceAll(sub, 7, radius, false);
+        REQUIRE(first.size() == second.size());
+        for(std::size_t i = 0; i < first.size(); ++i) {
+            REQUIRE(first[i] == second[i]);
+        }
+    }
+
+    SECTION("Boundaries restrict the positions")
+    {
+        std::mt19937 generator{1};
+        BestCandidateSampler sampler(sub, {0, 2, 0, 4}, generator);
+        for(int i = 0; i < 5; ++i) {
+            auto position = sampler.Place(radius, true);
+            REQUIRE(position);
+            REQUIRE(position->x <= 2);
+        }
+    }
+
+    SECTION("Agents added before are kept clear of")
+    {
+        std::mt19937 generator{3};
+        BestCandidateSampler sampler(sub, {0, 1, 0, 1}, generator);
+        sampler.AddAgent({0.5, 0.5});
+        REQUIRE_FALSE(sampler.Place(0.4, true).has_value());
+    }
+}
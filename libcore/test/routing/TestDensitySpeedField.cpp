@@ -0,0 +1,85 @@
+#include "routing/ff_router/DensitySpeedField.hpp"
+#include "routing/ff_router/mesh/RectGrid.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+
+class DensitySpeedFieldTest : public ::testing::Test
+{
+protected:
+    RectGrid grid{};
+
+    void SetUp() override
+    {
+        grid.SetBoundaries(0., 0., 10., 4.);
+        grid.SetSpacing(0.125, 0.125);
+        grid.CreateGrid();
+    }
+
+    double Mass(const std::vector<double>& density) const
+    {
+        return std::accumulate(density.begin(), density.end(), 0.) * grid.Gethx() * grid.Gethy();
+    }
+};
+
+TEST_F(DensitySpeedFieldTest, EmptyGridHasFreeSpeed)
+{
+    DensitySpeedField field{grid};
+    field.UpdateDensity({});
+
+    std::vector<double> freeSpeed(grid.GetnPoints(), 1.);
+    std::vector<double> speed(grid.GetnPoints(), 0.);
+    field.ApplyFundamentalDiagram(freeSpeed.data(), speed.data());
+    ASSERT_EQ(speed, freeSpeed);
+}
+
+TEST_F(DensitySpeedFieldTest, SmoothingConservesAgents)
+{
+    // agents in the middle, at the border and outside of the grid
+    const std::vector<Point> positions{
+        {5., 2.}, {5.06, 2.01}, {0., 0.}, {0.1, 3.9}, {9.95, 0.3}, {-5., 2.}};
+    DensitySpeedField field{grid};
+    field.UpdateDensity(positions);
+    ASSERT_NEAR(Mass(field.Density()), positions.size() - 1, 1e-9);
+
+    // buffers are reused, the previous agents must not remain
+    field.UpdateDensity({{2., 2.}});
+    ASSERT_NEAR(Mass(field.Density()), 1., 1e-9);
+}
+
+TEST_F(DensitySpeedFieldTest, DensityIsCenteredAtAgent)
+{
+    const Point agent{5., 2.};
+    DensitySpeedField field{grid};
+    field.UpdateDensity({agent});
+
+    const auto& density = field.Density();
+    const auto peak = std::max_element(density.begin(), density.end()) - density.begin();
+    ASSERT_EQ(peak, grid.GetKeyAtPoint(agent));
+
+    const long int left = grid.GetKeyAtPoint({4.5, 2.});
+    const long int right = grid.GetKeyAtPoint({5.5, 2.});
+    const long int far = grid.GetKeyAtPoint({8., 2.});
+    ASSERT_NEAR(density[left], density[right], 1e-12);
+    ASSERT_LT(density[right], density[peak]);
+    ASSERT_EQ(density[far], 0.);
+}
+
+TEST_F(DensitySpeedFieldTest, SpeedDecreasesWithDensity)
+{
+    DensitySpeedParameters parameters;
+    DensitySpeedField field{grid, parameters};
+
+    ASSERT_EQ(field.SpeedFactor(0.), 1.);
+    double previous = 1.;
+    for(double density = 0.5; density < parameters.jamDensity; density += 0.5) {
+        const double factor = field.SpeedFactor(density);
+        ASSERT_GE(factor, parameters.minSpeedFactor);
+        ASSERT_TRUE(factor < previous || factor == parameters.minSpeedFactor);
+        previous = factor;
+    }
+    ASSERT_EQ(field.SpeedFactor(parameters.jamDensity), parameters.minSpeedFactor);
+    ASSERT_EQ(field.SpeedFactor(10.), parameters.minSpeedFactor);
+}
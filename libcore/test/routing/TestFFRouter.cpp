@@ -0,0 +1,106 @@
+#include "../TwoRoomBuilding.hpp"
+#include "direction/DirectionManager.hpp"
+#include "geometry/Transition.hpp"
+#include "routing/ff_router/FloorfieldRepository.hpp"
+#include "routing/ff_router/ffRouter.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace
+{
+/// Global shortest floor field router on the two room building.
+struct FFRouterSetup {
+    explicit FFRouterSetup(
+        double quickestInterval = 0.,
+        bool quickestAsync = false,
+        int quickestApplyAfterSteps = 0)
+    {
+        geometry.config.directionStrategyType = DirectionStrategyType::LOCAL_FLOORFIELD;
+        geometry.config.deltaH = 0.125;
+        geometry.config.ffQuickestInterval = quickestInterval;
+        geometry.config.ffQuickestAsync = quickestAsync;
+        geometry.config.ffQuickestApplyAfterSteps = quickestApplyAfterSteps;
+        directionManager =
+            DirectionManager::Create(geometry.config, geometry.building.get(), &floorfields);
+        router = std::make_unique<FFRouter>(
+            &geometry.config, geometry.building.get(), directionManager.get(), &floorfields);
+    }
+
+    TwoRoomBuilding geometry;
+    FloorfieldRepository floorfields;
+    std::unique_ptr<DirectionManager> directionManager;
+    std::unique_ptr<FFRouter> router;
+};
+} // namespace
+
+TEST(FFRouter, RoutesFollowClosedDoors)
+{
+    FFRouterSetup setup;
+    Building& building = *setup.geometry.building;
+    const int inner = building.GetTransition(1)->GetUniqueID();
+    const int rightExit = building.GetTransition(3)->GetUniqueID();
+
+    // through the crossing the right exit is nearer, the router sends agents to the transition
+    auto agent = setup.geometry.Agent({12, 5});
+    ASSERT_EQ(setup.router->FindExit(agent.get()), rightExit);
+    auto neighbour = setup.geometry.Agent({12, 3});
+    ASSERT_EQ(setup.router->FindExit(neighbour.get()), rightExit);
+
+    // the candidates cached for the subroom are dropped with the shortest paths
+    const auto version = setup.router->GetRoutesVersion();
+    building.GetTransition(3)->Close();
+    setup.router->UpdateIncremental({rightExit}, {});
+    ASSERT_NE(setup.router->GetRoutesVersion(), version);
+    ASSERT_EQ(setup.router->FindExit(agent.get()), inner);
+    ASSERT_EQ(setup.router->FindExit(neighbour.get()), inner);
+
+    building.GetTransition(3)->Open();
+    setup.router->UpdateIncremental({rightExit}, {});
+    ASSERT_EQ(setup.router->FindExit(agent.get()), rightExit);
+}
+
+TEST(FFRouter, AppliedQuickestPathsChangeTheRoutes)
+{
+    FFRouterSetup setup{1.};
+    const auto version = setup.router->GetRoutesVersion();
+    setup.router->UpdateTime(0.5);
+    ASSERT_EQ(setup.router->GetRoutesVersion(), version);
+
+    // the quickest paths are computed and applied without an update of the routing engine
+    setup.router->UpdateTime(1.);
+    ASSERT_NE(setup.router->GetRoutesVersion(), version);
+}
+
+TEST(FFRouter, AsyncQuickestPathsAreAppliedAfterTheConfiguredSteps)
+{
+    FFRouterSetup setup{1., true, 3};
+    const auto version = setup.router->GetRoutesVersion();
+
+    // the job is started at t = 1 s and applied three steps later, even if it is ready earlier
+    for(double time : {0.5, 1., 1.5, 2.}) {
+        setup.router->UpdateTime(time);
+        ASSERT_EQ(setup.router->GetRoutesVersion(), version) << "t = " << time;
+    }
+    setup.router->UpdateTime(2.5);
+    ASSERT_NE(setup.router->GetRoutesVersion(), version);
+}
+
+TEST(FFRouter, AsyncQuickestPathsOfAnOutdatedGeometryAreDiscarded)
+{
+    FFRouterSetup setup{1., true, 2};
+    setup.router->UpdateTime(1.);
+
+    // the geometry of room 1 changes while the job started at t = 1 s is pending
+    setup.router->UpdateIncremental({}, {1});
+    const auto version = setup.router->GetRoutesVersion();
+    setup.router->UpdateTime(1.5);
+    setup.router->UpdateTime(2.);
+    ASSERT_EQ(setup.router->GetRoutesVersion(), version);
+
+    // the job started on the current geometry at t = 2 s is applied
+    setup.router->UpdateTime(2.5);
+    ASSERT_EQ(setup.router->GetRoutesVersion(), version);
+    setup.router->UpdateTime(3.);
+    ASSERT_NE(setup.router->GetRoutesVersion(), version);
+}
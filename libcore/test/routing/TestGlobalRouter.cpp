@@ -0,0 +1,73 @@
+#include "../TwoRoomBuilding.hpp"
+#include "geometry/Crossing.hpp"
+#include "geometry/Line.hpp"
+#include "geometry/SubRoom.hpp"
+#include "geometry/Transition.hpp"
+#include "routing/GlobalRouterParameters.hpp"
+#include "routing/global_shortest/GlobalRouter.hpp"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+/// @return navigation lines of the path of \p ped and its length between their centres
+std::pair<std::vector<int>, double> Path(GlobalRouter& router, Pedestrian& ped)
+{
+    std::vector<Line*> lines;
+    EXPECT_TRUE(router.GetPath(&ped, lines));
+    std::vector<int> uids;
+    double length = 0;
+    Point from = ped.GetPos();
+    for(const Line* line : lines) {
+        uids.push_back(line->GetUniqueID());
+        length += (line->GetCentre() - from).Norm();
+        from = line->GetCentre();
+    }
+    return {uids, length};
+}
+} // namespace
+
+TEST(GlobalRouter, AgentsTakeTheShortestPathToAnExit)
+{
+    TwoRoomBuilding geometry;
+    Building& building = *geometry.building;
+    GlobalRouter router{&building, GlobalRouterParameters{}};
+    const int leftExit = building.GetTransition(2)->GetUniqueID();
+    const int rightExit = building.GetTransition(3)->GetUniqueID();
+    const int crossing = building.GetRoom(1)->GetSubRoom(0)->GetAllCrossings()[0]->GetUniqueID();
+
+    // the left exit is 8 m away, the right one 12 m through the inner door and the crossing
+    auto left = geometry.Agent({8, 5});
+    ASSERT_EQ(router.FindExit(left.get()), leftExit);
+    const auto [leftPath, leftLength] = Path(router, *left);
+    ASSERT_EQ(leftPath, std::vector<int>{leftExit});
+    ASSERT_DOUBLE_EQ(leftLength, 8.);
+
+    // the right exit is 8 m away through the crossing, the left one 12 m through the inner door
+    auto right = geometry.Agent({12, 5});
+    ASSERT_EQ(router.FindExit(right.get()), crossing);
+    const auto [rightPath, rightLength] = Path(router, *right);
+    ASSERT_EQ(rightPath, (std::vector<int>{crossing, rightExit}));
+    ASSERT_DOUBLE_EQ(rightLength, 8.);
+
+    auto farRight = geometry.Agent({18, 2});
+    ASSERT_EQ(router.FindExit(farRight.get()), rightExit);
+}
+
+TEST(GlobalRouter, ClosedExitsAreAvoided)
+{
+    TwoRoomBuilding geometry;
+    Building& building = *geometry.building;
+    building.GetTransition(2)->Close();
+    GlobalRouter router{&building, GlobalRouterParameters{}};
+    const int inner = building.GetTransition(1)->GetUniqueID();
+    const int rightExit = building.GetTransition(3)->GetUniqueID();
+    const int crossing = building.GetRoom(1)->GetSubRoom(0)->GetAllCrossings()[0]->GetUniqueID();
+
+    auto agent = geometry.Agent({2, 5});
+    ASSERT_EQ(router.FindExit(agent.get()), inner);
+    const auto [path, length] = Path(router, *agent);
+    ASSERT_EQ(path, (std::vector<int>{inner, crossing, rightExit}));
+    ASSERT_DOUBLE_EQ(length, 18.);
+}
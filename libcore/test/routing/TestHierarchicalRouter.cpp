@@ -0,0 +1,121 @@
+#include "../TwoRoomBuilding.hpp"
+#include "direction/DirectionManager.hpp"
+#include "geometry/Crossing.hpp"
+#include "geometry/SubRoom.hpp"
+#include "geometry/Transition.hpp"
+#include "routing/ff_router/FloorfieldRepository.hpp"
+#include "routing/ff_router/HierarchicalRouter.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+namespace
+{
+/// Goal outside of the building behind exit 3.
+constexpr const char* GOAL = R"(<routing><goals>
+  <goal id="5" final="true" caption="assembly point">
+    <polygon>
+      <vertex px="22" py="4"/><vertex px="24" py="4"/><vertex px="24" py="6"/>
+      <vertex px="22" py="6"/><vertex px="22" py="4"/>
+    </polygon>
+  </goal>
+</goals></routing>)";
+constexpr int GOAL_ID = 5;
+
+/// Hierarchical floor field router on the two room building.
+struct HierarchicalRouterSetup {
+    explicit HierarchicalRouterSetup(const std::string& iniNodes = "") : geometry(iniNodes)
+    {
+        geometry.config.directionStrategyType = DirectionStrategyType::LOCAL_FLOORFIELD;
+        geometry.config.deltaH = 0.125;
+        directionManager =
+            DirectionManager::Create(geometry.config, geometry.building.get(), &floorfields);
+        router = std::make_unique<HierarchicalRouter>(
+            &geometry.config, geometry.building.get(), directionManager.get(), &floorfields);
+    }
+
+    /// @return door the router sends an agent at \p position heading to \p goalID
+    int FindExit(const Point& position, int goalID = FINAL_DEST_OUT)
+    {
+        auto agent = geometry.Agent(position);
+        agent->SetFinalDestination(goalID);
+        const int door = router->FindExit(agent.get());
+        if(door != -1) {
+            EXPECT_EQ(agent->GetDestination(), door);
+        }
+        return door;
+    }
+
+    /// Sets the state of a door and updates the router incrementally.
+    void SetOpen(Crossing* door, bool open)
+    {
+        open ? door->Open() : door->Close();
+        router->UpdateIncremental({door->GetUniqueID()}, {});
+    }
+
+    TwoRoomBuilding geometry;
+    FloorfieldRepository floorfields;
+    std::unique_ptr<DirectionManager> directionManager;
+    std::unique_ptr<HierarchicalRouter> router;
+};
+
+Crossing* CrossingOf(Building& building)
+{
+    return building.GetRoom(1)->GetSubRoom(0)->GetAllCrossings().front();
+}
+} // namespace
+
+TEST(HierarchicalRouter, AgentsTakeTheNearestExit)
+{
+    HierarchicalRouterSetup setup;
+    Building& building = *setup.geometry.building;
+    const int leftExit = building.GetTransition(2)->GetUniqueID();
+    const int rightExit = building.GetTransition(3)->GetUniqueID();
+
+    ASSERT_EQ(setup.FindExit({2, 5}), leftExit);
+    // 8 m to the left exit, 12 m through the inner door and the crossing to the right exit
+    ASSERT_EQ(setup.FindExit({8, 5}), leftExit);
+    ASSERT_EQ(setup.FindExit({18, 5}), rightExit);
+    // agents in a subroom without exit head to the crossing on their way
+    ASSERT_EQ(setup.FindExit({12, 5}), CrossingOf(building)->GetUniqueID());
+}
+
+TEST(HierarchicalRouter, AgentsAreRoutedToTheirGoal)
+{
+    HierarchicalRouterSetup setup{GOAL};
+    Building& building = *setup.geometry.building;
+
+    // the goal is reached through the right exit, even from next to the left one
+    ASSERT_EQ(setup.FindExit({2, 5}, GOAL_ID), building.GetTransition(1)->GetUniqueID());
+    ASSERT_EQ(setup.FindExit({12, 5}, GOAL_ID), CrossingOf(building)->GetUniqueID());
+    ASSERT_EQ(setup.FindExit({18, 5}, GOAL_ID), building.GetTransition(3)->GetUniqueID());
+}
+
+TEST(HierarchicalRouter, AgentsAreReroutedAroundClosedDoors)
+{
+    HierarchicalRouterSetup setup{GOAL};
+    Building& building = *setup.geometry.building;
+    Transition* inner = building.GetTransition(1);
+    Transition* leftExit = building.GetTransition(2);
+    Crossing* crossing = CrossingOf(building);
+
+    setup.SetOpen(leftExit, false);
+    ASSERT_EQ(setup.FindExit({2, 5}), inner->GetUniqueID());
+    ASSERT_EQ(setup.FindExit({12, 5}), crossing->GetUniqueID());
+
+    // closed crossings are not passed on the way to the exit within the room
+    setup.SetOpen(leftExit, true);
+    setup.SetOpen(crossing, false);
+    ASSERT_EQ(setup.FindExit({12, 5}), inner->GetUniqueID());
+    ASSERT_EQ(setup.FindExit({18, 5}), building.GetTransition(3)->GetUniqueID());
+
+    // the goal is not reached by leaving through the left exit and entering through the right
+    // one, which the undirected overlay would allow through the outside vertex
+    ASSERT_EQ(setup.FindExit({2, 5}, GOAL_ID), -1);
+    ASSERT_EQ(setup.FindExit({12, 5}, GOAL_ID), -1);
+
+    setup.SetOpen(crossing, true);
+    ASSERT_EQ(setup.FindExit({2, 5}, GOAL_ID), inner->GetUniqueID());
+    ASSERT_EQ(setup.FindExit({12, 5}), crossing->GetUniqueID());
+}
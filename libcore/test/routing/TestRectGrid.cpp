@@ -0,0 +1,60 @@
+#include "routing/ff_router/mesh/RectGrid.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+
+class RectGridTest : public ::testing::Test
+{
+protected:
+    RectGrid grid{};
+
+    void SetUp() override
+    {
+        grid.SetBoundaries(-1., 2., 3., 5.);
+        grid.SetSpacing(0.5, 0.25);
+        grid.CreateGrid();
+    }
+};
+
+TEST_F(RectGridTest, KeysAndIndicesAreConsistent)
+{
+    ASSERT_EQ(grid.GetnPoints(), grid.GetiMax() * grid.GetjMax());
+    for(long int key = 0; key < grid.GetnPoints(); ++key) {
+        const long int i = grid.GetIFromKey(key);
+        const long int j = grid.GetJFromKey(key);
+        ASSERT_EQ(j * grid.GetiMax() + i, key);
+        ASSERT_GE(i, 0);
+        ASSERT_LT(i, grid.GetiMax());
+
+        const Point point = grid.GetPointFromKey(key);
+        ASSERT_DOUBLE_EQ(grid.GetXFromKey(key), point.x);
+        ASSERT_DOUBLE_EQ(grid.GetYFromKey(key), point.y);
+        ASSERT_DOUBLE_EQ(point.x, grid.GetxMin() + i * grid.Gethx());
+        ASSERT_DOUBLE_EQ(point.y, grid.GetyMin() + j * grid.Gethy());
+        ASSERT_EQ(grid.GetKeyAtPoint(point), key);
+    }
+}
+
+TEST_F(RectGridTest, NeighborsMatchOffsets)
+{
+    const long int offsets[4] = {1, grid.GetiMax(), -1, -grid.GetiMax()};
+    for(long int key = 0; key < grid.GetnPoints(); ++key) {
+        const long int i = grid.GetIFromKey(key);
+        const long int j = grid.GetJFromKey(key);
+        const bool inGrid[4] = {
+            i < grid.GetiMax() - 1, j < grid.GetjMax() - 1, i > 0, j > 0};
+        const directNeighbor neighbors = grid.GetNeighbors(key);
+        for(int direction = 0; direction < 4; ++direction) {
+            ASSERT_EQ(
+                neighbors.key[direction], inGrid[direction] ? key + offsets[direction] : -2);
+        }
+    }
+
+    // copies keep the offsets
+    const RectGrid copy{grid};
+    for(long int key = 0; key < grid.GetnPoints(); ++key) {
+        const directNeighbor neighbors = grid.GetNeighbors(key);
+        const directNeighbor copied = copy.GetNeighbors(key);
+        ASSERT_TRUE(std::equal(neighbors.key, neighbors.key + 4, copied.key));
+    }
+}
@@ -0,0 +1,297 @@
+#include "geometry/Room.hpp"
+#include "geometry/SubRoom.hpp"
+#include "geometry/Transition.hpp"
+#include "geometry/Wall.hpp"
+#include "routing/ff_router/FloorfieldRepository.hpp"
+#include "routing/ff_router/UnivFFviaFM.hpp"
+#include "routing/ff_router/mesh/RectGrid.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+// Corridor of 10m x 4m with one door on the left and one door on the right side.
+class UnivFFviaFMTest : public ::testing::Test
+{
+protected:
+    Room room{};
+    std::unique_ptr<Transition> left = std::make_unique<Transition>();
+    std::unique_ptr<Transition> right = std::make_unique<Transition>();
+
+    void SetUp() override
+    {
+        room.SetID(0);
+        auto* sub = new NormalSubRoom();
+        sub->SetSubRoomID(0);
+        sub->SetRoomID(0);
+        sub->AddWall(Wall({0, 0}, {10, 0}));
+        sub->AddWall(Wall({10, 0}, {10, 1.5}));
+        sub->AddWall(Wall({10, 2.5}, {10, 4}));
+        sub->AddWall(Wall({10, 4}, {0, 4}));
+        sub->AddWall(Wall({0, 4}, {0, 2.5}));
+        sub->AddWall(Wall({0, 1.5}, {0, 0}));
+
+        int id = 0;
+        for(auto* door : {left.get(), right.get()}) {
+            door->SetID(id++);
+            door->SetRoom1(&room);
+            door->SetSubRoom1(sub);
+            sub->AddTransition(door);
+            room.AddTransitionID(door->GetUniqueID());
+        }
+        left->SetPoint1({0, 1.5});
+        left->SetPoint2({0, 2.5});
+        right->SetPoint1({10, 1.5});
+        right->SetPoint2({10, 2.5});
+
+        std::vector<Line*> doors{left.get(), right.get()};
+        ASSERT_TRUE(sub->ConvertLineToPoly(doors));
+        ASSERT_TRUE(sub->CreateBoostPoly());
+        room.AddSubRoom(sub);
+    }
+
+    std::unique_ptr<UnivFFviaFM> CreateField(bool lazy, std::size_t budget = 0)
+    {
+        auto field = std::make_unique<UnivFFviaFM>(&room, 0.125, 0.0, false);
+        field->SetUser(DISTANCE_AND_DIRECTIONS_USED);
+        field->SetMode(LINESEGMENT);
+        field->SetSpeedMode(FF_HOMO_SPEED);
+        field->SetLazy(lazy);
+        field->SetMemoryBudget(budget);
+        field->AddAllTargetsParallel();
+        return field;
+    }
+};
+
+TEST_F(UnivFFviaFMTest, LazyFieldsAreOnlyComputedOnRequest)
+{
+    auto field = CreateField(true);
+    ASSERT_TRUE(field->GetKnownDoorUIDs().empty());
+
+    Point direction;
+    field->GetDirectionToUID(right->GetUniqueID(), Point{5, 2}, direction);
+    ASSERT_EQ(field->GetKnownDoorUIDs(), std::vector<int>{right->GetUniqueID()});
+    ASSERT_GT(direction.x, 0.9);
+}
+
+TEST_F(UnivFFviaFMTest, LazyFieldsMatchEagerFields)
+{
+    auto eager = CreateField(false);
+    auto lazy = CreateField(true);
+
+    for(const Point& pos : {Point{1, 1}, Point{5, 2}, Point{9, 3.5}}) {
+        for(int uid : {left->GetUniqueID(), right->GetUniqueID()}) {
+            ASSERT_DOUBLE_EQ(
+                lazy->GetCostToDestination(uid, pos), eager->GetCostToDestination(uid, pos));
+            Point eagerDirection;
+            Point lazyDirection;
+            eager->GetDirectionToUID(uid, pos, eagerDirection);
+            lazy->GetDirectionToUID(uid, pos, lazyDirection);
+            ASSERT_EQ(lazyDirection, eagerDirection);
+        }
+    }
+}
+
+TEST_F(UnivFFviaFMTest, BatchDirectionsMatchSingleLookupsAtGridPoints)
+{
+    auto field = CreateField(true);
+    const RectGrid* grid = field->GetGrid();
+
+    std::vector<Point> positions;
+    std::vector<int> destIDs;
+    for(const Point& pos : {Point{1, 1}, Point{5, 2}, Point{9, 3.5}}) {
+        for(int uid : {left->GetUniqueID(), right->GetUniqueID(), -1}) {
+            positions.emplace_back(grid->GetPointFromKey(grid->GetKeyAtPoint(pos)));
+            destIDs.emplace_back(uid);
+        }
+    }
+    std::vector<Point> directions;
+    field->GetDirectionsToUIDs(positions, destIDs, directions);
+    ASSERT_EQ(directions.size(), positions.size());
+    ASSERT_EQ(field->GetKnownDoorUIDs().size(), 2);
+
+    for(std::size_t index = 0; index < positions.size(); ++index) {
+        Point expected;
+        field->GetDirectionToUID(destIDs[index], positions[index], expected);
+        if(destIDs[index] != -1) {
+            expected = expected.Normalized();
+        }
+        ASSERT_NEAR(directions[index].x, expected.x, 1e-9);
+        ASSERT_NEAR(directions[index].y, expected.y, 1e-9);
+    }
+}
+
+TEST_F(UnivFFviaFMTest, BatchDirectionsChangeSmoothlyBetweenGridPoints)
+{
+    auto field = CreateField(false);
+    const int uid = right->GetUniqueID();
+
+    // path across the corridor towards the door, directions turn gradually
+    std::vector<Point> positions;
+    for(double y = 0.5; y <= 3.5; y += 0.01) {
+        positions.emplace_back(7.03, y);
+    }
+    std::vector<Point> directions;
+    field->GetDirectionsToUIDs(positions, std::vector<int>(positions.size(), uid), directions);
+
+    for(std::size_t index = 0; index < directions.size(); ++index) {
+        ASSERT_NEAR(directions[index].Norm(), 1., 1e-9);
+        ASSERT_GT(directions[index].x, 0.);
+        if(index > 0) {
+            ASSERT_LT((directions[index] - directions[index - 1]).Norm(), 0.05);
+        }
+    }
+}
+
+TEST_F(UnivFFviaFMTest, LeastRecentlyUsedFieldIsEvictedAndRecomputed)
+{
+    auto probe = CreateField(true);
+    const std::size_t fieldMemory =
+        probe->GetGrid()->GetnPoints() * (sizeof(double) + sizeof(Point));
+
+    // budget for a single door field
+    auto field = CreateField(true, fieldMemory);
+    const Point pos{5, 2};
+    const double toLeft = field->GetCostToDestination(left->GetUniqueID(), pos);
+    const double toRight = field->GetCostToDestination(right->GetUniqueID(), pos);
+    ASSERT_DOUBLE_EQ(field->GetCostToDestination(left->GetUniqueID(), pos), toLeft);
+    ASSERT_DOUBLE_EQ(field->GetCostToDestination(right->GetUniqueID(), pos), toRight);
+
+    // both fields were evicted once and recomputed, each door is known once
+    ASSERT_EQ(field->GetFieldComputations(), 4);
+    ASSERT_EQ(field->GetKnownDoorUIDs().size(), 2);
+}
+
+TEST_F(UnivFFviaFMTest, FieldsWithinBudgetAreNotRecomputed)
+{
+    auto field = CreateField(true);
+    const Point pos{5, 2};
+    for(int i = 0; i < 3; ++i) {
+        field->GetCostToDestination(left->GetUniqueID(), pos);
+        field->GetCostToDestination(right->GetUniqueID(), pos);
+    }
+    ASSERT_EQ(field->GetFieldComputations(), 2);
+    ASSERT_EQ(field->GetKnownDoorUIDs().size(), 2);
+}
+
+TEST_F(UnivFFviaFMTest, RepositorySharesCompatibleFields)
+{
+    FloorfieldRepository repository;
+    FloorfieldParameters directions;
+    auto field = repository.Get(&room, directions);
+    ASSERT_EQ(repository.Get(&room, directions), field);
+
+    FloorfieldParameters distances = directions;
+    distances.user = DISTANCE_MEASUREMENTS_ONLY;
+    ASSERT_EQ(repository.Get(&room, distances), field);
+
+    FloorfieldParameters centerpoint = directions;
+    centerpoint.mode = CENTERPOINT;
+    ASSERT_NE(repository.Get(&room, centerpoint), field);
+
+    FloorfieldParameters lazy = directions;
+    lazy.lazy = true;
+    auto lazyField = repository.Get(&room, lazy);
+    ASSERT_NE(lazyField, field);
+
+    FloorfieldParameters budget = lazy;
+    budget.memoryBudget = 1024;
+    ASSERT_NE(repository.Get(&room, budget), lazyField);
+    ASSERT_EQ(repository.Get(&room, lazy), lazyField);
+}
+
+TEST_F(UnivFFviaFMTest, RepositoryDerivesFieldsOnSameGrid)
+{
+    FloorfieldRepository repository;
+    FloorfieldParameters wallAvoid;
+    wallAvoid.wallAvoidDistance = 0.4;
+    wallAvoid.useWallDistances = true;
+    wallAvoid.speedMode = FF_WALL_AVOID;
+    auto base = repository.Get(&room, wallAvoid);
+
+    FloorfieldParameters centerpoint = wallAvoid;
+    centerpoint.mode = CENTERPOINT;
+    centerpoint.user = DISTANCE_MEASUREMENTS_ONLY;
+    auto derived = repository.Get(&room, centerpoint);
+
+    UnivFFviaFM fresh{&room, 0.125, 0.4, true};
+    fresh.SetUser(DISTANCE_MEASUREMENTS_ONLY);
+    fresh.SetMode(CENTERPOINT);
+    fresh.SetSpeedMode(FF_WALL_AVOID);
+    fresh.AddAllTargetsParallel();
+
+    for(const Point& pos : {Point{1, 1}, Point{5, 2}, Point{9, 3.5}}) {
+        ASSERT_DOUBLE_EQ(derived->GetDistance2WallAt(pos), fresh.GetDistance2WallAt(pos));
+        for(int uid : {left->GetUniqueID(), right->GetUniqueID()}) {
+            ASSERT_DOUBLE_EQ(
+                derived->GetCostToDestination(uid, pos), fresh.GetCostToDestination(uid, pos));
+        }
+    }
+}
+
+TEST_F(UnivFFviaFMTest, RepositoryRecomputesInvalidatedRooms)
+{
+    FloorfieldRepository repository;
+    FloorfieldParameters parameters;
+    auto field = repository.Get(&room, parameters);
+
+    repository.Invalidate(room.GetID());
+    auto recomputed = repository.Get(&room, parameters);
+    ASSERT_NE(recomputed, field);
+    ASSERT_EQ(repository.Size(), 1);
+
+    recomputed.reset();
+    ASSERT_EQ(repository.Size(), 0);
+}
+
+TEST_F(UnivFFviaFMTest, CrowdedFieldIncreasesDistanceBetweenDoors)
+{
+    auto base = CreateField(false);
+    UnivFFviaFM empty{*base, DISTANCE_MEASUREMENTS_ONLY, CENTERPOINT, FF_PED_SPEED};
+    empty.UpdatePedSpeed({});
+    empty.AddAllTargetsParallel();
+
+    // jam in front of the right door
+    std::vector<Point> positions;
+    for(double x = 7.; x < 9.5; x += 0.4) {
+        for(double y = 0.5; y < 3.5; y += 0.4) {
+            positions.emplace_back(x, y);
+        }
+    }
+    UnivFFviaFM crowded{*base, DISTANCE_MEASUREMENTS_ONLY, CENTERPOINT, FF_PED_SPEED};
+    crowded.UpdatePedSpeed(positions);
+    crowded.AddAllTargetsParallel();
+
+    const int leftUID = left->GetUniqueID();
+    const int rightUID = right->GetUniqueID();
+    ASSERT_GT(
+        crowded.GetDistanceBetweenDoors(leftUID, rightUID),
+        1.2 * empty.GetDistanceBetweenDoors(leftUID, rightUID));
+}
+
+TEST_F(UnivFFviaFMTest, RepeatedSpeedUpdatesMatchFreshField)
+{
+    auto base = CreateField(false);
+    std::vector<Point> positions;
+    for(double x = 7.; x < 9.5; x += 0.4) {
+        positions.emplace_back(x, 2.);
+    }
+
+    // the density and the targets of the first update must not leak into the second one, the
+    // router reuses its density weighted fields like this
+    UnivFFviaFM reused{*base, DISTANCE_MEASUREMENTS_ONLY, CENTERPOINT, FF_PED_SPEED};
+    reused.UpdatePedSpeed({Point{2., 2.}, Point{2.5, 2.}, Point{3., 2.}});
+    reused.AddAllTargetsParallel();
+    reused.UpdatePedSpeed(positions);
+    reused.AddAllTargetsParallel();
+
+    UnivFFviaFM fresh{*base, DISTANCE_MEASUREMENTS_ONLY, CENTERPOINT, FF_PED_SPEED};
+    fresh.UpdatePedSpeed(positions);
+    fresh.AddAllTargetsParallel();
+
+    const int leftUID = left->GetUniqueID();
+    const int rightUID = right->GetUniqueID();
+    ASSERT_DOUBLE_EQ(
+        reused.GetDistanceBetweenDoors(leftUID, rightUID),
+        fresh.GetDistanceBetweenDoors(leftUID, rightUID));
+}
@@ -0,0 +1,41 @@
+#include "util/ObjectPool.hpp"
+
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+
+namespace
+{
+struct alignas(32) Aligned {
+    double values[5];
+};
+} // namespace
+
+TEST(ObjectPool, HandsOutDistinctAlignedStorage)
+{
+    jps::ObjectPool<Aligned, 8> pool;
+    std::set<void*> storage;
+    for(int i = 0; i < 20; ++i) {
+        void* ptr = pool.Allocate();
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % alignof(Aligned), 0);
+        ASSERT_TRUE(storage.insert(ptr).second);
+    }
+    ASSERT_EQ(pool.Capacity(), 24);
+}
+
+TEST(ObjectPool, ReusesReleasedStorage)
+{
+    jps::ObjectPool<Aligned, 4> pool;
+    std::vector<void*> storage;
+    for(int i = 0; i < 4; ++i) {
+        storage.push_back(pool.Allocate());
+    }
+    pool.Deallocate(storage[1]);
+    pool.Deallocate(storage[3]);
+    ASSERT_EQ(pool.Allocate(), storage[3]);
+    ASSERT_EQ(pool.Allocate(), storage[1]);
+    ASSERT_EQ(pool.Capacity(), 4);
+    pool.Allocate();
+    ASSERT_EQ(pool.Capacity(), 8);
+}
@@ -3,6 +3,7 @@
 #include <fmt/format.h>
 #include <gtest/gtest.h>
 #include <memory>
+#include <unordered_map>
 
 using namespace fmt::literals;
 using ::jps::UniqueID;
@@ -73,3 +74,12 @@ TEST(UniqueId, CanBeFormatted)
     jps::UniqueID<Foo> id;
     ASSERT_EQ("1", "{}"_format(id));
 }
+
+TEST(UniqueId, CanBeHashed)
+{
+    const auto id1 = jps::UniqueID<void>{};
+    const auto id2 = jps::UniqueID<void>{};
+    std::unordered_map<jps::UniqueID<void>, int> values{{id1, 1}, {id2, 2}};
+    ASSERT_EQ(values.at(id1), 1);
+    ASSERT_EQ(values.at(id2), 2);
+}
@@ -56,6 +56,7 @@ def main():
     scenario_names = [
         "sisame_evac_shortest_ff_router_velocity",
         "sisame_evac_shortest_ff_router_gcfm",
+        "sisame_floorfield_solver",
     ]
     scenario_paths = [env.performancetests_path / id for id in scenario_names]
     for p in scenario_paths: